@@ -0,0 +1,37 @@
+#!/bin/sh -e
+[ "$#" -ne 4 ] && echo "Please provide <nm> <objdump> <archive> <avx|avx512|native>" && exit 1;
+
+# The SIMD kernel objects are compiled with more instructions than the rest of the archive.
+# Only their kernel namespaces may be visible to the linker, otherwise it can pick a kernel
+# copy of an inline function or template for the whole binary. The other objects must not
+# contain the instructions of the kernels at all.
+NM="$1"
+OBJDUMP="$2"
+ARCHIVE="$3"
+LEVEL="$4"
+
+"${NM}" -g --defined-only "${ARCHIVE}" | awk '
+    /:$/ { member = $0; sub(/:$/, "", member); next }
+    member !~ /^mmseqs-kernels-/ || NF < 3 { next }
+    $3 ~ /simd_avx2|simd_avx512bw|^_ZZ|^_ZGV/ { next }
+    { print "SIMD kernel symbol " $3 " in " member " is visible to the linker"; failed = 1 }
+    END { exit failed }' || exit 1
+
+if [ "${LEVEL}" = "native" ]; then
+    exit 0
+elif [ "${LEVEL}" = "avx" ]; then
+    PATTERN='^v.*%[xyz]mm|^vzero'
+else
+    PATTERN='%zmm|%k[0-7]|%[xy]mm(1[6-9]|2[0-9]|3[01])'
+fi
+
+"${OBJDUMP}" -d --no-show-raw-insn "${ARCHIVE}" | awk -F '\t' -v pattern="${PATTERN}" '
+    / file format / { member = $0; sub(/: .*/, "", member); next }
+    /^[0-9a-f]+ <.*>:$/ { symbol = $0; sub(/^[0-9a-f]+ /, "", symbol); sub(/:$/, "", symbol); next }
+    member ~ /^mmseqs-kernels-/ || NF < 2 { next }
+    $2 ~ pattern && !(symbol in seen) {
+        seen[symbol] = 1
+        print "Object " member " has SIMD kernel instructions in " symbol
+        failed = 1
+    }
+    END { exit failed }' || exit 1
@@ -30,8 +30,17 @@ STEPS=${STEPS:-1}
 while [ "$STEP" -lt "$STEPS" ]; do
     SENS_PARAM=SENSE_${STEP}
     eval SENS="\$$SENS_PARAM"
+    if [ -n "$FUSED_PAR" ]; then
+        # prefilter and align in one module without a prefilter database
+        if notExists "$TMP_PATH/aln_$SENS"; then
+            # shellcheck disable=SC2086
+            $RUNNER "$MMSEQS" prefilteralign "$INPUT" "$TARGET" "$TMP_PATH/aln_$SENS" $FUSED_PAR -s "$SENS" \
+                || fail "Prefilter and alignment died"
+        fi
+    fi
+
     # call prefilter module
-    if notExists "$TMP_PATH/pref_$SENS"; then
+    if notExists "$TMP_PATH/aln_$SENS" && notExists "$TMP_PATH/pref_$SENS"; then
         # shellcheck disable=SC2086
         $RUNNER "$MMSEQS" prefilter "$INPUT" "$TARGET" "$TMP_PATH/pref_$SENS" $PREFILTER_PAR -s "$SENS" \
             || fail "Prefilter died"
@@ -49,8 +58,7 @@ while [ "$STEP" -lt "$STEPS" ]; do
         if notExists "$TMP_PATH/aln_${SENS}.hasmerge"; then
             "$MMSEQS" mergedbs "$1" "$TMP_PATH/aln_new" "$TMP_PATH/aln_${SENSE_0}" "$TMP_PATH/aln_$SENS" \
                 || fail "Alignment died"
-            mv -f "$TMP_PATH/aln_new" "$TMP_PATH/aln_${SENSE_0}"
-            mv -f "$TMP_PATH/aln_new.index" "$TMP_PATH/aln_${SENSE_0}.index"
+            "$MMSEQS" mvdb "$TMP_PATH/aln_new" "$TMP_PATH/aln_${SENSE_0}" || fail "Could not move merged result"
             touch "$TMP_PATH/aln_${SENS}.hasmerge"
         fi
     fi
@@ -75,8 +83,8 @@ while [ "$STEP" -lt "$STEPS" ]; do
 done
 
 # post processing
-(mv -f "$TMP_PATH/aln_${SENSE_0}" "$3" && mv -f "$TMP_PATH/aln_${SENSE_0}.index" "$3.index" ) \
-    || fail "Could not move result to $3"
+# binary alignment results are only readable together with their .dbtype, mvdb moves it along
+"$MMSEQS" mvdb "$TMP_PATH/aln_${SENSE_0}" "$3" || fail "Could not move result to $3"
 
 if [ -n "$REMOVE_TMP" ]; then
     echo "Remove temporary files"
@@ -84,10 +92,10 @@ if [ -n "$REMOVE_TMP" ]; then
     while [ "$STEP" -lt "$STEPS" ]; do
         SENS_PARAM=SENSE_${STEP}
         eval SENS="\$$SENS_PARAM"
-        rm -f "$TMP_PATH/pref_$SENS" "$TMP_PATH/pref_$SENS.index"
-        rm -f "$TMP_PATH/aln_$SENS" "$TMP_PATH/aln_$SENS.index"
+        "$MMSEQS" rmdb "$TMP_PATH/pref_$SENS"
+        "$MMSEQS" rmdb "$TMP_PATH/aln_$SENS"
         NEXTINPUT="$TMP_PATH/input_step$SENS"
-        rm -f "$TMP_PATH/input_step$SENS" "$TMP_PATH/input_step$SENS.index"
+        "$MMSEQS" rmdb "$TMP_PATH/input_step$SENS"
         STEP=$((STEP+1))
     done
 
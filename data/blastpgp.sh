@@ -40,8 +40,7 @@ while [ $STEP -lt $NUM_IT ]; do
             # shellcheck disable=SC2086
             "$MMSEQS" subtractdbs "$TMP_PATH/pref_$STEP" "$TMP_PATH/aln_0" "$TMP_PATH/pref_next_$STEP" $SUBSTRACT_PAR \
                 || fail "Substract died"
-            mv -f "$TMP_PATH/pref_next_$STEP" "$TMP_PATH/pref_$STEP"
-            mv -f "$TMP_PATH/pref_next_$STEP.index" "$TMP_PATH/pref_$STEP.index"
+            "$MMSEQS" mvdb "$TMP_PATH/pref_next_$STEP" "$TMP_PATH/pref_$STEP" || fail "Could not move subtracted result"
             touch "$TMP_PATH/pref_$STEP.hasnext"
         fi
     fi
@@ -59,8 +58,7 @@ while [ $STEP -lt $NUM_IT ]; do
         if notExists "$TMP_PATH/aln_$STEP.hasmerge"; then
             "$MMSEQS" mergedbs "$QUERYDB" "$TMP_PATH/aln_new" "$TMP_PATH/aln_0" "$TMP_PATH/aln_$STEP" \
                 || fail "Merge died"
-            mv -f "$TMP_PATH/aln_new" "$TMP_PATH/aln_0"
-            mv -f "$TMP_PATH/aln_new.index" "$TMP_PATH/aln_0.index"
+            "$MMSEQS" mvdb "$TMP_PATH/aln_new" "$TMP_PATH/aln_0" || fail "Could not move merged result"
             touch "$TMP_PATH/aln_$STEP.hasmerge"
         fi
     fi
@@ -81,15 +79,16 @@ while [ $STEP -lt $NUM_IT ]; do
 done
 # post processing
 STEP=$((STEP-1))
-(mv -f "$TMP_PATH/aln_0" "$3" && mv -f "$TMP_PATH/aln_0.index" "$3.index") || fail "Could not move result to $3"
+"$MMSEQS" mvdb "$TMP_PATH/aln_0" "$3" || fail "Could not move result to $3"
 
 if [ -n "$REMOVE_TMP" ]; then
  echo "Remove temporary files"
  STEP=0
  while [ "$STEP" -lt "$NUM_IT" ]; do
-    rm -f "$TMP_PATH/pref_$STEP" "$TMP_PATH/pref_$STEP.index"
-    rm -f "$TMP_PATH/aln_$STEP" "$TMP_PATH/aln_$STEP.index"
-    rm -f "$TMP_PATH/profile_$STEP" "$TMP_PATH/profile_$STEP.index" "$TMP_PATH/profile_${STEP}_h" "$TMP_PATH/profile_${STEP}_h.index"
+    "$MMSEQS" rmdb "$TMP_PATH/pref_$STEP"
+    "$MMSEQS" rmdb "$TMP_PATH/aln_$STEP"
+    "$MMSEQS" rmdb "$TMP_PATH/profile_$STEP"
+    "$MMSEQS" rmdb "$TMP_PATH/profile_${STEP}_h"
     STEP=$((STEP+1))
  done
 
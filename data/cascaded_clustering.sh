@@ -79,21 +79,20 @@ while [ "$STEP" -lt "$STEPS" ]; do
 done
 
 # post processing
-mv -f "${TMP_PATH}/clu" "$2" || fail "Could not move result to $2"
-mv -f "${TMP_PATH}/clu.index" "$2.index" || fail "Could not move result to $2"
+"$MMSEQS" mvdb "${TMP_PATH}/clu" "$2" || fail "Could not move result to $2"
 
 if [ -n "$REMOVE_TMP" ]; then
  echo "Remove temporary files"
  rm -f "${TMP_PATH}/order_redundancy"
- rm -f "${TMP_PATH}/clu_redundancy" "${TMP_PATH}/clu_redundancy.index"
- rm -f "${TMP_PATH}/aln_redundancy" "${TMP_PATH}/aln_redundancy.index"
- rm -f "${TMP_PATH}/input_step_redundancy" "${TMP_PATH}/input_step_redundancy.index"
+ "$MMSEQS" rmdb "${TMP_PATH}/clu_redundancy"
+ "$MMSEQS" rmdb "${TMP_PATH}/aln_redundancy"
+ "$MMSEQS" rmdb "${TMP_PATH}/input_step_redundancy"
  STEP=0
  while [ "$STEP" -lt "$STEPS" ]; do
-    rm -f "${TMP_PATH}/pref_step$STEP" "${TMP_PATH}/pref_step$STEP.index"
-    rm -f "${TMP_PATH}/aln_step$STEP" "${TMP_PATH}/aln_step$STEP.index"
-    rm -f "${TMP_PATH}/clu_step$STEP" "${TMP_PATH}/clu_step$STEP.index"
-    rm -f "${TMP_PATH}/input_step$STEP" "${TMP_PATH}/input_step$STEP.index"
+    "$MMSEQS" rmdb "${TMP_PATH}/pref_step$STEP"
+    "$MMSEQS" rmdb "${TMP_PATH}/aln_step$STEP"
+    "$MMSEQS" rmdb "${TMP_PATH}/clu_step$STEP"
+    "$MMSEQS" rmdb "${TMP_PATH}/input_step$STEP"
     rm -f "${TMP_PATH}/order_step$STEP"
 	STEP=$((STEP+1))
  done
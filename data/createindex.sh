@@ -35,8 +35,8 @@ if [ -n "$NUCL" ]; then
 
     if [ -n "$REMOVE_TMP" ]; then
         echo "Remove temporary files"
-        rm -f "$2/orfs" "$2/orfs.index" "$2/orfs.dbtype"
-        rm -f "$2/orfs_aa" "$2/orfs_aa.index" "$2/orfs_aa.dbtype"
+        "$MMSEQS" rmdb "$2/orfs"
+        "$MMSEQS" rmdb "$2/orfs_aa"
         rm -f "$2/createindex.sh"
     fi
 else
@@ -56,23 +56,28 @@ if notExists "${TMP_PATH}/alis"; then
         || fail "Convert Alignments died"
 fi
 
-mv -f "${TMP_PATH}/alis" "${RESULTS}" || fail "Could not move result to ${RESULTS}"
 if [ -f "${TMP_PATH}/alis.index" ]; then
-    mv -f "${TMP_PATH}/alis.index" "${RESULTS}.index" || fail "Could not move result index to ${RESULTS}"
+    "$MMSEQS" mvdb "${TMP_PATH}/alis" "${RESULTS}" || fail "Could not move result to ${RESULTS}"
+else
+    mv -f "${TMP_PATH}/alis" "${RESULTS}" || fail "Could not move result to ${RESULTS}"
 fi
 
 
 if [ -n "${REMOVE_TMP}" ]; then
     echo "Removing temporary files"
     if [ -n "${GREEDY_BEST_HITS}" ]; then
-        rm -f "${TMP_PATH}/result_best" "${TMP_PATH}/result_best.index"
+        "$MMSEQS" rmdb "${TMP_PATH}/result_best"
     fi
-    rm -f "${TMP_PATH}/result" "${TMP_PATH}/result.index"
+    "$MMSEQS" rmdb "${TMP_PATH}/result"
     if [ ! -n "${LEAVE_INPUT}" ]; then
         if [ -f "${TMP_PATH}/target" ]; then
-            rm -f "${TMP_PATH}/target" "${TMP_PATH}/target.index" "${TMP_PATH}/target_h" "${TMP_PATH}/target_h.index" "${TMP_PATH}/target.lookup" "${TMP_PATH}/target.dbtype"
+            "$MMSEQS" rmdb "${TMP_PATH}/target"
+            "$MMSEQS" rmdb "${TMP_PATH}/target_h"
+            rm -f "${TMP_PATH}/target.lookup"
         fi
-        rm -f "${TMP_PATH}/query" "${TMP_PATH}/query.index" "${TMP_PATH}/query_h" "${TMP_PATH}/query_h.index" "${TMP_PATH}/query.lookup" "${TMP_PATH}/query.dbtype"
+        "$MMSEQS" rmdb "${TMP_PATH}/query"
+        "$MMSEQS" rmdb "${TMP_PATH}/query_h"
+        rm -f "${TMP_PATH}/query.lookup"
     fi
     rm -rf "${TMP_PATH}/search_tmp"
     rm -f "${TMP_PATH}/easysearch.sh"
@@ -83,19 +83,18 @@ if notExists "${TMP_PATH}/clu"; then
 fi
 
 # post processing
-mv -f "${TMP_PATH}/clu" "$2" || fail "Could not move result to $2"
-mv -f "${TMP_PATH}/clu.index" "$2.index" || fail "Could not move result to $2"
+"$MMSEQS" mvdb "${TMP_PATH}/clu" "$2" || fail "Could not move result to $2"
 
 if [ -n "$REMOVE_TMP" ]; then
  echo "Remove temporary files"
- rm -f "${TMP_PATH}/pref" "${TMP_PATH}/pref.index"
- rm -f "${TMP_PATH}/pref_rescore1" "${TMP_PATH}/pref_rescore1.index"
- rm -f "${TMP_PATH}/pre_clust" "${TMP_PATH}/pre_clust.index"
- rm -f "${TMP_PATH}/input_step_redundancy" "${TMP_PATH}/input_step_redundancy.index"
- rm -f "${TMP_PATH}/pref_filter1" "${TMP_PATH}/pref_filter1.index"
- rm -f "${TMP_PATH}/pref_filter2" "${TMP_PATH}/pref_filter2.index"
- rm -f "${TMP_PATH}/aln" "${TMP_PATH}/aln.index"
- rm -f "${TMP_PATH}/clust" "${TMP_PATH}/clust.index"
+ "$MMSEQS" rmdb "${TMP_PATH}/pref"
+ "$MMSEQS" rmdb "${TMP_PATH}/pref_rescore1"
+ "$MMSEQS" rmdb "${TMP_PATH}/pre_clust"
+ "$MMSEQS" rmdb "${TMP_PATH}/input_step_redundancy"
+ "$MMSEQS" rmdb "${TMP_PATH}/pref_filter1"
+ "$MMSEQS" rmdb "${TMP_PATH}/pref_filter2"
+ "$MMSEQS" rmdb "${TMP_PATH}/aln"
+ "$MMSEQS" rmdb "${TMP_PATH}/clust"
 
  rm -f "${TMP_PATH}/linclust.sh"
 fi
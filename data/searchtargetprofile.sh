@@ -47,12 +47,12 @@ if notExists "$TMP_PATH/aln"; then
 fi
 
 # post processing
-(mv -f "${TMP_PATH}/aln" "${RESULTS}"; mv -f "${TMP_PATH}/aln.index" "${RESULTS}.index") || fail "Could not move result to ${RESULTS}"
+"$MMSEQS" mvdb "${TMP_PATH}/aln" "${RESULTS}" || fail "Could not move result to ${RESULTS}"
 
 if [ -n "${REMOVE_TMP}" ]; then
     echo "Remove temporary files"
-    rm -f "${TMP_PATH}/pref" "${TMP_PATH}/pref.index"
-    rm -f "${TMP_PATH}/pref_swapped" "${TMP_PATH}/pref_swapped.index"
-    rm -f "${TMP_PATH}/aln_swapped" "${TMP_PATH}/aln_swapped.index"
+    "$MMSEQS" rmdb "${TMP_PATH}/pref"
+    "$MMSEQS" rmdb "${TMP_PATH}/pref_swapped"
+    "$MMSEQS" rmdb "${TMP_PATH}/aln_swapped"
     rm -f "${TMP_PATH}/searchtargetprofile.sh"
 fi
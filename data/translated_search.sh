@@ -62,15 +62,14 @@ if notExists "$4/aln_offset"; then
     "$MMSEQS" offsetalignment "$QUERY_ORF" "$TARGET_ORF" "$4/aln"  "$4/aln_offset" \
         || fail "Offset step died"
 fi
-(mv -f "$4/aln_offset" "$3" && mv -f "$4/aln_offset.index" "$3.index") \
-    || fail "Could not move result to $3"
+"$MMSEQS" mvdb "$4/aln_offset" "$3" || fail "Could not move result to $3"
 
 if [ -n "$REMOVE_TMP" ]; then
   echo "Remove temporary files"
-  rm -f "$4/q_orfs"    "$4/q_orfs.index"    "$4/q_orfs.dbtype"
-  rm -f "$4/q_orfs_aa" "$4/q_orfs_aa.index" "$4/q_orfs_aa.dbtype"
-  rm -f "$4/t_orfs"    "$4/t_orfs.index"    "$4/t_orfs.dbtype"
-  rm -f "$4/t_orfs_aa" "$4/t_orfs_aa.index" "$4/t_orfs_aa.dbtype"
+  "$MMSEQS" rmdb "$4/q_orfs"
+  "$MMSEQS" rmdb "$4/q_orfs_aa"
+  "$MMSEQS" rmdb "$4/t_orfs"
+  "$MMSEQS" rmdb "$4/t_orfs_aa"
 fi
 
 
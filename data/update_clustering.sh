@@ -118,7 +118,9 @@ if [ -n "${RECOVER_DELETED}" ] && [ -s "${TMP_PATH}/removedSeqs" ]; then
 
     if [ -n "$REMOVE_TMP" ]; then
         echo "Remove temporary files 1/3"
-        rm -f "${TMP_PATH}/OLDDB.removedMapping" "${TMP_PATH}/OLDDB.removed"{Db,Db.index,Db_h,Db_h.index,Db.lookup}
+        rm -f "${TMP_PATH}/OLDDB.removedMapping" "${TMP_PATH}/OLDDB.removedDb.lookup"
+        "$MMSEQS" rmdb "${TMP_PATH}/OLDDB.removedDb"
+        "$MMSEQS" rmdb "${TMP_PATH}/OLDDB.removedDb_h"
     fi
 fi
 
@@ -164,7 +166,9 @@ NEWDB="${NEWMAPDB}"
 
 if [ -n "$REMOVE_TMP" ]; then
     echo "Remove temporary files 2/3"
-    rm -f "${TMP_PATH}/NEWDB.withOld" "${TMP_PATH}/NEWDB.withOld.index" "${TMP_PATH}/NEWDB.withOld.lookup" "${TMP_PATH}/NEWDB.withOld_h" "${TMP_PATH}/NEWDB.withOld_h.index"
+    "$MMSEQS" rmdb "${TMP_PATH}/NEWDB.withOld"
+    "$MMSEQS" rmdb "${TMP_PATH}/NEWDB.withOld_h"
+    rm -f "${TMP_PATH}/NEWDB.withOld.lookup"
 fi
 
 debugWait
@@ -286,17 +290,11 @@ if [ -n "$REMOVE_TMP" ]; then
     echo "Remove temporary files 3/3"
     rm -f "${TMP_PATH}/newSeqs.mapped" "${TMP_PATH}/mappingSeqs.reverse" "${TMP_PATH}/newMappingSeqs"
 
-	rm -f "${TMP_PATH}/newClusters" "${TMP_PATH}/newClusters.index" \
-	      "${TMP_PATH}/toBeClusteredSeparately" "${TMP_PATH}/toBeClusteredSeparately.index" \
-	      "${TMP_PATH}/noHitSeqList" "${TMP_PATH}/newSeqsHits.index" "${TMP_PATH}/newSeqsHits" \
-	      "${TMP_PATH}/newSeqsHits.swapped" "${TMP_PATH}/newSeqsHits.swapped.index"
-
-	rm -f "${TMP_PATH}/newSeqsHits.swapped.all" "${TMP_PATH}/newSeqsHits.swapped.all.index" \
-	      "${TMP_PATH}/NEWDB.newSeqs" "${TMP_PATH}/NEWDB.newSeqs.index" \
-	      "${TMP_PATH}/mappingSeqs" "${TMP_PATH}/newSeqs" "${TMP_PATH}/removedSeqs"
-
-	rm -f "${TMP_PATH}/OLDDB.repSeq" "${TMP_PATH}/OLDDB.repSeq.index" \
-	      "${TMP_PATH}/updatedClust" "${TMP_PATH}/updatedClust.index"
+	for DB in newClusters toBeClusteredSeparately newSeqsHits newSeqsHits.swapped newSeqsHits.swapped.all \
+	          NEWDB.newSeqs OLDDB.repSeq updatedClust; do
+	    "$MMSEQS" rmdb "${TMP_PATH}/${DB}"
+	done
+	rm -f "${TMP_PATH}/noHitSeqList" "${TMP_PATH}/mappingSeqs" "${TMP_PATH}/newSeqs" "${TMP_PATH}/removedSeqs"
 
 	rmdir "${TMP_PATH}/search" "${TMP_PATH}/cluster"
 
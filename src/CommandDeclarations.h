@@ -12,10 +12,16 @@ extern int prefilter(int argc, const char **argv, const Command& command);
 extern int createdb(int argc, const char **argv, const Command& command);
 extern int result2flat(int argc, const char **argv, const Command& command);
 extern int createindex(int argc, const char **argv, const Command& command);
+extern int createbinaryindex(int argc, const char **argv, const Command& command);
+extern int rmdb(int argc, const char **argv, const Command& command);
+extern int mvdb(int argc, const char **argv, const Command& command);
 extern int indexdb(int argc, const char **argv, const Command& command);
 extern int mergedbs(int argc, const char **argv, const Command& command);
 extern int mergeclusters(int argc, const char **argv, const Command& command);
 extern int align(int argc, const char **argv, const Command& command);
+extern int prefilteralign(int argc, const char **argv, const Command& command);
+extern int server(int argc, const char **argv, const Command& command);
+extern int prefilterstats(int argc, const char **argv, const Command& command);
 extern int alignall(int argc, const char **argv, const Command& command);
 extern int createseqfiledb(int argc, const char **argv, const Command& command);
 extern int swapresults(int argc, const char **argv, const Command& command);
@@ -10,6 +10,7 @@
 #include "SubstitutionMatrix.h"
 #include "PrefilteringIndexReader.h"
 #include "FileUtil.h"
+#include "Checkpoint.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -25,7 +26,14 @@ Alignment::Alignment(const std::string &querySeqDB, const std::string &querySeqD
         includeIdentity(par.includeIdentity), addBacktrace(par.addBacktrace), realign(par.realign), scoreBias(par.scoreBias),
         threads(static_cast<unsigned int>(par.threads)), outDB(outDB), outDBIndex(outDBIndex),
         maxSeqLen(par.maxSeqLen), compBiasCorrection(par.compBiasCorrection), altAlignment(par.altAlignment), qdbr(NULL), qSeqLookup(NULL),
-        tdbr(NULL), tidxdbr(NULL), tSeqLookup(NULL), templateDBIsIndex(false), earlyExit(par.earlyExit)  {
+        tdbr(NULL), tidxdbr(NULL), tSeqLookup(NULL), templateDBIsIndex(false), prefetchTargets(false), earlyExit(par.earlyExit),
+        checkpointChunks(par.checkpointChunks), checkpointParameters(Checkpoint::describeParameters(par, par.align)),
+        writerMode((par.compressed ? DBWriter::COMPRESSED_MODE : DBWriter::ASCII_MODE)
+                   | (par.asyncWrite ? DBWriter::ASYNC_MODE : 0)
+                   | (par.shardedOutput ? DBWriter::SHARDED_MODE : 0)
+                   | (par.binaryOutput ? DBWriter::BINARY_MODE : 0)),
+        binaryOutput(par.binaryOutput),
+        outputDbType(par.binaryOutput ? DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY : -1) {
 
 
     unsigned int alignmentMode = par.alignmentMode;
@@ -61,6 +69,10 @@ Alignment::Alignment(const std::string &querySeqDB, const std::string &querySeqD
         Debug(Debug::INFO) << "Use index  " << indexDB << "\n";
 
         tidxdbr = new DBReader<unsigned int>(indexDB.c_str(), (indexDB + ".index").c_str());
+        // index blocks are referenced for the whole run and cannot be read entry by entry
+        if (tidxdbr->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD) {
+            tidxdbr->setLoadMode(DBReader<unsigned int>::LOAD_MODE_MMAP);
+        }
         tidxdbr->open(DBReader<unsigned int>::NOSORT);
 
         templateDBIsIndex = PrefilteringIndexReader::checkIfIndexFile(tidxdbr);
@@ -86,16 +98,20 @@ Alignment::Alignment(const std::string &querySeqDB, const std::string &querySeqD
     }
 
     if (templateDBIsIndex == false) {
-        tdbr = new DBReader<unsigned int>(targetSeqDB.c_str(), targetSeqDBIndex.c_str());
+        tdbr = new DBReader<unsigned int>(targetSeqDB.c_str(), targetSeqDBIndex.c_str(),
+                                          DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_KEY_LOOKUP);
         tdbr->open(DBReader<unsigned int>::NOSORT);
         if (par.noPreload == false) {
             tdbr->readMmapedDataInMemory();
             tdbr->mlock();
         }
+        // preloaded targets are in memory already, every prefetch would only cost system calls
+        prefetchTargets = par.noPreload || tdbr->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD;
     }
 
     sameQTDB = (targetSeqDB.compare(querySeqDB) == 0);
-    if (sameQTDB == true) {
+    // the nucleotide aligner reads the raw query entry while the target entry is loaded
+    if (sameQTDB == true && tdbr->hasTransientEntries() == false) {
         qdbr = tdbr;
         qSeqLookup = tSeqLookup;
         querySeqType = targetSeqType;
@@ -149,8 +165,11 @@ Alignment::Alignment(const std::string &querySeqDB, const std::string &querySeqD
     Debug(Debug::INFO) << "Query database type: " << DBReader<unsigned int>::getDbTypeName(querySeqType) << "\n";
     Debug(Debug::INFO) << "Target database type: " << DBReader<unsigned int>::getDbTypeName(targetSeqType) << "\n";
 
-    prefdbr = new DBReader<unsigned int>(prefDB.c_str(), prefDBIndex.c_str());
-    prefdbr->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    prefdbr = NULL;
+    if (prefDB.empty() == false) {
+        prefdbr = new DBReader<unsigned int>(prefDB.c_str(), prefDBIndex.c_str());
+        prefdbr->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    }
 
     if (querySeqType == Sequence::NUCLEOTIDES) {
         m = new NucleotideMatrix(par.scoringMatrixFile.c_str(), 1.0, scoreBias);
@@ -173,6 +192,8 @@ Alignment::Alignment(const std::string &querySeqDB, const std::string &querySeqD
     } else {
         realign_m = NULL;
     }
+
+    evaluer = new EvalueComputation(tdbr->getAminoAcidDBSize(), this->m, gapOpen, gapExtend, true);
 }
 
 void Alignment::initSWMode(unsigned int alignmentMode) {
@@ -215,11 +236,17 @@ void Alignment::initSWMode(unsigned int alignmentMode) {
 }
 
 Alignment::~Alignment() {
+    delete evaluer;
     if (realign == true) {
         delete realign_m;
     }
     delete m;
 
+    if (qdbr != tdbr) {
+        qdbr->close();
+        delete qdbr;
+    }
+
     tdbr->close();
     delete tdbr;
 
@@ -229,17 +256,53 @@ Alignment::~Alignment() {
         delete tidxdbr;
     }
 
-    if (sameQTDB == false) {
+    if (prefdbr != NULL) {
+        prefdbr->close();
+        delete prefdbr;
+    }
+}
+
+void Alignment::setQueryDatabase(const std::string &querySeqDB, const std::string &querySeqDBIndex) {
+    if (qdbr != tdbr) {
         qdbr->close();
         delete qdbr;
     }
+    sameQTDB = false;
+    qSeqLookup = NULL;
+
+    qdbr = new DBReader<unsigned int>(querySeqDB.c_str(), querySeqDBIndex.c_str());
+    qdbr->open(DBReader<unsigned int>::NOSORT);
+    int dbtype = qdbr->getDbtype();
+    if (dbtype == Sequence::HMM_PROFILE && targetSeqType == Sequence::PROFILE_STATE_SEQ) {
+        dbtype = Sequence::PROFILE_STATE_PROFILE;
+    }
+    if (dbtype != querySeqType) {
+        Debug(Debug::ERROR) << "Query database " << querySeqDB << " has type " << DBReader<unsigned int>::getDbTypeName(dbtype)
+                            << ", expected " << DBReader<unsigned int>::getDbTypeName(querySeqType) << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+
+Alignment::Worker::Worker(const Alignment &aln) :
+        qSeq(aln.maxSeqLen, aln.querySeqType, aln.m, 0, false, aln.compBiasCorrection),
+        dbSeq(aln.maxSeqLen, aln.targetSeqType, aln.m, 0, false, aln.compBiasCorrection),
+        matcher(aln.querySeqType, aln.maxSeqLen, aln.m, aln.evaluer, aln.compBiasCorrection, aln.gapOpen, aln.gapExtend),
+        realigner(NULL) {
+    if (aln.realign == true) {
+        realigner = new Matcher(aln.querySeqType, aln.maxSeqLen, aln.realign_m, aln.evaluer, aln.compBiasCorrection, aln.gapOpen, aln.gapExtend);
+    }
+    out.reserve(1024 * 1024);
+}
 
-    prefdbr->close();
-    delete prefdbr;
+Alignment::Worker::~Worker() {
+    delete realigner;
 }
 
 void Alignment::run(const unsigned int mpiRank, const unsigned int mpiNumProc,
                     const unsigned int maxAlnNum, const unsigned int maxRejected) {
+    if (outputDbType == -1 && MMseqsMPI::isMaster()) {
+        DBWriter::removeDbtypeFile(outDB.c_str());
+    }
 
     size_t dbFrom = 0;
     size_t dbSize = 0;
@@ -259,14 +322,66 @@ void Alignment::run(const unsigned int mpiRank, const unsigned int mpiNumProc,
         for (unsigned int proc = 0; proc < mpiNumProc; proc++) {
             splitFiles.push_back(Util::createTmpFileNames(outDB, outDBIndex, proc));
         }
-
-        // merge output databases
-        DBWriter::mergeResults(outDB, outDBIndex, splitFiles);
+        mergeOutput(splitFiles);
     }
 }
 
 void Alignment::run(const unsigned int maxAlnNum, const unsigned int maxRejected) {
-    run(outDB, outDBIndex, 0, prefdbr->getSize(), maxAlnNum, maxRejected);
+    if (outputDbType == -1) {
+        // text results have no dbtype, one of an earlier binary run would describe them as binary
+        DBWriter::removeDbtypeFile(outDB.c_str());
+    }
+    const size_t chunks = std::min(prefdbr->getSize(), static_cast<size_t>(checkpointChunks));
+    if (chunks == 0) {
+        run(outDB, outDBIndex, 0, prefdbr->getSize(), maxAlnNum, maxRejected);
+    } else {
+        std::string job = "align " + SSTR(chunks) + " " + Checkpoint::describeDatabase(qdbr->getIndexFileName())
+                          + " " + Checkpoint::describeDatabase(tdbr->getIndexFileName())
+                          + " " + Checkpoint::describeDatabase(prefdbr->getIndexFileName())
+                          + " " + SSTR(maxAlnNum) + " " + SSTR(maxRejected) + " " + checkpointParameters;
+        Checkpoint checkpoint(outDB, job);
+        std::vector<std::pair<std::string, std::string> > splitFiles;
+        for (size_t i = 0; i < chunks; i++) {
+            std::pair<std::string, std::string> files = Util::createTmpFileNames(outDB, outDBIndex, i);
+            bool hasResult;
+            if (checkpoint.isDone(i, files, &hasResult) == false) {
+                size_t dbFrom = 0;
+                size_t dbSize = 0;
+                Util::decomposeDomainByAminoAcid(prefdbr->getAminoAcidDBSize(), prefdbr->getSeqLens(),
+                                                 prefdbr->getSize(), i, chunks, &dbFrom, &dbSize);
+                hasResult = dbSize > 0;
+                if (hasResult) {
+                    Debug(Debug::INFO) << "Align chunk " << (i + 1) << " of " << chunks << " from " << dbFrom << " to " << (dbFrom + dbSize) << "\n";
+                    run(files.first, files.second, dbFrom, dbSize, maxAlnNum, maxRejected);
+                }
+                checkpoint.commit(i, hasResult, files);
+            } else {
+                Debug(Debug::INFO) << "Alignment chunk " << (i + 1) << " of " << chunks << " was finished before\n";
+            }
+            if (hasResult) {
+                splitFiles.push_back(files);
+            }
+        }
+        mergeOutput(splitFiles);
+        checkpoint.finish();
+    }
+
+#ifndef HAVE_MPI
+    if (earlyExit) {
+        Debug(Debug::INFO) << "Done. Exiting early now.\n";
+        _Exit(EXIT_SUCCESS);
+    }
+#endif
+}
+
+void Alignment::mergeOutput(const std::vector<std::pair<std::string, std::string> > &splitFiles) {
+    DBWriter::mergeResults(outDB, outDBIndex, splitFiles);
+    if (outputDbType != -1) {
+        for (size_t i = 0; i < splitFiles.size(); i++) {
+            FileUtil::deleteFile(splitFiles[i].first + ".dbtype");
+        }
+        DBWriter::writeDbtypeFile(outDB.c_str(), outputDbType);
+    }
 }
 
 void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
@@ -275,10 +390,10 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
     size_t alignmentsNum = 0;
     size_t totalPassedNum = 0;
 
-    DBWriter dbw(outDB.c_str(), outDBIndex.c_str(), threads);
+    DBWriter dbw(outDB.c_str(), outDBIndex.c_str(), threads, writerMode);
     dbw.open();
 
-    EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), this->m, gapOpen, gapExtend, true);
+    const bool binaryPrefilter = (prefdbr->getDbtype() == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY);
     size_t totalMemory = Util::getTotalSystemMemory();
     size_t flushSize = 1000000;
     if(totalMemory > prefdbr->getDataSize()){
@@ -290,16 +405,7 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
 #endif
-        std::string alnResultsOutString;
-        alnResultsOutString.reserve(1024*1024);
-        char buffer[1024+32768];
-        Sequence qSeq(maxSeqLen, querySeqType, m, 0, false, compBiasCorrection);
-        Sequence dbSeq(maxSeqLen, targetSeqType, m, 0, false, compBiasCorrection);
-        Matcher matcher(querySeqType, maxSeqLen, m, &evaluer, compBiasCorrection, gapOpen, gapExtend);
-        Matcher *realigner = NULL;
-        if (realign ==  true) {
-            realigner = new Matcher(querySeqType, maxSeqLen, realign_m, &evaluer, compBiasCorrection, gapOpen, gapExtend);
-        }
+        Worker worker(*this);
 
         size_t iterations = static_cast<size_t>(ceil(static_cast<double>(dbSize) / static_cast<double>(flushSize)));
         for (size_t i = 0; i < iterations; i++) {
@@ -310,117 +416,36 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
             for (size_t id = start; id < (start + bucketSize); id++) {
                 Debug::printProgress(id);
 
-                // get the prefiltering list
+                // parse the prefiltering list
                 char *data = prefdbr->getData(id);
-                unsigned int queryDbKey = prefdbr->getDbKey(id);
-                setQuerySequence(qSeq, id, queryDbKey);
-
-                matcher.initQuery(&qSeq);
-                // parse the prefiltering list and calculate a Smith-Waterman alignment for each sequence in the list
-                std::vector<Matcher::result_t> swResults;
-                size_t passedNum = 0;
-                unsigned int rejected = 0;
-
-                while (*data != '\0' && passedNum < maxAlnNum && rejected < maxRejected) {
-                    // DB key of the db sequence
-                    char dbKeyBuffer[255 + 1];
-                    char * words[10];
-                    Util::parseKey(data, dbKeyBuffer);
-                    const unsigned int dbKey = (unsigned int) strtoul(dbKeyBuffer, NULL, 10);
-
-                    size_t elements = Util::getWordsOfLine(data, words, 10);
-                    int diagonal = INT_MAX;
-                    // Prefilter result (need to make this better)
-                    if(elements == 3){
-                        hit_t hit = QueryMatcher::parsePrefilterHit(data);
-                        diagonal = hit.diagonal;
-                    }
-
-                    setTargetSequence(dbSeq, dbKey);
-                    // check if the sequences could pass the coverage threshold
-                    if(Util::canBeCovered(covThr, covMode, static_cast<float>(qSeq.L), static_cast<float>(dbSeq.L)) == false )
-                    {
-                        rejected++;
-                        data = Util::skipLine(data);
-                        continue;
-                    }
-                    const bool isIdentity = (queryDbKey == dbKey && (includeIdentity || sameQTDB)) ? true : false;
-
-                    // calculate Smith-Waterman alignment
-                    Matcher::result_t res = matcher.getSWResult(&dbSeq, diagonal, covMode, covThr, evalThr, swMode, seqIdMode, isIdentity);
-                    alignmentsNum++;
-
-                    //set coverage and seqid if identity
-                    if (isIdentity) {
-                        res.qcov = 1.0f;
-                        res.dbcov = 1.0f;
-                        res.seqId = 1.0f;
-                    }
-                    if(checkCriteriaAndAddHitToList(res, isIdentity, swResults)){
-                        passedNum++;
-                        totalPassedNum++;
-                        rejected = 0;
-                    }else{
-                        rejected++;
+                worker.targets.clear();
+                if (binaryPrefilter) {
+                    const size_t hitCount = (prefdbr->getSeqLens(id) - 1) / sizeof(hit_t);
+                    for (size_t hitIdx = 0; hitIdx < hitCount; hitIdx++) {
+                        hit_t hit;
+                        memcpy(&hit, data + hitIdx * sizeof(hit_t), sizeof(hit_t));
+                        Target target = { hit.seqId, hit.diagonal };
+                        worker.targets.push_back(target);
                     }
-
-                    data = Util::skipLine(data);
-                }
-                if(altAlignment> 0){
-                    int xIndex = m->aa2int['X'];
-                    size_t firstItResSize = swResults.size();
-                    for(size_t i = 0; i < firstItResSize; i++) {
-                        const bool isIdentity = (queryDbKey == swResults[i].dbKey && (includeIdentity || sameQTDB))
-                                                ? true : false;
-                        if (isIdentity == true) {
-                            continue;
-                        }
-                        setTargetSequence(dbSeq, swResults[i].dbKey);
-                        for (int pos = swResults[i].dbStartPos; pos < swResults[i].dbEndPos; ++pos) {
-                            dbSeq.int_sequence[pos] = xIndex;
+                } else {
+                    while (*data != '\0') {
+                        char dbKeyBuffer[255 + 1];
+                        char * words[10];
+                        Util::parseKey(data, dbKeyBuffer);
+                        Target target = { (unsigned int) strtoul(dbKeyBuffer, NULL, 10), INT_MAX };
+
+                        size_t elements = Util::getWordsOfLine(data, words, 10);
+                        // Prefilter result (need to make this better)
+                        if(elements == 3){
+                            hit_t hit = QueryMatcher::parsePrefilterHit(data);
+                            target.diagonal = hit.diagonal;
                         }
-                        bool nextAlignment = true;
-                        for (int altAli = 0; altAli < altAlignment && nextAlignment; altAli++) {
-                            Matcher::result_t res = matcher.getSWResult(&dbSeq, 0, covMode, covThr, evalThr, swMode,
-                                                                        seqIdMode, isIdentity);
-                            nextAlignment = checkCriteriaAndAddHitToList(res, isIdentity, swResults);
-                            if (nextAlignment == true) {
-                                for (int pos = res.dbStartPos; pos < res.dbEndPos; pos++) {
-                                    dbSeq.int_sequence[pos] = xIndex;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // write the results
-                std::sort(swResults.begin(), swResults.end(), Matcher::compareHits);
-                if (realign == true) {
-                    realigner->initQuery(&qSeq);
-                    for (size_t result = 0; result < swResults.size(); result++) {
-                        setTargetSequence(dbSeq, swResults[result].dbKey);
-                        const bool isIdentity = (queryDbKey == swResults[result].dbKey && (includeIdentity || sameQTDB)) ? true : false;
-                        Matcher::result_t res = realigner->getSWResult(&dbSeq, INT_MAX, covMode, covThr, FLT_MAX,
-                                                                       Matcher::SCORE_COV_SEQID, seqIdMode, isIdentity);
-                        swResults[result].backtrace  = res.backtrace;
-                        swResults[result].qStartPos  = res.qStartPos;
-                        swResults[result].qEndPos    = res.qEndPos;
-                        swResults[result].dbStartPos = res.dbStartPos;
-                        swResults[result].dbEndPos   = res.dbEndPos;
-                        swResults[result].alnLength  = res.alnLength;
-                        swResults[result].seqId      = res.seqId;
-                        swResults[result].qcov       = res.qcov;
-                        swResults[result].dbcov      = res.dbcov;
+                        worker.targets.push_back(target);
+                        data = Util::skipLine(data);
                     }
                 }
 
-                // put the contents of the swResults list into ffindex DB
-                for (size_t result = 0; result < swResults.size(); result++) {
-                    size_t len = Matcher::resultToBuffer(buffer, swResults[result], addBacktrace);
-                    alnResultsOutString.append(buffer, len);
-                }
-                dbw.writeData(alnResultsOutString.c_str(), alnResultsOutString.length(), qSeq.getDbKey(), thread_idx);
-                alnResultsOutString.clear();
+                alignmentsNum += alignQuery(worker, prefdbr->getDbKey(id), maxAlnNum, maxRejected, dbw, thread_idx, totalPassedNum);
             }
 
 #pragma omp barrier
@@ -431,10 +456,11 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
         }
 
 #ifndef HAVE_MPI
-        if (earlyExit) {
+        // chunked runs exit after merging the chunks
+        if (earlyExit && checkpointChunks == 0) {
 #pragma omp barrier
             if(thread_idx == 0) {
-                dbw.close();
+                dbw.close(outputDbType);
                 Debug(Debug::INFO) << "Done. Exiting early now.\n";
             }
 #pragma omp barrier
@@ -442,13 +468,9 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
             _Exit(EXIT_SUCCESS);
         }
 #endif
-
-        if (realign == true) {
-            delete realigner;
-        }
     }
 
-    dbw.close();
+    dbw.close(outputDbType);
 
     Debug(Debug::INFO) << "\nAll sequences processed.\n\n";
     Debug(Debug::INFO) << alignmentsNum << " alignments calculated.\n";
@@ -461,6 +483,120 @@ void Alignment::run(const std::string &outDB, const std::string &outDBIndex,
     Debug(Debug::INFO) << hits_f << " hits per query sequence.\n";
 }
 
+size_t Alignment::alignQuery(Worker &worker, unsigned int queryDbKey, const unsigned int maxAlnNum, const unsigned int maxRejected,
+                             DBWriter &dbw, unsigned int thread_idx, size_t &passed) {
+    Sequence &qSeq = worker.qSeq;
+    Sequence &dbSeq = worker.dbSeq;
+    Matcher &matcher = worker.matcher;
+    const std::vector<Target> &targets = worker.targets;
+    size_t alignmentsNum = 0;
+
+    setQuerySequence(qSeq, qdbr->getId(queryDbKey), queryDbKey);
+    matcher.initQuery(&qSeq);
+
+    if (prefetchTargets) {
+        // at most maxAlnNum + maxRejected targets are looked at
+        const size_t maxTargets = static_cast<size_t>(maxAlnNum) + static_cast<size_t>(maxRejected);
+        worker.prefetchIds.clear();
+        for (size_t i = 0; i < targets.size() && worker.prefetchIds.size() < maxTargets; i++) {
+            worker.prefetchIds.push_back(tdbr->getId(targets[i].dbKey));
+        }
+        tdbr->prefetch(worker.prefetchIds);
+    }
+
+    // calculate a Smith-Waterman alignment for each sequence in the list
+    std::vector<Matcher::result_t> swResults;
+    size_t passedNum = 0;
+    unsigned int rejected = 0;
+    for (size_t i = 0; i < targets.size() && passedNum < maxAlnNum && rejected < maxRejected; i++) {
+        const unsigned int dbKey = targets[i].dbKey;
+        setTargetSequence(dbSeq, dbKey);
+        // check if the sequences could pass the coverage threshold
+        if(Util::canBeCovered(covThr, covMode, static_cast<float>(qSeq.L), static_cast<float>(dbSeq.L)) == false )
+        {
+            rejected++;
+            continue;
+        }
+        const bool isIdentity = (queryDbKey == dbKey && (includeIdentity || sameQTDB)) ? true : false;
+
+        // calculate Smith-Waterman alignment
+        Matcher::result_t res = matcher.getSWResult(&dbSeq, targets[i].diagonal, covMode, covThr, evalThr, swMode, seqIdMode, isIdentity);
+        alignmentsNum++;
+
+        //set coverage and seqid if identity
+        if (isIdentity) {
+            res.qcov = 1.0f;
+            res.dbcov = 1.0f;
+            res.seqId = 1.0f;
+        }
+        if(checkCriteriaAndAddHitToList(res, isIdentity, swResults)){
+            passedNum++;
+            rejected = 0;
+        }else{
+            rejected++;
+        }
+    }
+    passed += passedNum;
+    if(altAlignment> 0){
+        int xIndex = m->aa2int['X'];
+        size_t firstItResSize = swResults.size();
+        for(size_t i = 0; i < firstItResSize; i++) {
+            const bool isIdentity = (queryDbKey == swResults[i].dbKey && (includeIdentity || sameQTDB))
+                                    ? true : false;
+            if (isIdentity == true) {
+                continue;
+            }
+            setTargetSequence(dbSeq, swResults[i].dbKey);
+            for (int pos = swResults[i].dbStartPos; pos < swResults[i].dbEndPos; ++pos) {
+                dbSeq.int_sequence[pos] = xIndex;
+            }
+            bool nextAlignment = true;
+            for (int altAli = 0; altAli < altAlignment && nextAlignment; altAli++) {
+                Matcher::result_t res = matcher.getSWResult(&dbSeq, 0, covMode, covThr, evalThr, swMode,
+                                                            seqIdMode, isIdentity);
+                nextAlignment = checkCriteriaAndAddHitToList(res, isIdentity, swResults);
+                if (nextAlignment == true) {
+                    for (int pos = res.dbStartPos; pos < res.dbEndPos; pos++) {
+                        dbSeq.int_sequence[pos] = xIndex;
+                    }
+                }
+            }
+        }
+    }
+
+    // write the results
+    std::sort(swResults.begin(), swResults.end(), Matcher::compareHits);
+    if (realign == true) {
+        worker.realigner->initQuery(&qSeq);
+        for (size_t result = 0; result < swResults.size(); result++) {
+            setTargetSequence(dbSeq, swResults[result].dbKey);
+            const bool isIdentity = (queryDbKey == swResults[result].dbKey && (includeIdentity || sameQTDB)) ? true : false;
+            Matcher::result_t res = worker.realigner->getSWResult(&dbSeq, INT_MAX, covMode, covThr, FLT_MAX,
+                                                                  Matcher::SCORE_COV_SEQID, seqIdMode, isIdentity);
+            swResults[result].backtrace  = res.backtrace;
+            swResults[result].qStartPos  = res.qStartPos;
+            swResults[result].qEndPos    = res.qEndPos;
+            swResults[result].dbStartPos = res.dbStartPos;
+            swResults[result].dbEndPos   = res.dbEndPos;
+            swResults[result].alnLength  = res.alnLength;
+            swResults[result].seqId      = res.seqId;
+            swResults[result].qcov       = res.qcov;
+            swResults[result].dbcov      = res.dbcov;
+        }
+    }
+
+    // put the contents of the swResults list into ffindex DB
+    char buffer[1024+32768];
+    for (size_t result = 0; result < swResults.size(); result++) {
+        size_t len = binaryOutput ? Matcher::resultToBinaryBuffer(buffer, swResults[result], addBacktrace)
+                                  : Matcher::resultToBuffer(buffer, swResults[result], addBacktrace);
+        worker.out.append(buffer, len);
+    }
+    dbw.writeData(worker.out.c_str(), worker.out.length(), qSeq.getDbKey(), thread_idx);
+    worker.out.clear();
+    return alignmentsNum;
+}
+
 inline void Alignment::setQuerySequence(Sequence &seq, size_t id, unsigned int key) {
     if (qSeqLookup != NULL) {
         std::pair<const unsigned char*, const unsigned int> sequence = qSeqLookup->getSequence(id);
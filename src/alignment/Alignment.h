@@ -2,8 +2,10 @@
 #define ALIGNMENT_H
 
 #include <string>
+#include <vector>
 
 #include "DBReader.h"
+#include "DBWriter.h"
 #include "Parameters.h"
 #include "BaseMatrix.h"
 #include "Sequence.h"
@@ -14,6 +16,7 @@ class Alignment {
 
 public:
 
+    // prefDB can be empty if the targets are passed to alignQuery directly, run is not available then
     Alignment(const std::string &querySeqDB, const std::string &querySeqDBIndex,
               const std::string &targetSeqDB, const std::string &targetSeqDBIndex,
               const std::string &prefDB, const std::string &prefDBIndex,
@@ -22,7 +25,7 @@ public:
 
     ~Alignment();
 
-    //None MPI
+    //None MPI, queries are aligned in chunks if checkpointing is enabled
     void run(const unsigned int maxAlnNum, const unsigned int maxRejected);
 
     //MPI function
@@ -34,6 +37,47 @@ public:
              const size_t dbFrom, const size_t dbSize,
              const unsigned int maxAlnNum, const unsigned int maxRejected);
 
+    // target of a query, diagonal is INT_MAX if unknown
+    struct Target {
+        unsigned int dbKey;
+        int diagonal;
+    };
+
+    // thread local sequences, matchers and buffers of alignQuery
+    struct Worker {
+        Worker(const Alignment &aln);
+        ~Worker();
+
+        Sequence qSeq;
+        Sequence dbSeq;
+        Matcher matcher;
+        Matcher *realigner;
+        std::vector<Target> targets;
+        std::vector<size_t> prefetchIds;
+        std::string out;
+    };
+
+    // aligns worker.targets in order until maxAlnNum were accepted or maxRejected in a row failed
+    // and writes the accepted alignments as entry queryKey with dbw
+    // returns the number of computed alignments, passed is increased by the accepted ones
+    size_t alignQuery(Worker &worker, unsigned int queryKey, const unsigned int maxAlnNum, const unsigned int maxRejected,
+                      DBWriter &dbw, unsigned int thread_idx, size_t &passed);
+
+    // replaces the query database, the target database and the matrices stay loaded
+    void setQueryDatabase(const std::string &querySeqDB, const std::string &querySeqDBIndex);
+
+    size_t getWriterMode() {
+        return writerMode;
+    }
+
+    int getOutputDbType() {
+        return outputDbType;
+    }
+
+    const std::string &getCheckpointParameters() {
+        return checkpointParameters;
+    }
+
 private:
     // sequence coverage threshold
     const double covThr;
@@ -97,12 +141,30 @@ private:
 
     DBReader<unsigned int> *prefdbr;
 
+    EvalueComputation *evaluer;
+
     bool templateDBIsIndex;
 
+    // the target entries are read from disk while aligning, see alignQuery
+    bool prefetchTargets;
+
     const bool earlyExit;
 
+    // query chunks that are committed one by one and skipped by a restarted run
+    const int checkpointChunks;
+    // part of the job of the checkpoint
+    const std::string checkpointParameters;
+
+    const size_t writerMode;
+
+    // alignments are written as binary records
+    const bool binaryOutput;
+    const int outputDbType;
+
     void initSWMode(unsigned int alignmentMode);
 
+    void mergeOutput(const std::vector<std::pair<std::string, std::string> > &splitFiles);
+
     void setQuerySequence(Sequence &seq, size_t id, unsigned int key);
 
     void setTargetSequence(Sequence &seq, unsigned int key);
@@ -24,7 +24,7 @@ Matcher::Matcher(int querySeqType, int maxSeqLen, BaseMatrix *m, EvalueComputati
     if(querySeqType==Sequence::NUCLEOTIDES){
         nuclaligner = new  BandedNucleotideAligner(m, maxSeqLen, gapOpen, gapExtend);
     }else{
-        aligner = new SmithWaterman(maxSeqLen, m->alphabetSize, aaBiasCorrection);
+        aligner = SmithWaterman::create(maxSeqLen, m->alphabetSize, aaBiasCorrection);
     }
     this->evaluer = evaluer;
     //std::cout << "lambda=" << lambdaLog2 << " logKLog2=" << logKLog2 << std::endl;
@@ -198,6 +198,14 @@ std::vector<Matcher::result_t> Matcher::readAlignmentResults(char *data, bool re
     return ret;
 }
 
+std::vector<Matcher::result_t> Matcher::readAlignmentResults(char *data, size_t entryLength, bool binaryResult, bool readCompressed) {
+    std::vector<Matcher::result_t> ret;
+    for (ResultIterator it(data, entryLength, binaryResult); it.hasNext(); it.next()) {
+        ret.push_back(it.getResult(readCompressed));
+    }
+    return ret;
+}
+
 size_t Matcher::computeAlnLength(size_t qStart, size_t qEnd, size_t dbStart, size_t dbEnd) {
     return std::max(qEnd - qStart, dbEnd - dbStart) + 1;
 }
@@ -290,6 +298,203 @@ Matcher::result_t Matcher::parseAlignmentRecord(char *data, bool readCompressed)
 }
 
 
+template <typename T>
+static inline char *writeBinaryField(char *buffer, const T value) {
+    memcpy(buffer, &value, sizeof(T));
+    return buffer + sizeof(T);
+}
+
+template <typename T>
+static inline const char *readBinaryField(const char *buffer, T &value) {
+    memcpy(&value, buffer, sizeof(T));
+    return buffer + sizeof(T);
+}
+
+const char *Matcher::parseBinaryAlignmentRecord(const char *data, result_t &result, bool readCompressed) {
+    const char *pos = readBinaryField(data, result.dbKey);
+    pos = readBinaryField(pos, result.score);
+    pos = readBinaryField(pos, result.seqId);
+    pos = readBinaryField(pos, result.eval);
+    pos = readBinaryField(pos, result.qStartPos);
+    pos = readBinaryField(pos, result.qEndPos);
+    pos = readBinaryField(pos, result.qLen);
+    pos = readBinaryField(pos, result.dbStartPos);
+    pos = readBinaryField(pos, result.dbEndPos);
+    pos = readBinaryField(pos, result.dbLen);
+    unsigned int backtraceLength;
+    pos = readBinaryField(pos, backtraceLength);
+
+    // coverage and alignment length are derived the same way as for text records
+    int adjustQstart = (result.qStartPos == -1) ? 0 : result.qStartPos;
+    int adjustDBstart = (result.dbStartPos == -1) ? 0 : result.dbStartPos;
+    result.qcov = SmithWaterman::computeCov(adjustQstart, result.qEndPos, result.qLen);
+    result.dbcov = SmithWaterman::computeCov(adjustDBstart, result.dbEndPos, result.dbLen);
+    result.alnLength = Matcher::computeAlnLength(adjustQstart, result.qEndPos, adjustDBstart, result.dbEndPos);
+
+    if (readCompressed) {
+        result.backtrace.assign(pos, backtraceLength);
+    } else {
+        result.backtrace = uncompressAlignment(std::string(pos, backtraceLength));
+    }
+    return pos + backtraceLength;
+}
+
+const char *Matcher::skipBinaryAlignmentRecord(const char *data, unsigned int &dbKey) {
+    unsigned int backtraceLength;
+    readBinaryField(data, dbKey);
+    readBinaryField(data + BINARY_RESULT_FIXED_SIZE - sizeof(unsigned int), backtraceLength);
+    return data + BINARY_RESULT_FIXED_SIZE + backtraceLength;
+}
+
+bool Matcher::hasBinaryAlignmentRecord(const char *data, const char *end) {
+    if (data + BINARY_RESULT_FIXED_SIZE > end) {
+        return false;
+    }
+    unsigned int backtraceLength;
+    readBinaryField(data + BINARY_RESULT_FIXED_SIZE - sizeof(unsigned int), backtraceLength);
+    return (size_t) (end - data) >= BINARY_RESULT_FIXED_SIZE + backtraceLength;
+}
+
+size_t Matcher::countBinaryAlignmentResults(const char *data, size_t entryLength) {
+    if (data == NULL || entryLength == 0) {
+        return 0;
+    }
+    size_t count = 0;
+    const char *end = data + entryLength - 1;
+    while (hasBinaryAlignmentRecord(data, end)) {
+        unsigned int dbKey;
+        data = skipBinaryAlignmentRecord(data, dbKey);
+        count++;
+    }
+    return count;
+}
+
+Matcher::ResultIterator::ResultIterator(char *data, size_t entryLength, bool binaryResult)
+        : pos(data), end((data == NULL || entryLength == 0) ? data : data + entryLength - 1), binaryResult(binaryResult) {}
+
+bool Matcher::ResultIterator::hasNext() const {
+    if (pos == NULL) {
+        return false;
+    }
+    return binaryResult ? hasBinaryAlignmentRecord(pos, end) : (*pos != '\0');
+}
+
+void Matcher::ResultIterator::next() {
+    pos += getRecordLength();
+}
+
+unsigned int Matcher::ResultIterator::getDbKey() const {
+    unsigned int dbKey;
+    if (binaryResult) {
+        readBinaryField(pos, dbKey);
+    } else {
+        char key[255 + 1];
+        Util::parseKey(pos, key);
+        dbKey = (unsigned int) strtoul(key, NULL, 10);
+    }
+    return dbKey;
+}
+
+int Matcher::ResultIterator::getScore() const {
+    int score;
+    if (binaryResult) {
+        readBinaryField(pos + sizeof(unsigned int), score);
+    } else {
+        char column[255 + 1];
+        Util::parseByColumnNumber(pos, column, 1);
+        score = (int) atof(column);
+    }
+    return score;
+}
+
+float Matcher::ResultIterator::getSeqId() const {
+    float seqId;
+    if (binaryResult) {
+        readBinaryField(pos + sizeof(unsigned int) + sizeof(int), seqId);
+    } else {
+        char column[255 + 1];
+        Util::parseByColumnNumber(pos, column, 2);
+        seqId = (float) atof(column);
+    }
+    return seqId;
+}
+
+double Matcher::ResultIterator::getEvalue() const {
+    double evalue = 0.0;
+    if (binaryResult) {
+        readBinaryField(pos + sizeof(unsigned int) + sizeof(int) + sizeof(float), evalue);
+    } else {
+        char *entry[255];
+        // prefilter lines do not have an e-value column
+        if (Util::getWordsOfLine(pos, entry, 255) >= ALN_RES_WITH_OUT_BT_COL_CNT) {
+            evalue = strtod(entry[3], NULL);
+        }
+    }
+    return evalue;
+}
+
+bool Matcher::ResultIterator::hasBacktrace() const {
+    if (binaryResult) {
+        unsigned int backtraceLength;
+        readBinaryField(pos + BINARY_RESULT_FIXED_SIZE - sizeof(unsigned int), backtraceLength);
+        return backtraceLength > 0;
+    }
+    char *entry[255];
+    return Util::getWordsOfLine(pos, entry, 255) > ALN_RES_WITH_OUT_BT_COL_CNT;
+}
+
+Matcher::result_t Matcher::ResultIterator::getResult(bool readCompressed) const {
+    if (binaryResult) {
+        result_t result;
+        parseBinaryAlignmentRecord(pos, result, readCompressed);
+        return result;
+    }
+    return parseAlignmentRecord(pos, readCompressed);
+}
+
+size_t Matcher::ResultIterator::getRecordLength() const {
+    if (binaryResult) {
+        unsigned int dbKey;
+        return skipBinaryAlignmentRecord(pos, dbKey) - pos;
+    }
+    return Util::skipLine(pos) - pos;
+}
+
+void Matcher::binaryAlignmentResultsToText(const char *data, size_t entryLength, std::string &out) {
+    if (data == NULL || entryLength == 0) {
+        return;
+    }
+    std::string buffer;
+    const char *end = data + entryLength - 1;
+    while (hasBinaryAlignmentRecord(data, end)) {
+        Matcher::result_t result;
+        data = parseBinaryAlignmentRecord(data, result, true);
+        buffer.resize(1024 + result.backtrace.size());
+        size_t len = resultToBuffer(&buffer[0], result, result.backtrace.empty() == false, false);
+        out.append(buffer.c_str(), len);
+    }
+}
+
+size_t Matcher::resultToBinaryBuffer(char * buffer, const result_t &result, bool addBacktrace, bool compress) {
+    std::string backtrace;
+    if (addBacktrace) {
+        backtrace = compress ? Matcher::compressAlignment(result.backtrace) : result.backtrace;
+    }
+    char *pos = writeBinaryField(buffer, result.dbKey);
+    pos = writeBinaryField(pos, result.score);
+    pos = writeBinaryField(pos, result.seqId);
+    pos = writeBinaryField(pos, result.eval);
+    pos = writeBinaryField(pos, result.qStartPos);
+    pos = writeBinaryField(pos, result.qEndPos);
+    pos = writeBinaryField(pos, result.qLen);
+    pos = writeBinaryField(pos, result.dbStartPos);
+    pos = writeBinaryField(pos, result.dbEndPos);
+    pos = writeBinaryField(pos, result.dbLen);
+    pos = writeBinaryField(pos, (unsigned int) backtrace.size());
+    memcpy(pos, backtrace.c_str(), backtrace.size());
+    return (pos - buffer) + backtrace.size();
+}
+
 size_t Matcher::resultToBuffer(char * buff1, const result_t &result, bool addBacktrace, bool compress) {
     char * basePos = buff1;
     char * tmpBuff = Itoa::u32toa_sse2((uint32_t) result.dbKey, buff1);
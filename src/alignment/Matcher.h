@@ -27,6 +27,9 @@ public:
 
     const static int ALN_RES_WITH_BT_COL_CNT = 11;
 
+    // dbKey, score, seqId, eval, qStart, qEnd, qLen, dbStart, dbEnd, dbLen and backtrace length
+    const static size_t BINARY_RESULT_FIXED_SIZE = 9 * sizeof(int) + sizeof(float) + sizeof(double);
+
     struct result_t {
         unsigned int dbKey;
         int score;
@@ -91,6 +94,49 @@ public:
 
     static std::vector<result_t> readAlignmentResults(char *data, bool readCompressed=false);
 
+    // reads text or binary records of one entry, entryLength includes the terminating null byte
+    static std::vector<result_t> readAlignmentResults(char *data, size_t entryLength, bool binaryResult, bool readCompressed=false);
+
+    // binary records hold the fixed width fields followed by the compressed backtrace
+    // returns a pointer to the next record
+    static const char *parseBinaryAlignmentRecord(const char *data, result_t &result, bool readCompressed=false);
+
+    // reads only the target key of a binary record, returns a pointer to the next record
+    static const char *skipBinaryAlignmentRecord(const char *data, unsigned int &dbKey);
+
+    // false if no complete record starts at data, end points to the null byte of the entry
+    static bool hasBinaryAlignmentRecord(const char *data, const char *end);
+
+    static size_t countBinaryAlignmentResults(const char *data, size_t entryLength);
+
+    static void binaryAlignmentResultsToText(const char *data, size_t entryLength, std::string &out);
+
+    // walks the records of one text or binary result entry, entryLength includes the terminating null byte
+    class ResultIterator {
+    public:
+        ResultIterator(char *data, size_t entryLength, bool binaryResult);
+
+        bool hasNext() const;
+        void next();
+
+        // only reads the fields that are asked for
+        unsigned int getDbKey() const;
+        int getScore() const;
+        float getSeqId() const;
+        double getEvalue() const;
+        bool hasBacktrace() const;
+        result_t getResult(bool readCompressed=false) const;
+
+        // raw bytes of the current record, text records include their newline
+        char *getRecord() const { return pos; }
+        size_t getRecordLength() const;
+
+    private:
+        char *pos;
+        const char *end;
+        const bool binaryResult;
+    };
+
     static float estimateSeqIdByScorePerCol(uint16_t score, unsigned int qLen, unsigned int tLen);
 
     static std::string compressAlignment(const std::string &bt);
@@ -103,6 +149,8 @@ public:
 
     static size_t resultToBuffer(char * buffer, const result_t &result, bool addBacktrace, bool compress  = true);
 
+    static size_t resultToBinaryBuffer(char * buffer, const result_t &result, bool addBacktrace, bool compress  = true);
+
     static size_t computeAlnLength(size_t anEnd, size_t start, size_t dbEnd, size_t dbStart);
 
 
@@ -30,8 +30,52 @@
 #include "SubstitutionMatrix.h"
 #include "Debug.h"
 
+#ifndef SIMD_KERNEL_VARIANT
+SmithWaterman *SmithWaterman::create(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection) {
+    return SIMD_KERNEL_DISPATCH(createSmithWaterman(maxSequenceLength, aaSize, aaBiasCorrection));
+}
+
+char SmithWaterman::cigar_int_to_op (uint32_t cigar_int)
+{
+	uint8_t letter_code = cigar_int & 0xfU;
+	static const char map[] = {
+			'M',
+			'I',
+			'D',
+			'N',
+			'S',
+			'H',
+			'P',
+			'=',
+			'X',
+	};
+
+	if (letter_code >= (sizeof(map)/sizeof(map[0]))) {
+		return 'M';
+	}
+
+	return map[letter_code];
+}
+
+uint32_t SmithWaterman::cigar_int_to_len (uint32_t cigar_int)
+{
+	uint32_t res = cigar_int >> 4;
+	return res;
+}
+
+float SmithWaterman::computeCov(unsigned int startPos, unsigned int endPos, unsigned int len) {
+    return (std::min(len, endPos) - startPos + 1) / (float) len;
+}
+#endif
+
+namespace SIMD_KERNEL_NAMESPACE {
+
+SmithWaterman *createSmithWaterman(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection) {
+    return new SmithWatermanKernel(maxSequenceLength, aaSize, aaBiasCorrection);
+}
+
 
-SmithWaterman::SmithWaterman(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection) {
+SmithWatermanKernel::SmithWatermanKernel(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection) {
 	maxSequenceLength += 1;
 	this->aaBiasCorrection = aaBiasCorrection;
 	const int segSize = (maxSequenceLength+7)/8;
@@ -64,7 +108,7 @@ SmithWaterman::SmithWaterman(size_t maxSequenceLength, int aaSize, bool aaBiasCo
 	memset(profile->composition_bias_rev, 0, maxSequenceLength * sizeof(int8_t));
 }
 
-SmithWaterman::~SmithWaterman(){
+SmithWatermanKernel::~SmithWatermanKernel(){
 	free(vHStore);
 	free(vHLoad);
 	free(vE);
@@ -89,7 +133,7 @@ SmithWaterman::~SmithWaterman(){
 
 /* Generate query profile rearrange query sequence & calculate the weight of match/mismatch. */
 template <typename T, size_t Elements, const unsigned int type>
-void SmithWaterman::createQueryProfile(simd_int *profile, const int8_t *query_sequence, const int8_t * composition_bias, const int8_t *mat,
+void SmithWatermanKernel::createQueryProfile(simd_int *profile, const int8_t *query_sequence, const int8_t * composition_bias, const int8_t *mat,
 									   const int32_t query_length, const int32_t aaSize, uint8_t bias,
 									   const int32_t offset, const int32_t entryLength) {
 
@@ -126,7 +170,7 @@ void SmithWaterman::createQueryProfile(simd_int *profile, const int8_t *query_se
 }
 
 
-s_align SmithWaterman::ssw_align (
+s_align SmithWatermanKernel::ssw_align (
 		const int *db_sequence,
 		int32_t db_length,
 		const uint8_t gap_open,
@@ -261,35 +305,7 @@ s_align SmithWaterman::ssw_align (
 
 
 
-char SmithWaterman::cigar_int_to_op (uint32_t cigar_int)
-{
-	uint8_t letter_code = cigar_int & 0xfU;
-	static const char map[] = {
-			'M',
-			'I',
-			'D',
-			'N',
-			'S',
-			'H',
-			'P',
-			'=',
-			'X',
-	};
-
-	if (letter_code >= (sizeof(map)/sizeof(map[0]))) {
-		return 'M';
-	}
-
-	return map[letter_code];
-}
-
-uint32_t SmithWaterman::cigar_int_to_len (uint32_t cigar_int)
-{
-	uint32_t res = cigar_int >> 4;
-	return res;
-}
-
-SmithWaterman::alignment_end* SmithWaterman::sw_sse2_byte (const int* db_sequence,
+SmithWatermanKernel::alignment_end* SmithWatermanKernel::sw_sse2_byte (const int* db_sequence,
 														   int8_t ref_dir,	// 0: forward ref; 1: reverse ref
 														   int32_t db_length,
 														   int32_t query_length,
@@ -516,7 +532,7 @@ SmithWaterman::alignment_end* SmithWaterman::sw_sse2_byte (const int* db_sequenc
 }
 
 
-SmithWaterman::alignment_end* SmithWaterman::sw_sse2_word (const int* db_sequence,
+SmithWatermanKernel::alignment_end* SmithWatermanKernel::sw_sse2_word (const int* db_sequence,
 														   int8_t ref_dir,	// 0: forward ref; 1: reverse ref
 														   int32_t db_length,
 														   int32_t query_lenght,
@@ -662,7 +678,7 @@ SmithWaterman::alignment_end* SmithWaterman::sw_sse2_word (const int* db_sequenc
 	}
 
 	/* Find the most possible 2nd best alignment. */
-	SmithWaterman::alignment_end* bests = (alignment_end*) calloc(2, sizeof(alignment_end));
+	SmithWatermanKernel::alignment_end* bests = (alignment_end*) calloc(2, sizeof(alignment_end));
 	bests[0].score = max;
 	bests[0].ref = end_ref;
 	bests[0].read = end_read;
@@ -690,7 +706,7 @@ SmithWaterman::alignment_end* SmithWaterman::sw_sse2_word (const int* db_sequenc
 #undef max8
 }
 
-void SmithWaterman::ssw_init (const Sequence* q,
+void SmithWatermanKernel::ssw_init (const Sequence* q,
 							  const int8_t* mat,
 							  const BaseMatrix *m,
 							  const int32_t alphabetSize,
@@ -785,7 +801,7 @@ void SmithWaterman::ssw_init (const Sequence* q,
 	profile->alphabetSize = alphabetSize;
 }
 template <const unsigned int type>
-SmithWaterman::cigar * SmithWaterman::banded_sw(const int *db_sequence, const int8_t *query_sequence, const int8_t * compositionBias,
+SmithWatermanKernel::cigar * SmithWatermanKernel::banded_sw(const int *db_sequence, const int8_t *query_sequence, const int8_t * compositionBias,
 												int32_t db_length, int32_t query_length, int32_t queryStart,
 												int32_t score, const uint32_t gap_open,
 												const uint32_t gap_extend, int32_t band_width, const int8_t *mat, int32_t n) {
@@ -990,7 +1006,7 @@ SmithWaterman::cigar * SmithWaterman::banded_sw(const int *db_sequence, const in
 #undef set_d
 }
 
-uint32_t SmithWaterman::to_cigar_int (uint32_t length, char op_letter)
+uint32_t SmithWatermanKernel::to_cigar_int (uint32_t length, char op_letter)
 {
 	uint32_t res;
 	uint8_t op_code;
@@ -1030,19 +1046,19 @@ uint32_t SmithWaterman::to_cigar_int (uint32_t length, char op_letter)
 	return res;
 }
 
-void SmithWaterman::printVector(__m128i v){
+void SmithWatermanKernel::printVector(__m128i v){
 	for (int i = 0; i < 8; i++)
 		printf("%d ", ((short) (sse2_extract_epi16(v, i)) + 32768));
 	std::cout << "\n";
 }
 
-void SmithWaterman::printVectorUS(__m128i v){
+void SmithWatermanKernel::printVectorUS(__m128i v){
 	for (int i = 0; i < 8; i++)
 		printf("%d ", (unsigned short) sse2_extract_epi16(v, i));
 	std::cout << "\n";
 }
 
-unsigned short SmithWaterman::sse2_extract_epi16(__m128i v, int pos) {
+unsigned short SmithWatermanKernel::sse2_extract_epi16(__m128i v, int pos) {
 	switch(pos){
 		case 0: return _mm_extract_epi16(v, 0);
 		case 1: return _mm_extract_epi16(v, 1);
@@ -1059,11 +1075,7 @@ unsigned short SmithWaterman::sse2_extract_epi16(__m128i v, int pos) {
 	return 0;
 }
 
-float SmithWaterman::computeCov(unsigned int startPos, unsigned int endPos, unsigned int len) {
-    return (std::min(len, endPos) - startPos + 1) / (float) len;
-}
-
-s_align SmithWaterman::scoreIdentical(int *dbSeq, int L, EvalueComputation * evaluer, int alignmentMode) {
+s_align SmithWatermanKernel::scoreIdentical(int *dbSeq, int L, EvalueComputation * evaluer, int alignmentMode) {
 	if(profile->query_length != L){
 		std::cerr << "scoreIdentical has different length L: "
 				  << L << " query_length: " << profile->query_length
@@ -1098,3 +1110,5 @@ s_align SmithWaterman::scoreIdentical(int *dbSeq, int L, EvalueComputation * eva
 
 	return r;
 }
+
+}
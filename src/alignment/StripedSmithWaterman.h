@@ -44,6 +44,7 @@
 #endif
 
 #include "simd.h"
+#include "SimdDispatch.h"
 #include "BaseMatrix.h"
 
 #include "Sequence.h"
@@ -74,17 +75,10 @@ typedef struct {
 
 class SmithWaterman{
 public:
+    // aligner for the best instruction set of the CPU, see SimdDispatch
+    static SmithWaterman *create(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection);
 
-    SmithWaterman(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection);
-    ~SmithWaterman();
-
-    // prints a __m128 vector containing 8 signed shorts
-    static void printVector (__m128i v);
-
-    // prints a __m128 vector containing 8 unsigned shorts, added 32768
-    static void printVectorUS (__m128i v);
-
-    static unsigned short sse2_extract_epi16(__m128i v, int pos);
+    virtual ~SmithWaterman() {}
 
     // The dynamic programming matrix entries for the query and database sequences are stored sequentially (the order see the Farrar paper).
     // This function calculates the index within the dynamic programming matrices for the given query and database sequence position.
@@ -134,7 +128,7 @@ public:
      while bit 8 is not, the function will return cigar only when both criteria are fulfilled. All returned positions are
      0-based coordinate.
      */
-    s_align  ssw_align (const int*db_sequence,
+    virtual s_align ssw_align (const int*db_sequence,
                         int32_t db_length,
                         const uint8_t gap_open,
                         const uint8_t gap_extend,
@@ -142,7 +136,7 @@ public:
                         const double filters,
                         EvalueComputation * filterd,
                         const int covMode, const float covThr,
-                        const int32_t maskLen);
+                        const int32_t maskLen) = 0;
 
     /*!	@function	Create the query profile using the query sequence.
      @param	read	pointer to the query sequence; the query sequence needs to be numbers
@@ -162,8 +156,8 @@ public:
      -2 -2 -2  2 //T
      mat is the pointer to the array {2, -2, -2, -2, -2, 2, -2, -2, -2, -2, 2, -2, -2, -2, -2, 2}
      */
-    void ssw_init(const Sequence *q, const int8_t *mat, const BaseMatrix *m, const int32_t alphabetSize,
-                  const int8_t score_size);
+    virtual void ssw_init(const Sequence *q, const int8_t *mat, const BaseMatrix *m, const int32_t alphabetSize,
+                          const int8_t score_size) = 0;
 
 
     static char cigar_int_to_op (uint32_t cigar_int);
@@ -173,7 +167,7 @@ public:
 
     static float computeCov(unsigned int startPos, unsigned int endPos, unsigned int len);
 
-    s_align scoreIdentical(int *dbSeq, int L, EvalueComputation * evaluer, int alignmentMode);
+    virtual s_align scoreIdentical(int *dbSeq, int L, EvalueComputation * evaluer, int alignmentMode) = 0;
 
     static void seq_reverse(int8_t * reverse, const int8_t* seq, int32_t end)	/* end is 0-based alignment ending position */
     {
@@ -185,7 +179,34 @@ public:
             --end;
         }
     }
+};
+
+SIMD_KERNEL_DECLARE(SmithWaterman *createSmithWaterman(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection))
+
+namespace SIMD_KERNEL_NAMESPACE {
+
+class SmithWatermanKernel : public ::SmithWaterman {
+public:
 
+    SmithWatermanKernel(size_t maxSequenceLength, int aaSize, bool aaBiasCorrection);
+    ~SmithWatermanKernel();
+
+    s_align ssw_align(const int *db_sequence, int32_t db_length, const uint8_t gap_open, const uint8_t gap_extend,
+                      const uint8_t alignmentMode, const double filters, EvalueComputation *filterd,
+                      const int covMode, const float covThr, const int32_t maskLen);
+
+    void ssw_init(const Sequence *q, const int8_t *mat, const BaseMatrix *m, const int32_t alphabetSize,
+                  const int8_t score_size);
+
+    s_align scoreIdentical(int *dbSeq, int L, EvalueComputation * evaluer, int alignmentMode);
+
+    // prints a __m128 vector containing 8 signed shorts
+    static void printVector (__m128i v);
+
+    // prints a __m128 vector containing 8 unsigned shorts, added 32768
+    static void printVectorUS (__m128i v);
+
+    static unsigned short sse2_extract_epi16(__m128i v, int pos);
 
 private:
 
@@ -268,7 +289,7 @@ private:
                                  int32_t maskLen);
 
     template <const unsigned int type>
-    SmithWaterman::cigar *banded_sw(const int *db_sequence, const int8_t *query_sequence, const int8_t * compositionBias, int32_t db_length, int32_t query_length, int32_t queryStart, int32_t score, const uint32_t gap_open, const uint32_t gap_extend, int32_t band_width, const int8_t *mat, int32_t n);
+    cigar *banded_sw(const int *db_sequence, const int8_t *query_sequence, const int8_t * compositionBias, int32_t db_length, int32_t query_length, int32_t queryStart, int32_t score, const uint32_t gap_open, const uint32_t gap_extend, int32_t band_width, const int8_t *mat, int32_t n);
 
     /*!	@function		Produce CIGAR 32-bit unsigned integer from CIGAR operation and CIGAR length
      @param	length		length of CIGAR
@@ -290,4 +311,7 @@ private:
     short * profile_word_linear_data;
     bool aaBiasCorrection;
 };
+
+}
+
 #endif /* SMITH_WATERMAN_SSE2_H */
@@ -8,6 +8,7 @@
 #include "Parameters.h"
 #include "Util.h"
 #include "Debug.h"
+#include "Matcher.h"
 
 #include <cmath>
 
@@ -23,6 +24,7 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
     const size_t dbSize = seqDbr->getSize();
     const size_t flushSize = 1000000;
     size_t iterations = static_cast<int>(ceil(static_cast<double>(dbSize)/static_cast<double>(flushSize)));
+    const bool binaryAlignment = (alnDbr->getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
     for(size_t it = 0; it < iterations; it++) {
         size_t start = it * flushSize;
         size_t bucketSize = std::min(dbSize - (it * flushSize), flushSize);
@@ -32,9 +34,11 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
             // seqDbr is descending sorted by length
             // the assumption is that clustering is B -> B (not A -> B)
             const unsigned int clusterId = seqDbr->getDbKey(i);
-            char *data = alnDbr->getDataByDBKey(clusterId);
+            const size_t alnId = alnDbr->getId(clusterId);
+            char *data = alnDbr->getData(alnId);
+            const char *dataEnd = data + alnDbr->getSeqLens(alnId) - 1;
 
-            if (*data == '\0') { // check if file contains entry
+            if (data == dataEnd) { // check if file contains entry
                 Debug(Debug::ERROR) << "ERROR: Sequence " << i
                                     << " does not contain any sequence for key " << clusterId
                                     << "!\n";
@@ -42,37 +46,32 @@ void AlignmentSymmetry::readInData(DBReader<unsigned int>*alnDbr, DBReader<unsig
             }
             size_t setSize = LEN(offsets, i);
             size_t writePos = 0;
-            while (*data != '\0') {
+            Matcher::ResultIterator it(data, alnDbr->getSeqLens(alnId), binaryAlignment);
+            for (; it.hasNext(); it.next()) {
                 if (writePos >= setSize) {
                     Debug(Debug::ERROR) << "ERROR: Set " << i
                                         << " has more elements than allocated (" << setSize
                                         << ")!\n";
                     continue;
                 }
-                char similarity[255 + 1];
-                char dbKey[255 + 1];
-                Util::parseKey(data, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+                const unsigned int key = it.getDbKey();
                 const size_t currElement = seqDbr->getId(key);
                 if (elementScoreTable != NULL) {
                     if (scoretype == Parameters::APC_ALIGNMENTSCORE) {
                         //column 1 = alignment score
-                        Util::parseByColumnNumber(data, similarity, 1);
-                        elementScoreTable[i][writePos] = (unsigned short) (atof(similarity));
+                        elementScoreTable[i][writePos] = (unsigned short) it.getScore();
                     } else {
                         //column 2 = sequence identity
-                        Util::parseByColumnNumber(data, similarity, 2);
-                        elementScoreTable[i][writePos] = (unsigned short) (atof(similarity) * 1000.0f);
+                        elementScoreTable[i][writePos] = (unsigned short) (it.getSeqId() * 1000.0f);
                     }
                 }
                 if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                    Debug(Debug::ERROR) << "ERROR: Element " << dbKey
+                    Debug(Debug::ERROR) << "ERROR: Element " << key
                                         << " contained in some alignment list, but not contained in the sequence database!\n";
                     EXIT(EXIT_FAILURE);
                 }
                 elementLookupTable[i][writePos] = currElement;
                 writePos++;
-                data = Util::skipLine(data);
             }
         }
         alnDbr->remapData();
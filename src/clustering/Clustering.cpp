@@ -16,11 +16,12 @@ Clustering::Clustering(const std::string &seqDB, const std::string &seqDBIndex,
                                                                outDBIndex(outDBIndex) {
     Debug(Debug::INFO) << "Init...\n";
     Debug(Debug::INFO) << "Opening sequence database...\n";
-    seqDbr = new DBReader<unsigned int>(seqDB.c_str(), seqDBIndex.c_str(), DBReader<unsigned int>::USE_INDEX);
+    seqDbr = new DBReader<unsigned int>(seqDB.c_str(), seqDBIndex.c_str(), DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_KEY_LOOKUP);
     seqDbr->open(DBReader<unsigned int>::SORT_BY_LENGTH);
 
     Debug(Debug::INFO) << "Opening alignment database...\n";
-    alnDbr = new DBReader<unsigned int>(alnDB.c_str(), alnDBIndex.c_str());
+    alnDbr = new DBReader<unsigned int>(alnDB.c_str(), alnDBIndex.c_str(),
+                                        DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_KEY_LOOKUP);
     alnDbr->open(DBReader<unsigned int>::NOSORT);
 
     Debug(Debug::INFO) << "done.\n";
@@ -3,6 +3,7 @@
 #include "Debug.h"
 #include "AlignmentSymmetry.h"
 #include "Timer.h"
+#include "Matcher.h"
 
 #include <queue>
 #include <algorithm>
@@ -17,6 +18,7 @@ ClusteringAlgorithms::ClusteringAlgorithms(DBReader<unsigned int>* seqDbr, DBRea
         EXIT(EXIT_FAILURE);
     }
     this->alnDbr=alnDbr;
+    this->binaryAlignment = (alnDbr->getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
     this->dbSize=alnDbr->getSize();
     this->threads=threads;
     this->scoretype=scoretype;
@@ -43,7 +45,19 @@ std::unordered_map<unsigned int, std::vector<unsigned int>>  ClusteringAlgorithm
     if (mode==4) {
         greedyIncrementalLowMem(assignedcluster);
     }else {
-        const size_t elementCount = Util::countLines(data, dataSize);
+        size_t elementCount = 0;
+        if (binaryAlignment) {
+            for (size_t i = 0; i < alnDbr->getSize(); i++) {
+                elementCount += Matcher::countBinaryAlignmentResults(alnDbr->getData(i), alnDbr->getSeqLens(i));
+            }
+        } else if (alnDbr->isCompressed()) {
+            for (size_t i = 0; i < alnDbr->getSize(); i++) {
+                const size_t length = alnDbr->getSeqLens(i);
+                elementCount += Util::countLines(alnDbr->getData(i), length == 0 ? 0 : length - 1);
+            }
+        } else {
+            elementCount = Util::countLines(data, dataSize);
+        }
         unsigned int * elements = new(std::nothrow) unsigned int[elementCount];
         Util::checkAllocation(elements, "Could not allocate elements memory in ClusteringAlgorithms::execute");
         unsigned int ** elementLookupTable = new(std::nothrow) unsigned int*[dbSize];
@@ -281,12 +295,9 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
 
 
         const size_t alnId = alnDbr->getId(clusterKey);
-        char *data = alnDbr->getData(alnId);
-
-        while (*data != '\0') {
-            char dbKey[255 + 1];
-            Util::parseKey(data, dbKey);
-            const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+        Matcher::ResultIterator it(alnDbr->getData(alnId), alnDbr->getSeqLens(alnId), binaryAlignment);
+        for (; it.hasNext(); it.next()) {
+            const unsigned int key = it.getDbKey();
             unsigned int currElement = seqDbr->getId(key);
             unsigned int targetId;
 
@@ -296,11 +307,10 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
             } while (!__atomic_compare_exchange(&assignedcluster[currElement],  &targetId,  &clusterId , false,  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 
             if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                Debug(Debug::ERROR) << "ERROR: Element " << dbKey
+                Debug(Debug::ERROR) << "ERROR: Element " << key
                                     << " contained in some alignment list, but not contained in the sequence database!\n";
                 EXIT(EXIT_FAILURE);
             }
-            data = Util::skipLine(data);
         }
     }
 
@@ -310,12 +320,9 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
         unsigned int clusterId = id;
 
         const size_t alnId = alnDbr->getId(clusterKey);
-        char *data = alnDbr->getData(alnId);
-
-        while (*data != '\0') {
-            char dbKey[255 + 1];
-            Util::parseKey(data, dbKey);
-            const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+        Matcher::ResultIterator it(alnDbr->getData(alnId), alnDbr->getSeqLens(alnId), binaryAlignment);
+        for (; it.hasNext(); it.next()) {
+            const unsigned int key = it.getDbKey();
             unsigned int currElement = seqDbr->getId(key);
             unsigned int targetId;
 
@@ -325,11 +332,10 @@ void ClusteringAlgorithms::greedyIncrementalLowMem( unsigned int *assignedcluste
             } while (!__atomic_compare_exchange(&assignedcluster[currElement],  &targetId,  &clusterId , false,  __ATOMIC_RELAXED, __ATOMIC_RELAXED));
 
             if (currElement == UINT_MAX || currElement > seqDbr->getSize()) {
-                Debug(Debug::ERROR) << "ERROR: Element " << dbKey
+                Debug(Debug::ERROR) << "ERROR: Element " << key
                                     << " contained in some alignment list, but not contained in the sequence database!\n";
                 EXIT(EXIT_FAILURE);
             }
-            data = Util::skipLine(data);
         }
     }
 
@@ -374,7 +380,8 @@ void ClusteringAlgorithms::readInClusterData(unsigned int **elementLookupTable,
         const size_t alnId = alnDbr->getId(clusterId);
         const char *data = alnDbr->getData(alnId);
         const size_t dataSize = alnDbr->getSeqLens(alnId);
-        elementOffsets[i] = Util::countLines(data, dataSize);
+        elementOffsets[i] = binaryAlignment ? Matcher::countBinaryAlignmentResults(data, dataSize)
+                                            : Util::countLines(data, dataSize);
     }
 
     // make offset table
@@ -22,7 +22,8 @@ private:
     DBReader<unsigned int>* seqDbr;
 
     DBReader<unsigned int>* alnDbr;
-
+    // alignment results stored as binary records instead of text lines
+    bool binaryAlignment;
 
     int threads;
     int scoretype;
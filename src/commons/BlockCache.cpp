@@ -0,0 +1,122 @@
+#include "BlockCache.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+const size_t BlockCache::BLOCK_SIZE;
+
+// reads of more blocks than this bypass the cache instead of evicting it
+static const size_t MAX_CACHED_BLOCKS_PER_READ = 4;
+
+BlockCache::BlockCache(int fd, size_t fileSize, size_t capacity) : fd(fd), fileSize(fileSize) {
+    const size_t slotCount = std::max(capacity / BLOCK_SIZE / STRIPES, (size_t) 1);
+    for (size_t i = 0; i < STRIPES; i++) {
+        pthread_mutex_init(&stripes[i].mutex, NULL);
+        stripes[i].slotCount = slotCount;
+        stripes[i].hand = 0;
+        stripes[i].slots = new Slot[slotCount];
+        for (size_t j = 0; j < slotCount; j++) {
+            stripes[i].slots[j].block = SIZE_MAX;
+            stripes[i].slots[j].referenced = false;
+            stripes[i].slots[j].data = NULL;
+        }
+    }
+}
+
+BlockCache::~BlockCache() {
+    for (size_t i = 0; i < STRIPES; i++) {
+        for (size_t j = 0; j < stripes[i].slotCount; j++) {
+            free(stripes[i].slots[j].data);
+        }
+        delete[] stripes[i].slots;
+        pthread_mutex_destroy(&stripes[i].mutex);
+    }
+}
+
+bool BlockCache::preadFully(int fd, char *buffer, size_t length, size_t offset) {
+    while (length > 0) {
+        ssize_t result = pread(fd, buffer, length, offset);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        buffer += result;
+        length -= result;
+        offset += result;
+    }
+    return true;
+}
+
+bool BlockCache::read(char *buffer, size_t length, size_t offset) {
+    if (length == 0) {
+        return true;
+    }
+    const size_t first = offset / BLOCK_SIZE;
+    const size_t last = (offset + length - 1) / BLOCK_SIZE;
+    if (last - first + 1 > MAX_CACHED_BLOCKS_PER_READ) {
+        return preadFully(fd, buffer, length, offset);
+    }
+    for (size_t block = first; block <= last; block++) {
+        const size_t blockStart = block * BLOCK_SIZE;
+        const size_t from = std::max(offset, blockStart) - blockStart;
+        const size_t to = std::min(offset + length, blockStart + BLOCK_SIZE) - blockStart;
+        if (readBlock(block, buffer, from, to - from) == false) {
+            return false;
+        }
+        buffer += to - from;
+    }
+    return true;
+}
+
+bool BlockCache::readBlock(size_t block, char *buffer, size_t from, size_t length) {
+    Stripe &stripe = stripes[block % STRIPES];
+    pthread_mutex_lock(&stripe.mutex);
+    std::unordered_map<size_t, size_t>::const_iterator it = stripe.lookup.find(block);
+    if (it != stripe.lookup.end()) {
+        Slot &slot = stripe.slots[it->second];
+        slot.referenced = true;
+        memcpy(buffer, slot.data + from, length);
+        pthread_mutex_unlock(&stripe.mutex);
+        return true;
+    }
+    pthread_mutex_unlock(&stripe.mutex);
+
+    // read without holding the lock, other threads keep using the stripe meanwhile
+    const size_t blockStart = block * BLOCK_SIZE;
+    const size_t blockLength = std::min(BLOCK_SIZE, fileSize - blockStart);
+    char *data = (char *) malloc(BLOCK_SIZE);
+    Util::checkAllocation(data, "Could not allocate block cache memory");
+    if (preadFully(fd, data, blockLength, blockStart) == false) {
+        free(data);
+        return false;
+    }
+    memcpy(buffer, data + from, length);
+
+    pthread_mutex_lock(&stripe.mutex);
+    // another thread may have inserted the same block while we were reading
+    if (stripe.lookup.find(block) == stripe.lookup.end()) {
+        while (stripe.slots[stripe.hand].referenced) {
+            stripe.slots[stripe.hand].referenced = false;
+            stripe.hand = (stripe.hand + 1) % stripe.slotCount;
+        }
+        Slot &slot = stripe.slots[stripe.hand];
+        if (slot.block != SIZE_MAX) {
+            stripe.lookup.erase(slot.block);
+        }
+        std::swap(slot.data, data);
+        slot.block = block;
+        slot.referenced = true;
+        stripe.lookup[block] = stripe.hand;
+        stripe.hand = (stripe.hand + 1) % stripe.slotCount;
+    }
+    pthread_mutex_unlock(&stripe.mutex);
+    free(data);
+    return true;
+}
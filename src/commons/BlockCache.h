@@ -0,0 +1,52 @@
+#ifndef MMSEQS_BLOCKCACHE_H
+#define MMSEQS_BLOCKCACHE_H
+
+// Fixed size cache of file blocks for readers that pread instead of mapping
+// (--db-load-mode 3). Blocks are kept until their slot is reused, slots are
+// replaced with the clock algorithm. Memory is allocated per slot on first use,
+// so the cache never holds more than capacity bytes.
+
+#include <cstddef>
+#include <pthread.h>
+#include <unordered_map>
+
+class BlockCache {
+public:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    BlockCache(int fd, size_t fileSize, size_t capacity);
+
+    ~BlockCache();
+
+    // copies length bytes starting at offset into buffer
+    // reads that span many blocks go to the file directly
+    bool read(char *buffer, size_t length, size_t offset);
+
+private:
+    struct Slot {
+        size_t block;
+        bool referenced;
+        char *data;
+    };
+
+    // blocks are spread over stripes so that threads rarely wait for each other
+    struct Stripe {
+        pthread_mutex_t mutex;
+        Slot *slots;
+        size_t slotCount;
+        size_t hand;
+        std::unordered_map<size_t, size_t> lookup;
+    };
+
+    static const size_t STRIPES = 16;
+
+    int fd;
+    size_t fileSize;
+    Stripe stripes[STRIPES];
+
+    bool readBlock(size_t block, char *buffer, size_t from, size_t length);
+
+    static bool preadFully(int fd, char *buffer, size_t length, size_t offset);
+};
+
+#endif
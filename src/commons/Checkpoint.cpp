@@ -0,0 +1,136 @@
+#include "Checkpoint.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "FileUtil.h"
+#include "Util.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// first line of the manifest, followed by one "<chunk>\t<hasResult>" line per finished chunk
+static const char JOB_PREFIX[] = "job\t";
+
+Checkpoint::Checkpoint(const std::string &outDB, const std::string &job) : fileName(outDB + ".checkpoint") {
+    if (outDB == DBWriter::STREAM_STDOUT) {
+        Debug(Debug::ERROR) << "Results computed in chunks can not be written to " << DBWriter::STREAM_STDOUT
+                            << ". Write them to a database instead.\n";
+        EXIT(EXIT_FAILURE);
+    }
+    const std::string header = JOB_PREFIX + job + "\n";
+    bool resume = false;
+    if (FileUtil::fileExists(fileName.c_str())) {
+        FILE *in = FileUtil::openFileOrDie(fileName.c_str(), "r", true);
+        // the job names the databases, so lines can be of any length
+        char *line = NULL;
+        size_t capacity = 0;
+        ssize_t length = getline(&line, &capacity, in);
+        if (length != -1 && header == line) {
+            resume = true;
+            while ((length = getline(&line, &capacity, in)) != -1) {
+                // a line torn by the interruption has no newline and is ignored
+                if (length == 0 || line[length - 1] != '\n') {
+                    break;
+                }
+                char *rest;
+                size_t chunk = strtoull(line, &rest, 10);
+                if (rest == line || *rest != '\t') {
+                    break;
+                }
+                done[chunk] = (rest[1] == '1');
+            }
+        } else {
+            Debug(Debug::WARNING) << "Checkpoint " << fileName << " belongs to a different run. Starting from scratch.\n";
+        }
+        free(line);
+        fclose(in);
+    }
+
+    if (resume) {
+        Debug(Debug::INFO) << "Resuming from checkpoint " << fileName << " with " << done.size() << " finished chunks\n";
+        file = FileUtil::openFileOrDie(fileName.c_str(), "a", true);
+    } else {
+        file = FileUtil::openFileOrDie(fileName.c_str(), "w", false);
+        if (fwrite(header.c_str(), sizeof(char), header.size(), file) != header.size() || fflush(file) != 0) {
+            Debug(Debug::ERROR) << "Could not write checkpoint " << fileName << "!\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+}
+
+Checkpoint::~Checkpoint() {
+    if (file != NULL) {
+        fclose(file);
+    }
+}
+
+bool Checkpoint::isDone(size_t chunk, const std::pair<std::string, std::string> &files, bool *hasResult) const {
+    std::map<size_t, bool>::const_iterator it = done.find(chunk);
+    if (it == done.end()) {
+        return false;
+    }
+    // the merge of an earlier run might have removed the chunk already
+    if (it->second == true && (FileUtil::fileExists(files.first.c_str()) == false
+                               || FileUtil::fileExists(files.second.c_str()) == false)) {
+        return false;
+    }
+    *hasResult = it->second;
+    return true;
+}
+
+void Checkpoint::commit(size_t chunk, bool hasResult, const std::pair<std::string, std::string> &files) {
+    if (hasResult) {
+        syncFile(files.first);
+        syncFile(files.second);
+    }
+    std::string line = SSTR(chunk) + "\t" + (hasResult ? "1" : "0") + "\n";
+    if (fwrite(line.c_str(), sizeof(char), line.size(), file) != line.size()
+        || fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        Debug(Debug::ERROR) << "Could not write checkpoint " << fileName << "!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    done[chunk] = hasResult;
+}
+
+void Checkpoint::finish() {
+    fclose(file);
+    file = NULL;
+    FileUtil::deleteFile(fileName);
+}
+
+std::string Checkpoint::describeParameters(const Parameters &par, const std::vector<MMseqsParameter> &parameters) {
+    std::vector<MMseqsParameter> resultParameters;
+    for (size_t i = 0; i < parameters.size(); i++) {
+        const int id = parameters[i].uniqid;
+        if (id == par.PARAM_THREADS.uniqid || id == par.PARAM_V.uniqid || id == par.PARAM_DB_LOAD_MODE.uniqid) {
+            continue;
+        }
+        resultParameters.push_back(parameters[i]);
+    }
+    return par.createParameterString(resultParameters);
+}
+
+std::string Checkpoint::describeDatabase(const std::string &indexFileName) {
+    struct stat sb;
+    if (stat(indexFileName.c_str(), &sb) != 0) {
+        memset(&sb, 0, sizeof(sb));
+    }
+    return indexFileName + " " + SSTR(sb.st_size) + " " + SSTR(sb.st_mtime) + "."
+           + SSTR(DBReader<unsigned int>::getMtimeNsec(sb));
+}
+
+void Checkpoint::syncFile(const std::string &name) {
+    // sharded results have no data file of their own
+    if (FileUtil::fileExists(name.c_str()) == false) {
+        return;
+    }
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd == -1 || fsync(fd) != 0) {
+        Debug(Debug::ERROR) << "Could not sync " << name << "!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    close(fd);
+}
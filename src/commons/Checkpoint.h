@@ -0,0 +1,47 @@
+#ifndef MMSEQS_CHECKPOINT_H
+#define MMSEQS_CHECKPOINT_H
+
+// Manifest of the finished chunks of a result database, so an interrupted run
+// can continue with the first unfinished chunk. The manifest is written to
+// <outDB>.checkpoint, a chunk is appended only after its files are closed and synced.
+
+#include "Parameters.h"
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Checkpoint {
+public:
+    // job describes the run, a manifest of a different job is discarded
+    Checkpoint(const std::string &outDB, const std::string &job);
+
+    ~Checkpoint();
+
+    // chunk was finished by an earlier run and its files still exist
+    // hasResult is false if the chunk did not write any files
+    bool isDone(size_t chunk, const std::pair<std::string, std::string> &files, bool *hasResult) const;
+
+    void commit(size_t chunk, bool hasResult, const std::pair<std::string, std::string> &files);
+
+    // all chunks are merged into the result, removes the manifest
+    void finish();
+
+    // settings of a job, without the ones that do not change the results
+    static std::string describeParameters(const Parameters &par, const std::vector<MMseqsParameter> &parameters);
+
+    // path, size and modification time of a database index, a rewritten database starts the job from scratch
+    static std::string describeDatabase(const std::string &indexFileName);
+
+private:
+    std::string fileName;
+    FILE *file;
+    // chunk to hasResult
+    std::map<size_t, bool> done;
+
+    static void syncFile(const std::string &name);
+};
+
+#endif
@@ -36,6 +36,8 @@ public:
     bool HW_FMA3 = false;
     bool HW_FMA4 = false;
     bool HW_AVX2 = false;
+    bool HW_OS_AVX = false;     //  OS saves the AVX registers on context switches
+    bool HW_OS_AVX512 = false;  //  OS saves the AVX-512 opmask and ZMM registers on context switches
 
 //  SIMD: 512-bit
     bool HW_AVX512F = false;    //  AVX512 Foundation
@@ -73,6 +75,16 @@ public:
             HW_FMA3   = (info[2] & ((int)1 << 12)) != 0;
 
             HW_RDRAND = (info[2] & ((int)1 << 30)) != 0;
+
+            bool osxsave = (info[2] & ((int)1 << 27)) != 0;
+            if (osxsave) {
+                // XCR0 has to enable the SSE and AVX state
+                unsigned int eax, edx;
+                __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+                HW_OS_AVX = (eax & 0x6) == 0x6;
+                // opmask, upper ZMM0-15 and ZMM16-31 state
+                HW_OS_AVX512 = (eax & 0xE6) == 0xE6;
+            }
         }
         if (nIds >= 0x00000007){
             cpuid(info,0x00000007);
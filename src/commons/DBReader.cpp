@@ -10,8 +10,19 @@
 
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <omptl/omptl_algorithm>
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+#include "BlockCache.h"
 #include "MemoryMapped.h"
 #include "Debug.h"
 #include "Util.h"
@@ -22,7 +33,11 @@ DBReader<T>::DBReader(const char* dataFileName_, const char* indexFileName_, int
         data(NULL), dataMode(dataMode), dataFileName(strdup(dataFileName_)),
         indexFileName(strdup(indexFileName_)), size(0), dataSize(0), aaDbSize(0), lastKey(T()), closed(1), dbtype(-1),
         index(NULL), seqLens(NULL), id2local(NULL), local2id(NULL),
-        dataMapped(false), accessType(0), externalData(false), didMlock(false)
+        dataMapped(false), accessType(0), externalData(false), didMlock(false),
+        indexMapped(false), indexMap(NULL), indexMapSize(0),
+        compressed(false), decompressThreads(0), decompressBuffers(NULL), decompressBufferSizes(NULL),
+        loadMode(defaultLoadMode), dataFd(-1), readThreads(0), readBuffers(NULL), readBufferSizes(NULL), blockCache(NULL),
+        keyLookup(NULL), keyLookupSize(0), keyLookupOffset(0), keyHash(NULL), keyHashMask(0)
 {}
 
 template <typename T>
@@ -30,9 +45,36 @@ DBReader<T>::DBReader(DBReader<T>::Index *index, unsigned int *seqLens, size_t s
         data(NULL), dataMode(USE_INDEX), dataFileName(NULL), indexFileName(NULL),
         size(size), dataSize(0), aaDbSize(aaDbSize), lastKey(lastKey), closed(1), dbtype(-1),
         index(index), seqLens(seqLens), id2local(NULL), local2id(NULL),
-        dataMapped(false), accessType(NOSORT), externalData(true), didMlock(false)
+        dataMapped(false), accessType(NOSORT), externalData(true), didMlock(false),
+        indexMapped(false), indexMap(NULL), indexMapSize(0),
+        compressed(false), decompressThreads(0), decompressBuffers(NULL), decompressBufferSizes(NULL),
+        loadMode(LOAD_MODE_MMAP), dataFd(-1), readThreads(0), readBuffers(NULL), readBufferSizes(NULL), blockCache(NULL),
+        keyLookup(NULL), keyLookupSize(0), keyLookupOffset(0), keyHash(NULL), keyHashMask(0)
 {}
 
+template <typename T>
+int DBReader<T>::defaultLoadMode = DBReader<T>::LOAD_MODE_MMAP;
+
+template <typename T>
+const char DBReader<T>::BINARY_INDEX_MAGIC[8] = {'M', 'M', 'S', 'I', 'D', 'X', '2', '\0'};
+
+template <typename T>
+const char DBReader<T>::COMPRESSED_DATA_MAGIC[8] = {'\xFF', 'M', 'M', 'S', 'Z', 'I', 'P', '\x01'};
+
+template <typename T>
+const char DBReader<T>::SHARDED_DATA_MAGIC[8] = {'\xFF', 'M', 'M', 'S', 'H', 'R', 'D', '\x01'};
+
+template <typename T>
+const char DBReader<T>::STREAM_STDIN[] = "stdin";
+
+template <typename T>
+const char DBReader<T>::STREAM_MAGIC[8] = {'\xFF', 'M', 'M', 'S', 'T', 'R', 'M', '\x01'};
+
+template <typename T>
+bool DBReader<T>::isStream(const char *dataFileName) {
+    return dataFileName != NULL && strcmp(dataFileName, STREAM_STDIN) == 0;
+}
+
 template <typename T>
 void DBReader<T>::setDataFile(const char* dataFileName_)  {
     if (dataFileName != NULL) {
@@ -45,16 +87,43 @@ void DBReader<T>::setDataFile(const char* dataFileName_)  {
 }
 
 
+// reads exactly length bytes, pread may return less than requested
+static bool preadFully(int fd, char *buffer, size_t length, size_t offset) {
+    while (length > 0) {
+        ssize_t result = pread(fd, buffer, length, offset);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        buffer += result;
+        length -= result;
+        offset += result;
+    }
+    return true;
+}
+
+static const size_t LOAD_CHUNK_SIZE = 64 * 1024 * 1024;
+
 template <typename T>
 void DBReader<T>::readMmapedDataInMemory(){
-    if ((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0) {
-        magicBytes = Util::touchMemory(data, dataSize);
+    if ((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0 && data != NULL) {
+        // page faults of a single thread cannot saturate fast storage, touch the chunks in parallel
+        const size_t chunks = (dataSize + LOAD_CHUNK_SIZE - 1) / LOAD_CHUNK_SIZE;
+        char bytes = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(^:bytes)
+        for (size_t i = 0; i < chunks; i++) {
+            size_t offset = i * LOAD_CHUNK_SIZE;
+            bytes ^= Util::touchMemory(data + offset, std::min(LOAD_CHUNK_SIZE, dataSize - offset));
+        }
+        magicBytes = bytes;
     }
 }
 
 template <typename T>
 void DBReader<T>::mlock(){
-    if (dataMode & USE_DATA) {
+    if ((dataMode & USE_DATA) && data != NULL) {
         if (didMlock == false) {
             ::mlock(data, dataSize);
             didMlock = true;
@@ -82,40 +151,130 @@ template <typename T> bool DBReader<T>::open(int accessType){
     // count the number of entries
     this->accessType = accessType;
     bool isSortedById = false;
-    if (dataMode & USE_DATA) {
+    const bool streamed = (dataMode & USE_DATA) && isStream(dataFileName);
+    if (streamed) {
+        // the stream can only be consumed once, it is kept in memory like USE_FREAD data
+        dataMode |= USE_FREAD;
+        dataMode &= ~USE_WRITABLE;
+        loadMode = LOAD_MODE_MMAP;
+        isSortedById = readStream(stdin);
+        dataMapped = true;
+    } else if (dataMode & USE_DATA) {
         FILE* dataFile = fopen(dataFileName, "r");
         dbtype = parseDbType(dataFileName);
         if (dataFile == NULL) {
             Debug(Debug::ERROR) << "Could not open data file " << dataFileName << "!\n";
             EXIT(EXIT_FAILURE);
         }
-        data = mmapData(dataFile, &dataSize);
+        if (dataMode & USE_WRITABLE) {
+            loadMode = LOAD_MODE_MMAP;
+        } else if (dataMode & USE_FREAD) {
+            // the data is read in completely anyway, only the memory it is read into can change
+            loadMode = (loadMode == LOAD_MODE_HUGEPAGES) ? LOAD_MODE_HUGEPAGES : LOAD_MODE_MMAP;
+        }
+        if (loadMode == LOAD_MODE_HUGEPAGES) {
+            dataMode |= USE_FREAD;
+        }
+
+        char magic[sizeof(COMPRESSED_DATA_MAGIC)];
+        bool hasMagic = pread(fileno(dataFile), magic, sizeof(magic), 0) == (ssize_t) sizeof(magic);
+        if (loadMode == LOAD_MODE_PREAD && hasMagic && memcmp(magic, SHARDED_DATA_MAGIC, sizeof(magic)) == 0) {
+            // shards are only supported through the mapping
+            Debug(Debug::WARNING) << dataFileName << " is sharded, --db-load-mode 3 is not supported for it. Mapping it instead.\n";
+            loadMode = LOAD_MODE_MMAP;
+        }
+
+        if (loadMode == LOAD_MODE_PREAD) {
+            struct stat sb;
+            dataFd = dup(fileno(dataFile));
+            if (dataFd < 0 || fstat(dataFd, &sb) < 0) {
+                Debug(Debug::ERROR) << "Failed to open data file " << dataFileName << ". Error " << errno << ".\n";
+                EXIT(EXIT_FAILURE);
+            }
+            dataSize = sb.st_size;
+#if defined(POSIX_FADV_RANDOM)
+            // entries are requested in arbitrary order, read ahead would only fill the page cache
+            posix_fadvise(dataFd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+            data = NULL;
+            compressed = hasMagic && memcmp(magic, COMPRESSED_DATA_MAGIC, sizeof(magic)) == 0;
+
+            readThreads = 1;
+#ifdef OPENMP
+            readThreads = omp_get_max_threads();
+#endif
+            readBuffers = new char*[readThreads];
+            readBufferSizes = new size_t[readThreads];
+            for (int i = 0; i < readThreads; i++) {
+                readBufferSizes[i] = 1024;
+                readBuffers[i] = (char *) malloc(readBufferSizes[i]);
+                Util::checkAllocation(readBuffers[i], "Could not allocate read buffer");
+            }
+            blockCache = new BlockCache(dataFd, dataSize, PREAD_CACHE_SIZE);
+        } else {
+            data = mmapData(dataFile, &dataSize);
+            dataMapped = true;
+            compressed = dataSize >= sizeof(COMPRESSED_DATA_MAGIC)
+                         && memcmp(data, COMPRESSED_DATA_MAGIC, sizeof(COMPRESSED_DATA_MAGIC)) == 0;
+        }
         fclose(dataFile);
-        dataMapped = true;
+
+        if (loadMode == LOAD_MODE_MMAP_TOUCH) {
+            readMmapedDataInMemory();
+        }
+        if (compressed == true) {
+#ifndef HAVE_ZLIB
+            Debug(Debug::ERROR) << "Data file " << dataFileName << " is compressed, but MMseqs2 was compiled without zlib support!\n";
+            EXIT(EXIT_FAILURE);
+#endif
+            decompressThreads = 1;
+#ifdef OPENMP
+            decompressThreads = omp_get_max_threads();
+#endif
+            decompressBuffers = new char*[decompressThreads];
+            decompressBufferSizes = new size_t[decompressThreads];
+            for (int i = 0; i < decompressThreads; i++) {
+                decompressBufferSizes[i] = 1024;
+                decompressBuffers[i] = (char *) malloc(decompressBufferSizes[i]);
+                Util::checkAllocation(decompressBuffers[i], "Could not allocate decompression buffer");
+            }
+        }
     }
 
     if (externalData == false) {
-        if(FileUtil::fileExists(indexFileName)==false){
-            Debug(Debug::ERROR) << "Could not open index file " << indexFileName << "!\n";
-            EXIT(EXIT_FAILURE);
+        if (streamed == false) {
+            if (FileUtil::fileExists(indexFileName) == false) {
+                Debug(Debug::ERROR) << "Could not open index file " << indexFileName << "!\n";
+                EXIT(EXIT_FAILURE);
+            }
+            if (readBinaryIndex(indexFileName) == true) {
+                isSortedById = true;
+            } else {
+                size = FileUtil::countLines(indexFileName);
+                index = new Index[this->size];
+                seqLens = new unsigned int[size];
+                isSortedById = readIndex(indexFileName, index, seqLens);
+            }
         }
-        size = FileUtil::countLines(indexFileName);
-        index = new Index[this->size];
-        seqLens = new unsigned int[size];
 
-        isSortedById = readIndex(indexFileName, index, seqLens);
         if (accessType != HARDNOSORT) {
             sortIndex(isSortedById);
         }
 
-        // init seq lens array and dbKey mapping
-        aaDbSize = 0;
-        for (size_t i = 0; i < size; i++){
-            unsigned int size = seqLens[i];
-            aaDbSize += size;
+        // the binary index header already holds the residue count
+        if (indexMapped == false) {
+            aaDbSize = 0;
+            for (size_t i = 0; i < size; i++){
+                unsigned int size = seqLens[i];
+                aaDbSize += size;
+            }
         }
     }
 
+    if ((dataMode & USE_KEY_LOOKUP) && accessType != HARDNOSORT) {
+        buildKeyLookup();
+    }
+
     closed = 0;
     return isSortedById;
 }
@@ -124,6 +283,62 @@ template<typename T>
 void DBReader<T>::sortIndex(bool isSortedById) {
 }
 
+static inline unsigned int hashKey(unsigned int key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6b;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35;
+    key ^= key >> 16;
+    return key;
+}
+
+template<typename T>
+void DBReader<T>::buildKeyLookup() {
+}
+
+template<>
+void DBReader<unsigned int>::buildKeyLookup() {
+    if (size == 0) {
+        return;
+    }
+    const bool useLocalIds = (accessType == SORT_BY_LENGTH || accessType == LINEAR_ACCCESS
+                              || accessType == SORT_BY_LINE || accessType == SHUFFLE);
+    // the index is sorted by key here
+    const unsigned int minKey = index[0].id;
+    const size_t range = static_cast<size_t>(index[size - 1].id) - minKey + 1;
+    if (range <= 2 * size) {
+        keyLookupOffset = minKey;
+        keyLookupSize = range;
+        keyLookup = new unsigned int[range];
+        std::fill_n(keyLookup, range, UINT_MAX);
+        // backwards so that the first of duplicated keys wins, same as the binary search
+        for (size_t i = size; i > 0; i--) {
+            keyLookup[index[i - 1].id - minKey] = useLocalIds ? id2local[i - 1] : (i - 1);
+        }
+    } else {
+        size_t capacity = 2;
+        while (capacity < size + size / 2) {
+            capacity <<= 1;
+        }
+        keyHashMask = capacity - 1;
+        keyHash = new KeyLookupEntry[capacity];
+        for (size_t i = 0; i < capacity; i++) {
+            keyHash[i].id = UINT_MAX;
+        }
+        for (size_t i = 0; i < size; i++) {
+            const unsigned int key = index[i].id;
+            size_t pos = hashKey(key) & keyHashMask;
+            while (keyHash[pos].id != UINT_MAX && keyHash[pos].key != key) {
+                pos = (pos + 1) & keyHashMask;
+            }
+            if (keyHash[pos].id == UINT_MAX) {
+                keyHash[pos].key = key;
+                keyHash[pos].id = useLocalIds ? id2local[i] : i;
+            }
+        }
+    }
+}
+
 template<>
 void DBReader<std::string>::sortIndex(bool isSortedById) {
     if (accessType == SORT_BY_ID){
@@ -278,6 +493,13 @@ template <typename T> char* DBReader<T>::mmapData(FILE * file, size_t *dataSize)
     int fd =  fileno(file);
     int mode;
 
+    char magic[sizeof(SHARDED_DATA_MAGIC)];
+    if (*dataSize >= sizeof(SHARDED_DATA_MAGIC)
+        && pread(fd, magic, sizeof(magic), 0) == (ssize_t) sizeof(magic)
+        && memcmp(magic, SHARDED_DATA_MAGIC, sizeof(magic)) == 0) {
+        return mmapShards(file, sb.st_size, dataSize);
+    }
+
     char *ret;
     if ((dataMode & USE_FREAD) == 0) {
         if(dataMode & USE_WRITABLE) {
@@ -291,6 +513,8 @@ template <typename T> char* DBReader<T>::mmapData(FILE * file, size_t *dataSize)
             Debug(Debug::ERROR) << "Failed to mmap memory dataSize=" << *dataSize <<" File=" << dataFileName << ". Error " << errsv << ".\n";
             EXIT(EXIT_FAILURE);
         }
+    } else if (loadMode == LOAD_MODE_HUGEPAGES) {
+        ret = readIntoHugePages(fd, *dataSize);
     } else {
         ret = static_cast<char*>(malloc(*dataSize));
         Util::checkAllocation(ret, "Not enough system memory to read in the whole data file.");
@@ -303,8 +527,215 @@ template <typename T> char* DBReader<T>::mmapData(FILE * file, size_t *dataSize)
     return ret;
 }
 
+template <typename T> char* DBReader<T>::readIntoHugePages(int fd, size_t dataSize) {
+    const size_t hugePageSize = 2 * 1024 * 1024;
+    size_t allocSize = std::max(hugePageSize, ((dataSize + hugePageSize - 1) / hugePageSize) * hugePageSize);
+    void *memory = NULL;
+    if (posix_memalign(&memory, hugePageSize, allocSize) != 0) {
+        Debug(Debug::ERROR) << "Not enough system memory to read in the whole data file.\n";
+        EXIT(EXIT_FAILURE);
+    }
+#ifdef MADV_HUGEPAGE
+    // only a hint, without transparent hugepage support the memory is backed by normal pages
+    madvise(memory, allocSize, MADV_HUGEPAGE);
+#endif
+    char *ret = static_cast<char*>(memory);
+
+    const size_t chunks = (dataSize + LOAD_CHUNK_SIZE - 1) / LOAD_CHUNK_SIZE;
+    int failed = 0;
+#pragma omp parallel for schedule(dynamic, 1) reduction(|:failed)
+    for (size_t i = 0; i < chunks; i++) {
+        size_t offset = i * LOAD_CHUNK_SIZE;
+        failed |= (preadFully(fd, ret + offset, std::min(LOAD_CHUNK_SIZE, dataSize - offset), offset) == false);
+    }
+    if (failed) {
+        Debug(Debug::ERROR) << "Failed to read in datafile (" << dataFileName << "). Error " << errno << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    return ret;
+}
+
+// the shard list starts with SHARDED_DATA_MAGIC, followed by one line "offset\tsize\tpath" per shard
+static void parseShardList(const char *dataFileName, const std::string &list, std::vector<size_t> &offsets,
+                           std::vector<size_t> &sizes, std::vector<std::string> &paths) {
+    size_t pos = sizeof(DBReader<unsigned int>::SHARDED_DATA_MAGIC);
+    while (pos < list.size()) {
+        size_t end = list.find('\n', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string line = list.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.empty()) {
+            continue;
+        }
+        size_t tab1 = line.find('\t');
+        size_t tab2 = (tab1 == std::string::npos) ? std::string::npos : line.find('\t', tab1 + 1);
+        if (tab2 == std::string::npos) {
+            Debug(Debug::ERROR) << "Invalid shard entry in " << dataFileName << ": " << line << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        offsets.push_back(strtoull(line.c_str(), NULL, 10));
+        sizes.push_back(strtoull(line.c_str() + tab1 + 1, NULL, 10));
+        paths.push_back(line.substr(tab2 + 1));
+    }
+}
+
+template <typename T>
+void DBReader<T>::removeBinaryIndex(const std::string &indexFileName) {
+    std::string binaryIndexFileName = getBinaryIndexFileName(indexFileName);
+    if (FileUtil::fileExists(binaryIndexFileName.c_str())) {
+        FileUtil::deleteFile(binaryIndexFileName);
+    }
+}
+
+template <typename T>
+bool DBReader<T>::removeIndex(const std::string &indexFileName) {
+    removeBinaryIndex(indexFileName);
+    return std::remove(indexFileName.c_str()) == 0;
+}
+
+template <typename T>
+bool DBReader<T>::moveIndex(const std::string &srcIndexFileName, const std::string &dstIndexFileName) {
+    removeBinaryIndex(dstIndexFileName);
+    if (std::rename(srcIndexFileName.c_str(), dstIndexFileName.c_str()) != 0) {
+        return false;
+    }
+    std::string srcBinaryIndexFileName = getBinaryIndexFileName(srcIndexFileName);
+    if (FileUtil::fileExists(srcBinaryIndexFileName.c_str())) {
+        std::rename(srcBinaryIndexFileName.c_str(), getBinaryIndexFileName(dstIndexFileName).c_str());
+    }
+    return true;
+}
+
+template <typename T>
+void DBReader<T>::removeDb(const std::string &dataFileName, const std::string &indexFileName) {
+    // a sharded data file only lists the shards, they have to go first
+    FILE *file = fopen(dataFileName.c_str(), "r");
+    if (file != NULL) {
+        char magic[sizeof(SHARDED_DATA_MAGIC)];
+        if (fread(magic, sizeof(char), sizeof(magic), file) == sizeof(magic)
+            && memcmp(magic, SHARDED_DATA_MAGIC, sizeof(magic)) == 0) {
+            std::string list(magic, sizeof(magic));
+            char buffer[4096];
+            size_t read;
+            while ((read = fread(buffer, sizeof(char), sizeof(buffer), file)) > 0) {
+                list.append(buffer, read);
+            }
+            std::vector<size_t> offsets;
+            std::vector<size_t> sizes;
+            std::vector<std::string> paths;
+            parseShardList(dataFileName.c_str(), list, offsets, sizes, paths);
+            for (size_t i = 0; i < paths.size(); i++) {
+                if (FileUtil::fileExists(paths[i].c_str())) {
+                    FileUtil::deleteFile(paths[i]);
+                }
+            }
+        }
+        fclose(file);
+    }
+
+    const std::string files[] = {dataFileName, dataFileName + ".dbtype"};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        if (FileUtil::fileExists(files[i].c_str())) {
+            FileUtil::deleteFile(files[i]);
+        }
+    }
+    if (FileUtil::fileExists(indexFileName.c_str()) && removeIndex(indexFileName) == false) {
+        Debug(Debug::WARNING) << "Error deleting file " << indexFileName << "\n";
+    }
+}
+
+template <typename T>
+void DBReader<T>::moveDb(const std::string &srcDataFileName, const std::string &srcIndexFileName,
+                         const std::string &dstDataFileName, const std::string &dstIndexFileName) {
+    if (std::rename(srcDataFileName.c_str(), dstDataFileName.c_str()) != 0) {
+        Debug(Debug::ERROR) << "Could not move " << srcDataFileName << " to " << dstDataFileName << "!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (moveIndex(srcIndexFileName, dstIndexFileName) == false) {
+        Debug(Debug::ERROR) << "Could not move " << srcIndexFileName << " to " << dstIndexFileName << "!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    // a dbtype left at the destination would describe the old data
+    const std::string srcDbtype = srcDataFileName + ".dbtype";
+    const std::string dstDbtype = dstDataFileName + ".dbtype";
+    if (FileUtil::fileExists(srcDbtype.c_str())) {
+        if (std::rename(srcDbtype.c_str(), dstDbtype.c_str()) != 0) {
+            Debug(Debug::ERROR) << "Could not move " << srcDbtype << " to " << dstDbtype << "!\n";
+            EXIT(EXIT_FAILURE);
+        }
+    } else if (FileUtil::fileExists(dstDbtype.c_str())) {
+        FileUtil::deleteFile(dstDbtype);
+    }
+}
+
+template <typename T> char* DBReader<T>::mmapShards(FILE *file, size_t fileSize, size_t *dataSize) {
+    std::string list(fileSize, '\0');
+    if (pread(fileno(file), &list[0], fileSize, 0) != (ssize_t) fileSize) {
+        Debug(Debug::ERROR) << "Failed to read shard list " << dataFileName << ". Error " << errno << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes;
+    std::vector<std::string> paths;
+    parseShardList(dataFileName, list, offsets, sizes, paths);
+
+    *dataSize = 0;
+    for (size_t i = 0; i < offsets.size(); i++) {
+        *dataSize = std::max(*dataSize, offsets[i] + sizes[i]);
+    }
+    if (*dataSize == 0) {
+        Debug(Debug::ERROR) << "Shard list " << dataFileName << " does not contain any data\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    char *ret;
+    if ((dataMode & USE_FREAD) == 0) {
+        int mode = (dataMode & USE_WRITABLE) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        // reserve the whole range first, every shard is then mapped to its page aligned offset
+        ret = static_cast<char*>(mmap(NULL, *dataSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (ret == MAP_FAILED) {
+            Debug(Debug::ERROR) << "Failed to reserve memory dataSize=" << *dataSize << " File=" << dataFileName << ". Error " << errno << ".\n";
+            EXIT(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (sizes[i] == 0) {
+                continue;
+            }
+            int fd = ::open(paths[i].c_str(), O_RDONLY);
+            struct stat sb;
+            if (fd < 0 || fstat(fd, &sb) < 0 || (size_t) sb.st_size != sizes[i]) {
+                Debug(Debug::ERROR) << "Shard " << paths[i] << " of " << dataFileName << " is missing or was modified\n";
+                EXIT(EXIT_FAILURE);
+            }
+            if (mmap(ret + offsets[i], sizes[i], mode, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                Debug(Debug::ERROR) << "Failed to mmap shard " << paths[i] << ". Error " << errno << ".\n";
+                EXIT(EXIT_FAILURE);
+            }
+            ::close(fd);
+        }
+    } else {
+        ret = static_cast<char*>(calloc(*dataSize, sizeof(char)));
+        Util::checkAllocation(ret, "Not enough system memory to read in the whole data file.");
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (sizes[i] == 0) {
+                continue;
+            }
+            FILE *shard = fopen(paths[i].c_str(), "r");
+            if (shard == NULL || fread(ret + offsets[i], 1, sizes[i], shard) != sizes[i]) {
+                Debug(Debug::ERROR) << "Failed to read in shard " << paths[i] << " of " << dataFileName << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            fclose(shard);
+        }
+    }
+    return ret;
+}
+
 template <typename T> void DBReader<T>::remapData(){
-    if ((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0) {
+    if ((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0 && loadMode != LOAD_MODE_PREAD) {
         unmapData();
         FILE* dataFile = fopen(dataFileName, "r");
         data = mmapData(dataFile, &dataSize);
@@ -317,12 +748,49 @@ template <typename T> void DBReader<T>::close(){
     if(dataMode & USE_DATA){
         unmapData();
     }
+    if (decompressBuffers != NULL) {
+        for (int i = 0; i < decompressThreads; i++) {
+            free(decompressBuffers[i]);
+        }
+        delete[] decompressBuffers;
+        delete[] decompressBufferSizes;
+        decompressBuffers = NULL;
+        decompressBufferSizes = NULL;
+    }
+    if (readBuffers != NULL) {
+        for (int i = 0; i < readThreads; i++) {
+            free(readBuffers[i]);
+        }
+        delete[] readBuffers;
+        delete[] readBufferSizes;
+        readBuffers = NULL;
+        readBufferSizes = NULL;
+    }
+    delete blockCache;
+    blockCache = NULL;
+    if (dataFd != -1) {
+        ::close(dataFd);
+        dataFd = -1;
+    }
     if(accessType == SORT_BY_LENGTH || accessType == LINEAR_ACCCESS || accessType == SORT_BY_LINE || accessType == SHUFFLE){
         delete [] id2local;
         delete [] local2id;
     }
+    delete[] keyLookup;
+    keyLookup = NULL;
+    keyLookupSize = 0;
+    delete[] keyHash;
+    keyHash = NULL;
 
-    if(externalData == false) {
+    if (indexMapped == true) {
+        if (munmap(indexMap, indexMapSize) < 0) {
+            Debug(Debug::ERROR) << "Failed to munmap binary index of " << indexFileName << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        indexMapped = false;
+        indexMap = NULL;
+        indexMapSize = 0;
+    } else if(externalData == false) {
         delete[] index;
         delete[] seqLens;
     }
@@ -355,24 +823,164 @@ template <typename T> char* DBReader<T>::getData(size_t id){
         Debug(Debug::ERROR) << "Requested offset: " << index[id].offset << "\n";
         EXIT(EXIT_FAILURE);
     }
+    size_t offset;
     if(accessType == SORT_BY_LENGTH || accessType == LINEAR_ACCCESS || accessType == SORT_BY_LINE || accessType == SHUFFLE){
-        return data + index[local2id[id]].offset;
+        offset = index[local2id[id]].offset;
     }else{
-        return data + index[id].offset;
+        offset = index[id].offset;
     }
+    if (data == NULL && dataFd != -1) {
+        return readEntry(offset, seqLens[id]);
+    }
+    char *entry = data + offset;
+    if (compressed == true) {
+        return decompressEntry(entry);
+    }
+    return entry;
+}
+
+template <typename T> char* DBReader<T>::decompressEntry(const char *entry) {
+    int thread_idx = 0;
+#ifdef OPENMP
+    thread_idx = omp_get_thread_num();
+#endif
+    if (thread_idx >= decompressThreads) {
+        Debug(Debug::ERROR) << "Thread " << thread_idx << " has no decompression buffer for " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    // entry layout: uncompressed size, compressed size, zlib stream
+    unsigned int uncompressedSize;
+    unsigned int compressedSize;
+    memcpy(&uncompressedSize, entry, sizeof(unsigned int));
+    memcpy(&compressedSize, entry + sizeof(unsigned int), sizeof(unsigned int));
+    if (uncompressedSize > decompressBufferSizes[thread_idx]) {
+        decompressBufferSizes[thread_idx] = uncompressedSize * 1.5;
+        decompressBuffers[thread_idx] = (char *) realloc(decompressBuffers[thread_idx], decompressBufferSizes[thread_idx]);
+        Util::checkAllocation(decompressBuffers[thread_idx], "Could not allocate decompression buffer");
+    }
+#ifdef HAVE_ZLIB
+    uLongf destLen = uncompressedSize;
+    int status = uncompress((Bytef *) decompressBuffers[thread_idx], &destLen,
+                            (const Bytef *) (entry + 2 * sizeof(unsigned int)), compressedSize);
+    if (status != Z_OK || destLen != uncompressedSize) {
+        Debug(Debug::ERROR) << "Could not decompress entry of " << dataFileName << ". Error " << status << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+#endif
+    return decompressBuffers[thread_idx];
+}
+
+template <typename T> char* DBReader<T>::readEntry(size_t offset, size_t length) {
+    int thread_idx = 0;
+#ifdef OPENMP
+    thread_idx = omp_get_thread_num();
+#endif
+    if (thread_idx >= readThreads) {
+        Debug(Debug::ERROR) << "Thread " << thread_idx << " has no read buffer for " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    if (compressed == true) {
+        // the index stores the uncompressed length, the stored length is in the entry header
+        unsigned int sizes[2];
+        if (blockCache->read((char *) sizes, sizeof(sizes), offset) == false) {
+            Debug(Debug::ERROR) << "Failed to read entry at offset " << offset << " of " << dataFileName << ". Error " << errno << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        length = sizeof(sizes) + sizes[1];
+    }
+    length = std::min(length, dataSize - offset);
+    if (length + 1 > readBufferSizes[thread_idx]) {
+        readBufferSizes[thread_idx] = (length + 1) * 1.5;
+        readBuffers[thread_idx] = (char *) realloc(readBuffers[thread_idx], readBufferSizes[thread_idx]);
+        Util::checkAllocation(readBuffers[thread_idx], "Could not allocate read buffer");
+    }
+    char *entry = readBuffers[thread_idx];
+    if (blockCache->read(entry, length, offset) == false) {
+        Debug(Debug::ERROR) << "Failed to read entry at offset " << offset << " of " << dataFileName << ". Error " << errno << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    entry[length] = '\0';
+    if (compressed == true) {
+        return decompressEntry(entry);
+    }
+    return entry;
+}
+
+template <typename T> const char* DBReader<T>::getData() {
+    if (data == NULL && dataFd != -1) {
+        data = static_cast<char*>(mmap(NULL, dataSize, PROT_READ, MAP_PRIVATE, dataFd, 0));
+        if (data == MAP_FAILED) {
+            Debug(Debug::ERROR) << "Failed to mmap memory dataSize=" << dataSize << " File=" << dataFileName << ". Error " << errno << ".\n";
+            EXIT(EXIT_FAILURE);
+        }
+        dataMapped = true;
+    }
+    return data;
 }
 
 template <typename T>
 void DBReader<T>::touchData(size_t id) {
-    if((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0) {
+    if((dataMode & USE_DATA) && (dataMode & USE_FREAD) == 0 && data != NULL) {
         char *data = getData(id);
         size_t size = getSeqLens(id);
         magicBytes = Util::touchMemory(data, size);
     }
 }
 
+template <typename T>
+void DBReader<T>::prefetch(const std::vector<size_t> &ids) {
+    if ((dataMode & USE_DATA) == 0 || (dataMode & USE_FREAD) || (data == NULL && dataFd == -1) || ids.empty()) {
+        return;
+    }
+    const bool useLocalIds = (accessType == SORT_BY_LENGTH || accessType == LINEAR_ACCCESS || accessType == SORT_BY_LINE || accessType == SHUFFLE);
+    std::vector<std::pair<size_t, size_t> > ranges;
+    ranges.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (ids[i] >= size) {
+            continue;
+        }
+        size_t offset = index[useLocalIds ? local2id[ids[i]] : ids[i]].offset;
+        if (offset >= dataSize) {
+            continue;
+        }
+        // compressed entries are usually shorter than the uncompressed length in the index
+        ranges.push_back(std::make_pair(offset, std::min(offset + seqLens[ids[i]], dataSize)));
+    }
+    if (ranges.empty()) {
+        return;
+    }
+    std::sort(ranges.begin(), ranges.end());
+
+    // merge ranges that share a page, every remaining range is one request
+    const size_t pageSize = Util::getPageSize();
+    size_t start = ranges[0].first & ~(pageSize - 1);
+    size_t end = ranges[0].second;
+    for (size_t i = 1; i <= ranges.size(); i++) {
+        if (i < ranges.size() && (ranges[i].first & ~(pageSize - 1)) <= end) {
+            end = std::max(end, ranges[i].second);
+            continue;
+        }
+        if (data != NULL) {
+            madvise(data + start, end - start, MADV_WILLNEED);
+        } else {
+#if defined(POSIX_FADV_WILLNEED)
+            posix_fadvise(dataFd, start, end - start, POSIX_FADV_WILLNEED);
+#endif
+        }
+        if (i < ranges.size()) {
+            start = ranges[i].first & ~(pageSize - 1);
+            end = ranges[i].second;
+        }
+    }
+}
+
 template <typename T> char* DBReader<T>::getDataByDBKey(T dbKey) {
     size_t id = getId(dbKey);
+    if (compressed == true || data == NULL) {
+        return (id != UINT_MAX) ? getData(id) : NULL;
+    }
     return (id != UINT_MAX) ? data + index[id].offset : NULL;
 }
 
@@ -402,6 +1010,28 @@ template <typename T> size_t DBReader<T>::getId (T dbKey){
     return (id < size && index[id].id == dbKey ) ? id : UINT_MAX;
 }
 
+template <> size_t DBReader<unsigned int>::getId (unsigned int dbKey){
+    if (keyLookup != NULL) {
+        const size_t pos = static_cast<size_t>(dbKey) - keyLookupOffset;
+        return (dbKey >= keyLookupOffset && pos < keyLookupSize) ? keyLookup[pos] : UINT_MAX;
+    }
+    if (keyHash != NULL) {
+        size_t pos = hashKey(dbKey) & keyHashMask;
+        while (keyHash[pos].id != UINT_MAX) {
+            if (keyHash[pos].key == dbKey) {
+                return keyHash[pos].id;
+            }
+            pos = (pos + 1) & keyHashMask;
+        }
+        return UINT_MAX;
+    }
+    size_t id = bsearch(index, size, dbKey);
+    if(accessType == SORT_BY_LENGTH || accessType == LINEAR_ACCCESS || accessType == SORT_BY_LINE || accessType == SHUFFLE){
+        return  (id < size && index[id].id == dbKey) ? id2local[id] : UINT_MAX;
+    }
+    return (id < size && index[id].id == dbKey ) ? id : UINT_MAX;
+}
+
 template <typename T> unsigned int* DBReader<T>::getSeqLens(){
     return seqLens;
 }
@@ -420,6 +1050,17 @@ template <typename T> size_t DBReader<T>::maxCount(char c) {
 
     size_t max = 0;
     size_t count = 0;
+    if (compressed == true || data == NULL) {
+        for (size_t id = 0; id < size; ++id) {
+            const char *entry = getData(id);
+            count = 0;
+            for (size_t i = 0; i < seqLens[id] && entry[i] != '\0'; ++i) {
+                count += (entry[i] == c);
+            }
+            max = std::max(max, count);
+        }
+        return max;
+    }
     for (size_t i = 0; i < dataSize; ++i) {
         if (data[i] == c) {
             count++;
@@ -478,6 +1119,140 @@ bool DBReader<T>::readIndex(char *indexFileName, Index *index, unsigned int *ent
     return isSorted;
 }
 
+template<typename T>
+size_t DBReader<T>::getMtimeNsec(const struct stat &sb) {
+#ifdef __APPLE__
+    return sb.st_mtimespec.tv_nsec;
+#else
+    return sb.st_mtim.tv_nsec;
+#endif
+}
+
+template<typename T>
+bool DBReader<T>::readBinaryIndex(const char *) {
+    return false;
+}
+
+template<>
+bool DBReader<unsigned int>::readBinaryIndex(const char *indexFileName) {
+    std::string binaryIndexFileName = getBinaryIndexFileName(indexFileName);
+    struct stat textStat;
+    struct stat binaryStat;
+    if (stat(indexFileName, &textStat) != 0 || stat(binaryIndexFileName.c_str(), &binaryStat) != 0) {
+        return false;
+    }
+    if ((size_t) binaryStat.st_size < sizeof(BinaryIndexHeader)) {
+        return false;
+    }
+
+    FILE *file = fopen(binaryIndexFileName.c_str(), "r");
+    if (file == NULL) {
+        return false;
+    }
+    size_t mapSize = binaryStat.st_size;
+    // MAP_PRIVATE keeps in-place sorting and offset rewriting by callers local to this process
+    void *map = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(file), 0);
+    fclose(file);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    const BinaryIndexHeader *header = (const BinaryIndexHeader *) map;
+    size_t expectedSize = sizeof(BinaryIndexHeader) + header->size * (sizeof(Index) + sizeof(unsigned int));
+    if (memcmp(header->magic, BINARY_INDEX_MAGIC, sizeof(BINARY_INDEX_MAGIC)) != 0
+        || expectedSize != mapSize
+        || header->textIndexSize != (size_t) textStat.st_size
+        || header->textIndexMtime != (size_t) textStat.st_mtime
+        || header->textIndexMtimeNsec != getMtimeNsec(textStat)) {
+        Debug(Debug::WARNING) << "Ignoring outdated binary index " << binaryIndexFileName << "\n";
+        munmap(map, mapSize);
+        return false;
+    }
+    // the binary index is sorted by id, the original line order is only known if it was the same
+    if ((accessType == SORT_BY_LINE || accessType == HARDNOSORT) && header->linesSortedById == 0) {
+        munmap(map, mapSize);
+        return false;
+    }
+
+    size = header->size;
+    aaDbSize = header->aaDbSize;
+    lastKey = header->lastKey;
+    indexMap = (char *) map;
+    indexMapSize = mapSize;
+    index = (Index *) (indexMap + sizeof(BinaryIndexHeader));
+    seqLens = (unsigned int *) (indexMap + sizeof(BinaryIndexHeader) + size * sizeof(Index));
+    indexMapped = true;
+    return true;
+}
+
+template<typename T>
+bool DBReader<T>::readStream(FILE *) {
+    Debug(Debug::ERROR) << "Only databases with numeric keys can be read from " << STREAM_STDIN << "\n";
+    EXIT(EXIT_FAILURE);
+}
+
+template<>
+bool DBReader<unsigned int>::readStream(FILE *file) {
+    char magic[sizeof(STREAM_MAGIC)];
+    if (fread(magic, sizeof(char), sizeof(magic), file) != sizeof(magic) || memcmp(magic, STREAM_MAGIC, sizeof(magic)) != 0) {
+        Debug(Debug::ERROR) << "Input on " << STREAM_STDIN << " is not a database stream\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    std::vector<Index> entries;
+    std::vector<unsigned int> lengths;
+    size_t capacity = 1024 * 1024;
+    char *buffer = (char *) malloc(capacity);
+    Util::checkAllocation(buffer, "Not enough system memory to read in the database stream.");
+    size_t used = 0;
+    bool isSorted = true;
+    bool hasEnd = false;
+    while (true) {
+        unsigned int key;
+        size_t length;
+        if (fread(&key, sizeof(unsigned int), 1, file) != 1 || fread(&length, sizeof(size_t), 1, file) != 1) {
+            break;
+        }
+        if (length == STREAM_END) {
+            hasEnd = fread(&dbtype, sizeof(int), 1, file) == 1;
+            break;
+        }
+        if (length > UINT_MAX) {
+            Debug(Debug::ERROR) << "Entry " << key << " in " << STREAM_STDIN << " is too long\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (used + length > capacity) {
+            capacity = std::max(2 * capacity, used + length);
+            buffer = (char *) realloc(buffer, capacity);
+            Util::checkAllocation(buffer, "Not enough system memory to read in the database stream.");
+        }
+        if (fread(buffer + used, sizeof(char), length, file) != length) {
+            break;
+        }
+        Index entry;
+        entry.id = key;
+        entry.offset = used;
+        isSorted &= entries.empty() || entries.back().id <= key;
+        lastKey = std::max(lastKey, key);
+        entries.push_back(entry);
+        lengths.push_back(length);
+        used += length;
+    }
+    if (hasEnd == false) {
+        Debug(Debug::ERROR) << "Database stream on " << STREAM_STDIN << " ended unexpectedly\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    data = buffer;
+    dataSize = used;
+    size = entries.size();
+    index = new Index[size];
+    seqLens = new unsigned int[size];
+    std::copy(entries.begin(), entries.end(), index);
+    std::copy(lengths.begin(), lengths.end(), seqLens);
+    return isSorted;
+}
+
 template<typename T> T DBReader<T>::getLastKey() {
     return lastKey;
 }
@@ -507,6 +1282,7 @@ template <typename T> void DBReader<T>::unmapData() {
         } else {
             free(data);
         }
+        data = NULL;
         dataMapped = false;
     }
 }
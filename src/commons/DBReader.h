@@ -9,8 +9,12 @@
 #include <cstddef>
 #include <utility>
 #include <string>
+#include <vector>
+#include <sys/stat.h>
 #include "Sequence.h"
 
+class BlockCache;
+
 template <typename T>
 class DBReader {
 
@@ -22,6 +26,22 @@ public:
             return (x.id <= y.id);
         }
     };
+
+    // Header of the binary index (<index>.bin). It is followed by the sorted Index
+    // array and the entry length array, so the file can be mapped and used in place.
+    // The text index size and modification time (in nanoseconds where available) are
+    // stored to detect stale files. linesSortedById is set if the text index lines were
+    // already in id order, only then the binary index can serve SORT_BY_LINE and HARDNOSORT.
+    struct BinaryIndexHeader {
+        char magic[8];
+        size_t size;
+        size_t aaDbSize;
+        size_t lastKey;
+        size_t textIndexSize;
+        size_t textIndexMtime;
+        size_t textIndexMtimeNsec;
+        size_t linesSortedById;
+    };
     DBReader(const char* dataFileName, const char* indexFileName, int mode = USE_DATA|USE_INDEX);
 
     DBReader(Index* index, unsigned int *seqLens, size_t size, size_t aaDbSize, T lastKey);
@@ -40,10 +60,22 @@ public:
 
     size_t getAminoAcidDBSize(){ return aaDbSize; }
 
+    // for compressed databases and LOAD_MODE_PREAD the returned entry is only
+    // valid until the next getData call of the same thread
     char* getData(size_t id);
 
+    // true if getData returns entries in a per thread buffer (see above), a caller that keeps
+    // a query and a target entry of the same database alive then needs a second reader
+    bool hasTransientEntries() {
+        return compressed || (data == NULL && dataFd != -1);
+    }
+
     void touchData(size_t id);
 
+    // asks the kernel to read the entries (local ids) asynchronously, so reading many entries
+    // from slow storage overlaps instead of faulting them in one at a time
+    void prefetch(const std::vector<size_t> &ids);
+
     char* getDataByDBKey(T key);
 
     size_t getSize();
@@ -76,19 +108,74 @@ public:
     static const int USE_DATA     = 1;
     static const int USE_WRITABLE = 2;
     static const int USE_FREAD    = 4;
+    // getId goes through a table built on open instead of a binary search, for readers with many lookups
+    static const int USE_KEY_LOOKUP = 8;
+
+    // how the data file is brought into memory (--db-load-mode), ignored for USE_WRITABLE
+    static const int LOAD_MODE_MMAP       = 0; // pages are faulted in on first access
+    static const int LOAD_MODE_MMAP_TOUCH = 1; // all pages are touched in parallel on open
+    static const int LOAD_MODE_HUGEPAGES  = 2; // read into transparent hugepage backed memory
+    static const int LOAD_MODE_PREAD      = 3; // nothing is mapped, entries are read on access
+
+    // upper bound of the block cache of each LOAD_MODE_PREAD reader
+    static const size_t PREAD_CACHE_SIZE = 256 * 1024 * 1024;
+
+    static void setDefaultLoadMode(int mode) {
+        defaultLoadMode = mode;
+    }
 
-    const char * getData(){
-        return data;
+    // has to be called before open
+    void setLoadMode(int mode) {
+        loadMode = mode;
     }
 
+    int getLoadMode() {
+        return loadMode;
+    }
+
+    // whole data file, in LOAD_MODE_PREAD it is mapped on the first call
+    const char * getData();
+
     size_t getDataSize(){
         return dataSize;
     }
 
     char *mmapData(FILE *file, size_t *dataSize);
 
+    // reads the file with parallel preads into memory that is aligned to and advised for huge pages
+    char *readIntoHugePages(int fd, size_t dataSize);
+
+    // maps all shards listed in the data file into one contiguous region at their virtual offsets
+    char *mmapShards(FILE *file, size_t fileSize, size_t *dataSize);
+
     bool readIndex(char *indexFileName, Index *index, unsigned int *entryLength);
 
+    // maps <index>.bin if it exists, matches the text index and keeps the order the access type needs
+    // returns false if the text index has to be parsed instead
+    bool readBinaryIndex(const char *indexFileName);
+
+    static size_t getMtimeNsec(const struct stat &sb);
+
+    static std::string getBinaryIndexFileName(const std::string &indexFileName) {
+        return indexFileName + ".bin";
+    }
+
+    // call whenever a text index is removed or replaced without DBWriter
+    static void removeBinaryIndex(const std::string &indexFileName);
+
+    // remove or rename a text index together with its binary index
+    // return false if the text index could not be removed or renamed
+    static bool removeIndex(const std::string &indexFileName);
+    static bool moveIndex(const std::string &srcIndexFileName, const std::string &dstIndexFileName);
+
+    // remove or move the data file, index, binary index and dbtype of a database
+    // removeDb also deletes the shards of a sharded data file, moveDb keeps them in place
+    static void removeDb(const std::string &dataFileName, const std::string &indexFileName);
+    static void moveDb(const std::string &srcDataFileName, const std::string &srcIndexFileName,
+                       const std::string &dstDataFileName, const std::string &dstIndexFileName);
+
+    static const char BINARY_INDEX_MAGIC[8];
+
     void readIndexId(T* id, char * line, char** cols);
 
     void readMmapedDataInMemory();
@@ -123,6 +210,33 @@ public:
 
     static int parseDbType(const char *name);
 
+    // .dbtype of result databases stored as binary records, sequence database types are defined in Sequence
+    static const int DBTYPE_PREFILTER_BINARY = 16;
+    static const int DBTYPE_ALIGNMENT_BINARY = 17;
+
+    // data files written by DBWriter::COMPRESSED_MODE start with this magic
+    static const char COMPRESSED_DATA_MAGIC[8];
+
+    // data files written by DBWriter::SHARDED_MODE are a list of shards starting with this magic,
+    // each line holds: virtual offset, size and path of one shard
+    static const char SHARDED_DATA_MAGIC[8];
+
+    // a data file named STREAM_STDIN is read as a framed entry stream from stdin (see DBWriter::STREAM_STDOUT),
+    // no index file is needed. The stream starts with STREAM_MAGIC, every frame holds the key (unsigned int),
+    // the length (size_t) and the entry including its null byte. A frame with length STREAM_END and the dbtype (int)
+    // ends the stream.
+    // Only the framing is streamed: open() reads the whole stream into memory before the first entry is used,
+    // so a consumer starts after its producer finished and needs memory for the complete database.
+    static const char STREAM_STDIN[];
+    static const char STREAM_MAGIC[8];
+    static const size_t STREAM_END = static_cast<size_t>(-1);
+
+    static bool isStream(const char *dataFileName);
+
+    bool isCompressed() {
+        return compressed;
+    }
+
     int getDbtype(){
         return dbtype;
     }
@@ -178,6 +292,19 @@ private:
 
     void checkClosed();
 
+    // builds the key to local id lookup used by getId
+    void buildKeyLookup();
+
+    // inflates a compressed entry into the buffer of the calling thread
+    char *decompressEntry(const char *entry);
+
+    // LOAD_MODE_PREAD: reads the entry at offset into the buffer of the calling thread
+    char *readEntry(size_t offset, size_t length);
+
+    // reads the whole framed stream into memory and builds the index from it
+    // returns true if the keys arrived in sorted order
+    bool readStream(FILE *file);
+
     char* data;
 
     int dataMode;
@@ -211,9 +338,42 @@ private:
 
     bool didMlock;
 
+    // index and seqLens point into the mapped binary index
+    bool indexMapped;
+    char *indexMap;
+    size_t indexMapSize;
+
     // needed to prevent the compiler from optimizing away the loop
     char magicBytes;
 
+    // entries are compressed one by one, each thread inflates into its own buffer
+    bool compressed;
+    int decompressThreads;
+    char **decompressBuffers;
+    size_t *decompressBufferSizes;
+
+    static int defaultLoadMode;
+    int loadMode;
+    // LOAD_MODE_PREAD keeps the data file open instead of mapping it and copies every
+    // entry into a buffer of the calling thread, file blocks are cached in blockCache
+    int dataFd;
+    int readThreads;
+    char **readBuffers;
+    size_t *readBufferSizes;
+    BlockCache *blockCache;
+
+    // USE_KEY_LOOKUP: dense keys map directly into keyLookup (shifted by keyLookupOffset),
+    // sparse keys go through an open addressing hash table with linear probing
+    struct KeyLookupEntry {
+        unsigned int key;
+        unsigned int id;
+    };
+    unsigned int *keyLookup;
+    size_t keyLookupSize;
+    unsigned int keyLookupOffset;
+    KeyLookupEntry *keyHash;
+    size_t keyHashMask;
+
 };
 
 #endif
@@ -9,17 +9,27 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <climits>
 #include <sstream>
+#include <algorithm>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsigned int threads, size_t mode)
         : threads(threads), mode(mode) {
     dataFileName = strdup(dataFileName_);
     indexFileName = strdup(indexFileName_);
+    stream = strcmp(dataFileName, STREAM_STDOUT) == 0;
+    streamFile = NULL;
 
     dataFiles = new FILE *[threads];
     dataFilesBuffer = new char *[threads];
@@ -34,6 +44,37 @@ DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsign
     offsets = new size_t[threads];
     std::fill(offsets, offsets + threads, 0);
 
+    threadBytesWritten = new size_t[threads];
+    std::fill(threadBytesWritten, threadBytesWritten + threads, 0);
+    threadStallTime = new double[threads];
+    std::fill(threadStallTime, threadStallTime + threads, 0.0);
+    bytesWritten = 0;
+    stallTime = 0.0;
+
+    asyncPending = NULL;
+    asyncInFlight = NULL;
+    asyncStop = false;
+
+    entryBuffers = NULL;
+    compressBuffers = NULL;
+    compressBufferSizes = NULL;
+    if (stream) {
+        entryBuffers = new std::string[threads];
+    } else if ((mode & COMPRESSED_MODE) != 0) {
+#ifndef HAVE_ZLIB
+        Debug(Debug::ERROR) << "Can not write compressed database " << dataFileName << ". MMseqs2 was compiled without zlib support!\n";
+        EXIT(EXIT_FAILURE);
+#endif
+        entryBuffers = new std::string[threads];
+        compressBuffers = new char*[threads];
+        compressBufferSizes = new size_t[threads];
+        for (unsigned int i = 0; i < threads; i++) {
+            compressBufferSizes[i] = 1024;
+            compressBuffers[i] = (char *) malloc(compressBufferSizes[i]);
+            Util::checkAllocation(compressBuffers[i], "Could not allocate compression buffer");
+        }
+    }
+
     if ((mode & BINARY_MODE) != 0) {
         datafileMode = "wb";
     } else {
@@ -44,6 +85,16 @@ DBWriter::DBWriter(const char *dataFileName_, const char *indexFileName_, unsign
 }
 
 DBWriter::~DBWriter() {
+    if (compressBuffers != NULL) {
+        for (unsigned int i = 0; i < threads; i++) {
+            free(compressBuffers[i]);
+        }
+        delete[] compressBuffers;
+        delete[] compressBufferSizes;
+    }
+    delete[] entryBuffers;
+    delete[] threadStallTime;
+    delete[] threadBytesWritten;
     delete[] offsets;
     delete[] starts;
     delete[] indexFileNames;
@@ -94,12 +145,13 @@ void DBWriter::mergeFiles(DBReader<unsigned int> &qdbr,
         std::ostringstream ss;
         // get all data for the id from all files
         for (size_t i = 0; i < fileCount; i++) {
-            const char *data = filesToMerge[i]->getDataByDBKey(key);
-            if (data != NULL) {
+            const size_t id = filesToMerge[i]->getId(key);
+            if (id != UINT_MAX) {
                 if(i < prefixes.size()) {
                     ss << prefixes[i];
                 }
-                ss << data;
+                // copy by length, binary entries can contain null bytes
+                ss.write(filesToMerge[i]->getData(id), filesToMerge[i]->getSeqLens(id) - 1);
             }
         }
         // write result
@@ -117,6 +169,23 @@ void DBWriter::mergeFiles(DBReader<unsigned int> &qdbr,
     Debug(Debug::INFO) << "Done\n";
 }
 
+const char DBWriter::STREAM_STDOUT[] = "stdout";
+
+FILE *DBWriter::reserveStdout() {
+    static FILE *file = NULL;
+    if (file == NULL) {
+        std::cout.flush();
+        fflush(stdout);
+        Debug::setLogToStderr(true);
+        int fd = dup(STDOUT_FILENO);
+        if (fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0 || (file = fdopen(fd, "wb")) == NULL) {
+            Debug(Debug::ERROR) << "Could not open " << STREAM_STDOUT << " for writing!\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+    return file;
+}
+
 // allocates heap memory, careful
 char* makeResultFilename(const char* name, size_t split) {
     std::ostringstream ss;
@@ -126,6 +195,22 @@ char* makeResultFilename(const char* name, size_t split) {
 }
 
 void DBWriter::open(size_t bufferSize) {
+    std::fill(threadBytesWritten, threadBytesWritten + threads, 0);
+    std::fill(threadStallTime, threadStallTime + threads, 0.0);
+    if (stream) {
+        streamFile = reserveStdout();
+        pthread_mutex_init(&streamMutex, NULL);
+        if (fwrite(DBReader<unsigned int>::STREAM_MAGIC, sizeof(DBReader<unsigned int>::STREAM_MAGIC), 1, streamFile) != 1) {
+            Debug(Debug::ERROR) << "Could not write to " << STREAM_STDOUT << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        closed = false;
+        return;
+    }
+    if ((mode & ASYNC_MODE) != 0) {
+        startAsyncWriter();
+    }
+
     for (unsigned int i = 0; i < threads; i++) {
         dataFileNames[i] = makeResultFilename(dataFileName, i);
         indexFileNames[i] = makeResultFilename(indexFileName, i);
@@ -176,36 +261,67 @@ void DBWriter::open(size_t bufferSize) {
             perror(indexFileNames[i]);
             EXIT(EXIT_FAILURE);
         }
+
+        // every thread file carries the magic so that the merged data file starts with it
+        if ((mode & COMPRESSED_MODE) != 0) {
+            const size_t magicSize = sizeof(DBReader<unsigned int>::COMPRESSED_DATA_MAGIC);
+            writeToFile(DBReader<unsigned int>::COMPRESSED_DATA_MAGIC, magicSize, i, false);
+            offsets[i] = magicSize;
+        }
     }
 
     closed = false;
 }
 
 void DBWriter::close(int dbType) {
+    if (stream) {
+        unsigned int key = 0;
+        size_t end = DBReader<unsigned int>::STREAM_END;
+        if (fwrite(&key, sizeof(unsigned int), 1, streamFile) != 1 || fwrite(&end, sizeof(size_t), 1, streamFile) != 1
+            || fwrite(&dbType, sizeof(int), 1, streamFile) != 1 || fflush(streamFile) != 0) {
+            Debug(Debug::ERROR) << "Could not write to " << STREAM_STDOUT << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        // stdout stays reserved, other writers of this process may still stream to it
+        pthread_mutex_destroy(&streamMutex);
+        bytesWritten = 0;
+        stallTime = 0.0;
+        for (unsigned int i = 0; i < threads; i++) {
+            bytesWritten += threadBytesWritten[i];
+            stallTime += threadStallTime[i];
+        }
+        closed = true;
+        return;
+    }
+
+    if ((mode & ASYNC_MODE) != 0) {
+        stopAsyncWriter();
+    }
+
     // close all datafiles
+    bytesWritten = 0;
+    stallTime = 0.0;
     for (unsigned int i = 0; i < threads; i++) {
         fclose(dataFiles[i]);
         fclose(indexFiles[i]);
+        bytesWritten += threadBytesWritten[i];
+        stallTime += threadStallTime[i];
+    }
+    if ((mode & ASYNC_MODE) != 0) {
+        Debug(Debug::INFO) << "Wrote " << bytesWritten << " bytes to " << dataFileName
+                           << ", threads waited " << stallTime << "s for the writer\n";
     }
 
     if (dbType > -1){
-        std::string dataFile = dataFileName;
-        std::string dbTypeFile = (dataFile+".dbtype").c_str();
-        FILE * dbtypeDataFile = fopen(dbTypeFile.c_str(), "wb");
-        if (dbtypeDataFile == NULL) {
-            Debug(Debug::ERROR) << "Could not open data file " << dbTypeFile << "!\n";
-            EXIT(EXIT_FAILURE);
-        }
-        size_t written = fwrite(&dbType, sizeof(int), 1, dbtypeDataFile);
-        if (written != 1) {
-            Debug(Debug::ERROR) << "Could not write to data file " << dbTypeFile << "\n";
-            EXIT(EXIT_FAILURE);
-        }
-        fclose(dbtypeDataFile);
+        writeDbtypeFile(dataFileName, dbType);
     }
 
-    mergeResults(dataFileName, indexFileName,
-                 (const char **) dataFileNames, (const char **) indexFileNames, threads, ((mode & LEXICOGRAPHIC_MODE) != 0));
+    if ((mode & SHARDED_MODE) != 0) {
+        writeShards();
+    } else {
+        mergeResults(dataFileName, indexFileName,
+                     (const char **) dataFileNames, (const char **) indexFileNames, threads, ((mode & LEXICOGRAPHIC_MODE) != 0));
+    }
 
     for (unsigned int i = 0; i < threads; i++) {
         delete [] dataFilesBuffer[i];
@@ -215,6 +331,29 @@ void DBWriter::close(int dbType) {
     closed = true;
 }
 
+void DBWriter::writeDbtypeFile(const char *dataFileName, int dbType) {
+    std::string dataFile = dataFileName;
+    std::string dbTypeFile = (dataFile+".dbtype").c_str();
+    FILE * dbtypeDataFile = fopen(dbTypeFile.c_str(), "wb");
+    if (dbtypeDataFile == NULL) {
+        Debug(Debug::ERROR) << "Could not open data file " << dbTypeFile << "!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    size_t written = fwrite(&dbType, sizeof(int), 1, dbtypeDataFile);
+    if (written != 1) {
+        Debug(Debug::ERROR) << "Could not write to data file " << dbTypeFile << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    fclose(dbtypeDataFile);
+}
+
+void DBWriter::removeDbtypeFile(const char *dataFileName) {
+    std::string dbTypeFile = std::string(dataFileName) + ".dbtype";
+    if (FileUtil::fileExists(dbTypeFile.c_str())) {
+        FileUtil::deleteFile(dbTypeFile);
+    }
+}
+
 void DBWriter::writeStart(unsigned int thrIdx) {
     checkClosed();
     if (thrIdx >= threads) {
@@ -223,6 +362,9 @@ void DBWriter::writeStart(unsigned int thrIdx) {
     }
 
     starts[thrIdx] = offsets[thrIdx];
+    if (stream || (mode & COMPRESSED_MODE) != 0) {
+        entryBuffers[thrIdx].clear();
+    }
 }
 
 void DBWriter::writeAdd(const char* data, size_t dataSize, unsigned int thrIdx) {
@@ -232,38 +374,241 @@ void DBWriter::writeAdd(const char* data, size_t dataSize, unsigned int thrIdx)
         EXIT(EXIT_FAILURE);
     }
 
-    size_t written = fwrite(data, sizeof(char), dataSize, dataFiles[thrIdx]);
-    if (written != dataSize) {
-        Debug(Debug::ERROR) << "Could not write to data file " << dataFileNames[thrIdx] << "\n";
-        EXIT(EXIT_FAILURE);
+    if (stream || (mode & COMPRESSED_MODE) != 0) {
+        entryBuffers[thrIdx].append(data, dataSize);
+        return;
     }
-    offsets[thrIdx] += written;
+
+    writeToFile(data, dataSize, thrIdx, false);
+    offsets[thrIdx] += dataSize;
 }
 
 void DBWriter::writeEnd(unsigned int key, unsigned int thrIdx, bool addNullByte) {
-    size_t written;
-    // entries are always separated by a null byte
-    if(addNullByte == true){
-        char nullByte = '\0';
-        written = fwrite(&nullByte, sizeof(char), 1, dataFiles[thrIdx]);
-        if (written != 1) {
-            Debug(Debug::ERROR) << "Could not write to data file " << dataFileNames[thrIdx] << "\n";
-            EXIT(EXIT_FAILURE);
+    if (stream) {
+        if (addNullByte == true) {
+            entryBuffers[thrIdx].push_back('\0');
         }
-        offsets[thrIdx] += 1;
+        writeStreamEntry(key, thrIdx);
+        return;
     }
 
-    size_t length = offsets[thrIdx] - starts[thrIdx];
+    size_t length;
+    if ((mode & COMPRESSED_MODE) != 0) {
+        if (addNullByte == true) {
+            entryBuffers[thrIdx].push_back('\0');
+        }
+        writeCompressedEntry(thrIdx);
+        // the index stores the uncompressed length, offsets refer to the compressed record
+        length = entryBuffers[thrIdx].size();
+    } else {
+        // entries are always separated by a null byte
+        if(addNullByte == true){
+            char nullByte = '\0';
+            writeToFile(&nullByte, 1, thrIdx, false);
+            offsets[thrIdx] += 1;
+        }
+        length = offsets[thrIdx] - starts[thrIdx];
+    }
 
     char buffer[1024];
     size_t len = indexToBuffer(buffer, key, starts[thrIdx], length );
-    written = fwrite(buffer, sizeof(char), len, indexFiles[thrIdx]);
-    if (written != len) {
-        Debug(Debug::ERROR) << "Could not write to data file " << indexFiles[thrIdx] << "\n";
+    writeToFile(buffer, len, thrIdx, true);
+}
+
+void DBWriter::writeCompressedEntry(unsigned int thrIdx) {
+#ifdef HAVE_ZLIB
+    const std::string &entry = entryBuffers[thrIdx];
+    uLongf compressedSize = compressBound(entry.size());
+    if (compressedSize > compressBufferSizes[thrIdx]) {
+        compressBufferSizes[thrIdx] = compressedSize * 1.5;
+        compressBuffers[thrIdx] = (char *) realloc(compressBuffers[thrIdx], compressBufferSizes[thrIdx]);
+        Util::checkAllocation(compressBuffers[thrIdx], "Could not allocate compression buffer");
+    }
+    int status = compress2((Bytef *) compressBuffers[thrIdx], &compressedSize,
+                           (const Bytef *) entry.data(), entry.size(), Z_BEST_SPEED);
+    if (status != Z_OK) {
+        Debug(Debug::ERROR) << "Could not compress entry for " << dataFileNames[thrIdx] << ". Error " << status << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    unsigned int header[2];
+    header[0] = entry.size();
+    header[1] = compressedSize;
+    writeToFile((const char *) header, sizeof(header), thrIdx, false);
+    writeToFile(compressBuffers[thrIdx], compressedSize, thrIdx, false);
+    offsets[thrIdx] += sizeof(header) + compressedSize;
+#endif
+}
+
+static double secondsSince(const struct timeval &start) {
+    struct timeval end;
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
+}
+
+void DBWriter::writeStreamEntry(unsigned int key, unsigned int thrIdx) {
+    const std::string &entry = entryBuffers[thrIdx];
+    size_t length = entry.size();
+    // frames of different threads must not interleave
+    pthread_mutex_lock(&streamMutex);
+    if (fwrite(&key, sizeof(unsigned int), 1, streamFile) != 1 || fwrite(&length, sizeof(size_t), 1, streamFile) != 1
+        || fwrite(entry.data(), sizeof(char), length, streamFile) != length) {
+        Debug(Debug::ERROR) << "Could not write to " << STREAM_STDOUT << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    pthread_mutex_unlock(&streamMutex);
+    threadBytesWritten[thrIdx] += sizeof(unsigned int) + sizeof(size_t) + length;
+}
+
+void DBWriter::writeToFile(const char *data, size_t size, unsigned int thrIdx, bool toIndex) {
+    threadBytesWritten[thrIdx] += size;
+    if ((mode & ASYNC_MODE) != 0) {
+        const unsigned int stream = 2 * thrIdx + (toIndex ? 1 : 0);
+        while (size > 0) {
+            if (asyncPending[stream] == NULL) {
+                asyncPending[stream] = acquireAsyncChunk(stream, thrIdx);
+                asyncPending[stream]->stream = stream;
+            }
+            AsyncChunk *chunk = asyncPending[stream];
+            const size_t space = ASYNC_CHUNK_SIZE - chunk->size;
+            const size_t length = (size < space) ? size : space;
+            memcpy(chunk->data + chunk->size, data, length);
+            chunk->size += length;
+            data += length;
+            size -= length;
+            if (chunk->size == ASYNC_CHUNK_SIZE) {
+                submitAsyncChunk(stream);
+            }
+        }
+        return;
+    }
+
+    FILE *file = toIndex ? indexFiles[thrIdx] : dataFiles[thrIdx];
+    if (fwrite(data, sizeof(char), size, file) != size) {
+        Debug(Debug::ERROR) << "Could not write to file " << (toIndex ? indexFileNames[thrIdx] : dataFileNames[thrIdx]) << "\n";
         EXIT(EXIT_FAILURE);
     }
 }
 
+DBWriter::AsyncChunk *DBWriter::acquireAsyncChunk(unsigned int stream, unsigned int thrIdx) {
+    pthread_mutex_lock(&asyncMutex);
+    // a stream has one chunk being filled and one being written, so a slow file
+    // cannot take up the buffers of the other streams
+    if (asyncInFlight[stream] >= ASYNC_CHUNKS_PER_STREAM) {
+        struct timeval start;
+        gettimeofday(&start, NULL);
+        while (asyncInFlight[stream] >= ASYNC_CHUNKS_PER_STREAM) {
+            pthread_cond_wait(&asyncHasFree, &asyncMutex);
+        }
+        threadStallTime[thrIdx] += secondsSince(start);
+    }
+    asyncInFlight[stream]++;
+
+    AsyncChunk *chunk;
+    if (asyncFree.empty()) {
+        chunk = new AsyncChunk;
+        chunk->data = (char *) malloc(ASYNC_CHUNK_SIZE);
+        Util::checkAllocation(chunk->data, "Could not allocate write buffer");
+    } else {
+        chunk = asyncFree.back();
+        asyncFree.pop_back();
+    }
+    pthread_mutex_unlock(&asyncMutex);
+
+    chunk->size = 0;
+    return chunk;
+}
+
+void DBWriter::submitAsyncChunk(unsigned int stream) {
+    pthread_mutex_lock(&asyncMutex);
+    asyncQueue.push_back(asyncPending[stream]);
+    asyncPending[stream] = NULL;
+    pthread_cond_signal(&asyncHasWork);
+    pthread_mutex_unlock(&asyncMutex);
+}
+
+void *DBWriter::asyncWriterLoop(void *arg) {
+    DBWriter *writer = (DBWriter *) arg;
+    pthread_mutex_lock(&writer->asyncMutex);
+    while (true) {
+        while (writer->asyncQueue.empty() && writer->asyncStop == false) {
+            pthread_cond_wait(&writer->asyncHasWork, &writer->asyncMutex);
+        }
+        if (writer->asyncQueue.empty()) {
+            break;
+        }
+        AsyncChunk *chunk = writer->asyncQueue.front();
+        writer->asyncQueue.pop_front();
+        pthread_mutex_unlock(&writer->asyncMutex);
+
+        // chunks of one stream are queued in order, a single writer keeps them in order
+        const unsigned int thrIdx = chunk->stream / 2;
+        const bool toIndex = (chunk->stream % 2) == 1;
+        FILE *file = toIndex ? writer->indexFiles[thrIdx] : writer->dataFiles[thrIdx];
+        if (fwrite(chunk->data, sizeof(char), chunk->size, file) != chunk->size) {
+            Debug(Debug::ERROR) << "Could not write to file "
+                                << (toIndex ? writer->indexFileNames[thrIdx] : writer->dataFileNames[thrIdx]) << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+
+        pthread_mutex_lock(&writer->asyncMutex);
+        writer->asyncInFlight[chunk->stream]--;
+        writer->asyncFree.push_back(chunk);
+        // the waiting threads can be waiting for different streams
+        pthread_cond_broadcast(&writer->asyncHasFree);
+    }
+    pthread_mutex_unlock(&writer->asyncMutex);
+    return NULL;
+}
+
+void DBWriter::startAsyncWriter() {
+    asyncPending = new AsyncChunk*[2 * threads];
+    std::fill(asyncPending, asyncPending + 2 * threads, (AsyncChunk *) NULL);
+    asyncInFlight = new size_t[2 * threads];
+    std::fill(asyncInFlight, asyncInFlight + 2 * threads, (size_t) 0);
+    asyncStop = false;
+    pthread_mutex_init(&asyncMutex, NULL);
+    pthread_cond_init(&asyncHasWork, NULL);
+    pthread_cond_init(&asyncHasFree, NULL);
+    if (pthread_create(&asyncThread, NULL, asyncWriterLoop, this) != 0) {
+        Debug(Debug::ERROR) << "Could not start writer thread for " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+}
+
+void DBWriter::stopAsyncWriter() {
+    for (unsigned int stream = 0; stream < 2 * threads; stream++) {
+        if (asyncPending[stream] != NULL && asyncPending[stream]->size > 0) {
+            submitAsyncChunk(stream);
+        }
+    }
+
+    pthread_mutex_lock(&asyncMutex);
+    asyncStop = true;
+    pthread_cond_signal(&asyncHasWork);
+    pthread_mutex_unlock(&asyncMutex);
+    pthread_join(asyncThread, NULL);
+
+    for (unsigned int stream = 0; stream < 2 * threads; stream++) {
+        if (asyncPending[stream] != NULL) {
+            asyncFree.push_back(asyncPending[stream]);
+        }
+    }
+    for (size_t i = 0; i < asyncFree.size(); i++) {
+        free(asyncFree[i]->data);
+        delete asyncFree[i];
+    }
+    asyncFree.clear();
+    delete[] asyncPending;
+    asyncPending = NULL;
+    delete[] asyncInFlight;
+    asyncInFlight = NULL;
+
+    pthread_cond_destroy(&asyncHasFree);
+    pthread_cond_destroy(&asyncHasWork);
+    pthread_mutex_destroy(&asyncMutex);
+}
+
 void DBWriter::writeData(const char *data, size_t dataSize, unsigned int key, unsigned int thrIdx, bool addNullByte) {
     writeStart(thrIdx);
     writeAdd(data, dataSize, thrIdx);
@@ -283,6 +628,10 @@ size_t DBWriter::indexToBuffer(char *buff1, unsigned int key, size_t offsetStart
 }
 
 void DBWriter::alignToPageSize() {
+    if (stream) {
+        // entries in a stream have no offsets
+        return;
+    }
     if (threads > 1) {
         Debug(Debug::ERROR) << "Data file can only be aligned in single threaded mode.\n";
         EXIT(EXIT_FAILURE);
@@ -293,11 +642,7 @@ void DBWriter::alignToPageSize() {
     size_t newOffset = ((pageSize - 1) & currentOffset) ? ((currentOffset + pageSize) & ~(pageSize - 1)) : currentOffset;
     char nullByte = '\0';
     for (size_t i = currentOffset; i < newOffset; ++i) {
-        size_t written = fwrite(&nullByte, sizeof(char), 1, dataFiles[0]);
-        if (written != 1) {
-            Debug(Debug::ERROR) << "Could not write to data file " << dataFileNames[0] << "\n";
-            EXIT(EXIT_FAILURE);
-        }
+        writeToFile(&nullByte, 1, 0, false);
     }
     offsets[0] = newOffset;
 }
@@ -366,6 +711,9 @@ void DBWriter::mergeResults(const char *outFileName, const char *outFileNameInde
                             const char **dataFileNames, const char **indexFileNames,
                             const unsigned long fileCount, const bool lexicographicOrder) {
     Timer timer;
+    // a binary index left over from an earlier run must never shadow the new text index
+    DBReader<unsigned int>::removeBinaryIndex(outFileNameIndex);
+
     // merge results from each thread into one result file
     if (fileCount > 1) {
         FILE *outFile = fopen(outFileName, "w");
@@ -416,11 +764,12 @@ void DBWriter::mergeResults(const char *outFileName, const char *outFileNameInde
                 size_t currOffset = index[reader.getSize()-1].offset;
                 index[reader.getSize()-1].offset = globalOffset + currOffset;
                 writeIndex(index_file, reader.getSize(), index, reader.getSeqLens());
-                globalOffset += threadDataFileSizes[fileIdx];
             }
+            // files without entries still hold the compressed data magic
+            globalOffset += threadDataFileSizes[fileIdx];
             reader.close();
 
-            if (std::remove(indexFileNames[fileIdx]) != 0) {
+            if (DBReader<unsigned int>::removeIndex(indexFileNames[fileIdx]) == false) {
                 Debug(Debug::WARNING) << "Could not remove file " << indexFileNames[fileIdx] << "\n";
             }
         }
@@ -435,8 +784,86 @@ void DBWriter::mergeResults(const char *outFileName, const char *outFileNameInde
             Debug(Debug::ERROR) << "Could not move result index " << indexFileNames[0] << " to final location " << outFileNameIndex << "!\n";
             EXIT(EXIT_FAILURE);
         }
+        // the binary index of the moved text index would be stale
+        DBReader<unsigned int>::removeBinaryIndex(indexFileNames[0]);
+    }
+
+    sortIndexFile(outFileNameIndex, lexicographicOrder);
+
+    Debug(Debug::INFO) << "Time for merging files: " << timer.lap() << "\n";
+}
+
+void DBWriter::writeShards() {
+    Timer timer;
+    DBReader<unsigned int>::removeBinaryIndex(indexFileName);
+
+    // every shard starts at a page aligned virtual offset so that DBReader can map it in place
+    const size_t pageSize = Util::getPageSize();
+    std::vector<size_t> shardOffsets;
+    std::vector<size_t> shardSizes;
+    size_t virtualOffset = 0;
+    for (unsigned int i = 0; i < threads; i++) {
+        size_t shardSize = FileUtil::getFileSize(dataFileNames[i]);
+        shardOffsets.push_back(virtualOffset);
+        shardSizes.push_back(shardSize);
+        virtualOffset += (shardSize + pageSize - 1) & ~(pageSize - 1);
     }
 
+    if (virtualOffset == 0) {
+        // nothing to map, a plain (empty) data file is all we need
+        mergeResults(dataFileName, indexFileName,
+                     (const char **) dataFileNames, (const char **) indexFileNames, threads, ((mode & LEXICOGRAPHIC_MODE) != 0));
+        return;
+    }
+
+    FILE *indexFile = fopen(indexFileName, "w");
+    if (indexFile == NULL) {
+        perror(indexFileName);
+        EXIT(EXIT_FAILURE);
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        DBReader<unsigned int> reader(dataFileNames[i], indexFileNames[i], DBReader<unsigned int>::USE_INDEX);
+        reader.open(DBReader<unsigned int>::HARDNOSORT);
+        DBReader<unsigned int>::Index *index = reader.getIndex();
+        for (size_t j = 0; j < reader.getSize(); j++) {
+            index[j].offset += shardOffsets[i];
+        }
+        writeIndex(indexFile, reader.getSize(), index, reader.getSeqLens());
+        reader.close();
+        if (DBReader<unsigned int>::removeIndex(indexFileNames[i]) == false) {
+            Debug(Debug::WARNING) << "Could not remove file " << indexFileNames[i] << "\n";
+        }
+    }
+    fclose(indexFile);
+
+    // shards are referenced by absolute path, so the list stays valid when it is moved
+    FILE *shardFile = fopen(dataFileName, "w");
+    if (shardFile == NULL) {
+        perror(dataFileName);
+        EXIT(EXIT_FAILURE);
+    }
+    bool ok = fwrite(DBReader<unsigned int>::SHARDED_DATA_MAGIC, sizeof(char),
+                     sizeof(DBReader<unsigned int>::SHARDED_DATA_MAGIC), shardFile) == sizeof(DBReader<unsigned int>::SHARDED_DATA_MAGIC);
+    for (unsigned int i = 0; i < threads; i++) {
+        char *path = realpath(dataFileNames[i], NULL);
+        if (path == NULL) {
+            Debug(Debug::ERROR) << "Could not get realpath of " << dataFileNames[i] << "!\n";
+            EXIT(EXIT_FAILURE);
+        }
+        ok = ok && fprintf(shardFile, "%zu\t%zu\t%s\n", shardOffsets[i], shardSizes[i], path) > 0;
+        free(path);
+    }
+    if (fclose(shardFile) != 0 || ok == false) {
+        Debug(Debug::ERROR) << "Could not write shard list " << dataFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    sortIndexFile(indexFileName, ((mode & LEXICOGRAPHIC_MODE) != 0));
+
+    Debug(Debug::INFO) << "Time for writing shard index: " << timer.lap() << "\n";
+}
+
+void DBWriter::sortIndexFile(const char *outFileNameIndex, bool lexicographicOrder) {
     if (lexicographicOrder == false) {
         // sort the index
         DBReader<unsigned int> indexReader(outFileNameIndex, outFileNameIndex, DBReader<unsigned int>::USE_INDEX);
@@ -445,6 +872,7 @@ void DBWriter::mergeResults(const char *outFileName, const char *outFileNameInde
         FILE *index_file  = fopen(outFileNameIndex, "w");
         writeIndex(index_file, indexReader.getSize(), index, indexReader.getSeqLens());
         fclose(index_file);
+        writeBinaryIndex(outFileNameIndex, indexReader.getSize(), index, indexReader.getSeqLens(), indexReader.getLastKey(), true);
         indexReader.close();
     } else {
         DBReader<std::string> indexReader(outFileNameIndex, outFileNameIndex, DBReader<std::string>::USE_INDEX);
@@ -455,11 +883,89 @@ void DBWriter::mergeResults(const char *outFileName, const char *outFileNameInde
         fclose(index_file);
         indexReader.close();
     }
+}
 
-    Debug(Debug::INFO) << "Time for merging files: " << timer.lap() << "\n";
+void DBWriter::writeBinaryIndex(const char *indexFileName, size_t indexSize,
+                                DBReader<unsigned int>::Index *index, unsigned int *seqLen, unsigned int lastKey,
+                                bool linesSortedById) {
+    struct stat sb;
+    if (stat(indexFileName, &sb) < 0) {
+        int errsv = errno;
+        Debug(Debug::ERROR) << "Failed to stat file " << indexFileName << ". Error " << errsv << ".\n";
+        EXIT(EXIT_FAILURE);
+    }
+
+    DBReader<unsigned int>::BinaryIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DBReader<unsigned int>::BINARY_INDEX_MAGIC, sizeof(header.magic));
+    header.size = indexSize;
+    header.lastKey = lastKey;
+    header.textIndexSize = sb.st_size;
+    header.textIndexMtime = sb.st_mtime;
+    header.textIndexMtimeNsec = DBReader<unsigned int>::getMtimeNsec(sb);
+    header.linesSortedById = linesSortedById;
+    for (size_t i = 0; i < indexSize; i++) {
+        header.aaDbSize += seqLen[i];
+    }
+
+    // write to a temporary file and rename, readers might still have the old binary index mapped
+    std::string binaryIndexFileName = DBReader<unsigned int>::getBinaryIndexFileName(indexFileName);
+    std::string tmpFileName = binaryIndexFileName + ".tmp";
+    FILE *outFile = fopen(tmpFileName.c_str(), "wb");
+    if (outFile == NULL) {
+        Debug(Debug::ERROR) << "Could not open " << tmpFileName << " for writing!\n";
+        EXIT(EXIT_FAILURE);
+    }
+    // copy entry by entry to avoid writing uninitialized struct padding
+    DBReader<unsigned int>::Index *buffer = new DBReader<unsigned int>::Index[4096];
+    memset(buffer, 0, 4096 * sizeof(DBReader<unsigned int>::Index));
+    bool ok = fwrite(&header, sizeof(header), 1, outFile) == 1;
+    for (size_t start = 0; ok && start < indexSize; start += 4096) {
+        size_t count = std::min(indexSize - start, (size_t) 4096);
+        for (size_t i = 0; i < count; i++) {
+            buffer[i].id = index[start + i].id;
+            buffer[i].offset = index[start + i].offset;
+        }
+        ok = fwrite(buffer, sizeof(DBReader<unsigned int>::Index), count, outFile) == count;
+    }
+    delete[] buffer;
+    ok = ok && fwrite(seqLen, sizeof(unsigned int), indexSize, outFile) == indexSize;
+    if (fclose(outFile) != 0 || ok == false) {
+        Debug(Debug::ERROR) << "Could not write binary index " << tmpFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
+    if (std::rename(tmpFileName.c_str(), binaryIndexFileName.c_str()) != 0) {
+        Debug(Debug::ERROR) << "Could not move binary index " << tmpFileName << " to " << binaryIndexFileName << "\n";
+        EXIT(EXIT_FAILURE);
+    }
 }
 
 void DBWriter::mergeFilePair(const std::vector<std::pair<std::string, std::string>> fileNames) {
+    if ((mode & (COMPRESSED_MODE | BINARY_MODE)) != 0) {
+        // entries can not be spliced byte by byte, go through DBReader instead
+        std::vector<DBReader<unsigned int>*> readers;
+        for (size_t i = 0; i < fileNames.size(); i++) {
+            DBReader<unsigned int> *reader = new DBReader<unsigned int>(fileNames[i].first.c_str(), fileNames[i].second.c_str());
+            reader->open(DBReader<unsigned int>::NOSORT);
+            readers.push_back(reader);
+        }
+        for (size_t id = 0; id < readers[0]->getSize(); id++) {
+            writeStart(0);
+            for (size_t i = 0; i < readers.size(); i++) {
+                const char *data = readers[i]->getData(id);
+                size_t length = readers[i]->getSeqLens(id);
+                writeAdd(data, (length == 0 ? 0 : length - 1), 0);
+            }
+            writeEnd(readers[0]->getDbKey(id), 0, true);
+        }
+        for (size_t i = 0; i < readers.size(); i++) {
+            readers[i]->close();
+            delete readers[i];
+        }
+        Debug(Debug::INFO) << "Merge file " << fileNames[0].first << " and " << fileNames[0].second << "\n";
+        return;
+    }
+
     FILE ** files = new FILE*[fileNames.size()];
     for (size_t i = 0; i < fileNames.size();i++) {
         files[i] = FileUtil::openFileOrDie(fileNames[i].first.c_str(), "r", true);
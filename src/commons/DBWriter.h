@@ -10,6 +10,8 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <pthread.h>
 #include "DBReader.h"
 
 template <typename T> class DBReader;
@@ -19,7 +21,19 @@ class DBWriter {
         static const size_t ASCII_MODE = 0;
         static const size_t BINARY_MODE = 1;
         static const size_t LEXICOGRAPHIC_MODE = 2;
+        // every entry is deflated on its own, DBReader inflates it on access
+        static const size_t COMPRESSED_MODE = 4;
+        // writes are staged per thread and flushed by a background writer thread
+        static const size_t ASYNC_MODE = 8;
+        // keeps the per-thread data files as shards instead of concatenating them on close
+        static const size_t SHARDED_MODE = 16;
 
+        // a data file named STREAM_STDOUT is written as framed entry stream to stdout instead of a database,
+        // see DBReader::STREAM_STDIN for the format. Entries are not compressed and appear in the order they are finished.
+        static const char STREAM_STDOUT[];
+
+        // moves stdout out of the way for the stream, log output that would go to stdout goes to stderr instead
+        static FILE *reserveStdout();
 
         DBWriter(const char* dataFileName, const char* indexFileName, unsigned int threads = 1, size_t mode = ASCII_MODE);
 
@@ -28,6 +42,11 @@ class DBWriter {
         void open(size_t bufferSize = 64 * 1024 * 1024);
 
         void close(int dbType = -1);
+
+        static void writeDbtypeFile(const char *dataFileName, int dbType);
+
+        // for outputs without a dbtype that might replace a database which had one
+        static void removeDbtypeFile(const char *dataFileName);
     
         char* getDataFileName() { return dataFileName; }
     
@@ -59,13 +78,52 @@ class DBWriter {
 
         void mergeFilePair(const std::vector<std::pair<std::string, std::string>> fileNames);
 
+        // writes the sorted index as <indexFileName>.bin next to the (already written) text index
+        static void writeBinaryIndex(const char *indexFileName, size_t indexSize,
+                                     DBReader<unsigned int>::Index *index, unsigned int *seqLen, unsigned int lastKey,
+                                     bool linesSortedById);
+
+        // bytes written to the data and index files, available after close
+        size_t getBytesWritten() { return bytesWritten; }
+
+        // seconds the writing threads waited for a full ASYNC_MODE queue, available after close
+        double getStallTime() { return stallTime; }
+
 
 private:
     template <typename T>
     static void writeIndex(FILE *outFile, size_t indexSize, T *index, unsigned int *seqLen);
 
+    static void sortIndexFile(const char *outFileNameIndex, bool lexicographicOrder);
+
+    void writeShards();
+
     void checkClosed();
 
+    void writeCompressedEntry(unsigned int thrIdx);
+
+    void writeStreamEntry(unsigned int key, unsigned int thrIdx);
+
+    // all writes to the per-thread data and index files go through here
+    void writeToFile(const char *data, size_t size, unsigned int thrIdx, bool toIndex);
+
+    struct AsyncChunk {
+        char *data;
+        size_t size;
+        unsigned int stream;
+    };
+
+    static const size_t ASYNC_CHUNK_SIZE = 1024 * 1024;
+
+    // chunks of one stream that are being filled or wait for the writer thread
+    static const size_t ASYNC_CHUNKS_PER_STREAM = 2;
+
+    AsyncChunk *acquireAsyncChunk(unsigned int stream, unsigned int thrIdx);
+    void submitAsyncChunk(unsigned int stream);
+    void startAsyncWriter();
+    void stopAsyncWriter();
+    static void *asyncWriterLoop(void *arg);
+
     char* dataFileName;
     char* indexFileName;
 
@@ -80,11 +138,36 @@ private:
     size_t* starts;
     size_t* offsets;
 
+    // uncompressed entry per thread in COMPRESSED_MODE and for streams, deflate output in COMPRESSED_MODE
+    std::string* entryBuffers;
+    char** compressBuffers;
+    size_t* compressBufferSizes;
+
     const unsigned int threads;
     const size_t mode;
 
+    size_t *threadBytesWritten;
+    double *threadStallTime;
+    size_t bytesWritten;
+    double stallTime;
+
+    // ASYNC_MODE: stream 2 * thread is the data file, stream 2 * thread + 1 the index file of a thread
+    AsyncChunk **asyncPending;
+    std::deque<AsyncChunk *> asyncQueue;
+    std::vector<AsyncChunk *> asyncFree;
+    size_t *asyncInFlight;
+    bool asyncStop;
+    pthread_t asyncThread;
+    pthread_mutex_t asyncMutex;
+    pthread_cond_t asyncHasWork;
+    pthread_cond_t asyncHasFree;
+
     bool closed;
 
+    bool stream;
+    FILE *streamFile;
+    pthread_mutex_t streamMutex;
+
     std::string datafileMode;
 
 
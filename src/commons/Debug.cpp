@@ -2,6 +2,7 @@
 
 
 int Debug::debugLevel = Debug::INFO;
+bool Debug::logToStderr = false;
 
 Debug::Debug( int level)
 {
@@ -12,6 +13,10 @@ void Debug::setDebugLevel (int i) {
     debugLevel = i;
 }
 
+void Debug::setLogToStderr(bool value) {
+    logToStderr = value;
+}
+
 void Debug::printProgress(size_t id){
     if (id % 1000000 == 0 && id > 0){
         Debug(INFO) << "\t" << (id / 1000000) << " Mio. sequences processed\n";
@@ -15,6 +15,9 @@ public:
 
     static int debugLevel;
 
+    // set while a database is streamed to stdout, INFO and WARNING go to stderr then
+    static bool logToStderr;
+
     explicit Debug( int level );
 
     template<typename T>
@@ -28,8 +31,9 @@ public:
         }
         else if(level > ERROR && level <= debugLevel)
         {
-            std::cout << t;
-            std::cout << std::flush;
+            std::ostream &out = logToStderr ? std::cerr : std::cout;
+            out << t;
+            out << std::flush;
             return *this;
         }
         else{
@@ -38,6 +42,8 @@ public:
     }
     static void setDebugLevel(int i);
 
+    static void setLogToStderr(bool value);
+
     static void printProgress(size_t id);
 
 private:
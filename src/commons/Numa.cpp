@@ -0,0 +1,169 @@
+#include "Numa.h"
+#include "Util.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+// from linux/mempolicy.h
+#define MMSEQS_MPOL_BIND        2
+#define MMSEQS_MPOL_INTERLEAVE  3
+#define MMSEQS_MPOL_MF_MOVE     (1 << 1)
+#define MMSEQS_MAX_NODES        1024
+
+std::vector<int> Numa::parseCpuList(const char *list) {
+    // format: 0-3,8,10-11
+    std::vector<int> cpus;
+    const char *p = list;
+    while (*p != '\0' && *p != '\n') {
+        char *end;
+        long from = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long to = from;
+        p = end;
+        if (*p == '-') {
+            to = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = from; cpu <= to; cpu++) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return cpus;
+}
+
+static bool readLine(const char *fileName, char *buffer, size_t bufferSize) {
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) {
+        return false;
+    }
+    bool success = fgets(buffer, bufferSize, file) != NULL;
+    fclose(file);
+    return success;
+}
+
+std::vector<std::vector<int> > Numa::getNodeCpus() {
+    std::vector<std::vector<int> > nodes;
+#ifdef __linux__
+    char buffer[4096];
+    if (readLine("/sys/devices/system/node/online", buffer, sizeof(buffer)) == false) {
+        return nodes;
+    }
+    std::vector<int> nodeIds = parseCpuList(buffer);
+    for (size_t i = 0; i < nodeIds.size(); i++) {
+        char fileName[128];
+        snprintf(fileName, sizeof(fileName), "/sys/devices/system/node/node%d/cpulist", nodeIds[i]);
+        if (nodeIds[i] != static_cast<int>(i) || readLine(fileName, buffer, sizeof(buffer)) == false) {
+            // node ids with gaps are not supported, treat the system as a single node
+            nodes.clear();
+            return nodes;
+        }
+        nodes.push_back(parseCpuList(buffer));
+    }
+#endif
+    return nodes;
+}
+
+size_t Numa::getNodeFreeMemory(int node) {
+    char fileName[128];
+    snprintf(fileName, sizeof(fileName), "/sys/devices/system/node/node%d/meminfo", node);
+    FILE *file = fopen(fileName, "r");
+    if (file == NULL) {
+        return 0;
+    }
+    // Node 0 MemFree:        12345678 kB
+    size_t freeMemory = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        const char *field = strstr(line, "MemFree:");
+        if (field != NULL) {
+            freeMemory = strtoull(field + strlen("MemFree:"), NULL, 10) * 1024;
+            break;
+        }
+    }
+    fclose(file);
+    return freeMemory;
+}
+
+bool Numa::getThreadAffinity(std::vector<int> &cpus) {
+    cpus.clear();
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return false;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Numa::setThreadAffinity(const std::vector<int> &cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE) {
+            CPU_SET(cpus[i], &set);
+        }
+    }
+    // pid 0 is the calling thread
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool Numa::setMemoryPolicy(void *memory, size_t size, int mode, const std::vector<int> &nodes) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (memory == NULL || size == 0) {
+        return false;
+    }
+    unsigned long mask[MMSEQS_MAX_NODES / (8 * sizeof(unsigned long))];
+    memset(mask, 0, sizeof(mask));
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i] < 0 || nodes[i] >= MMSEQS_MAX_NODES) {
+            return false;
+        }
+        mask[nodes[i] / (8 * sizeof(unsigned long))] |= 1UL << (nodes[i] % (8 * sizeof(unsigned long)));
+    }
+    // mbind needs a page aligned start, the pages sharing the range borders are included
+    size_t pageSize = Util::getPageSize();
+    size_t start = ((size_t) memory) & ~(pageSize - 1);
+    size_t length = ((size_t) memory) + size - start;
+    // the kernel expects the number of mask bits plus one
+    long result = syscall(SYS_mbind, start, length, mode, mask, MMSEQS_MAX_NODES + 1, MMSEQS_MPOL_MF_MOVE);
+    return result == 0;
+#else
+    return false;
+#endif
+}
+
+bool Numa::interleaveMemory(void *memory, size_t size, size_t nodeCount) {
+    std::vector<int> nodes;
+    for (size_t i = 0; i < nodeCount; i++) {
+        nodes.push_back(static_cast<int>(i));
+    }
+    return setMemoryPolicy(memory, size, MMSEQS_MPOL_INTERLEAVE, nodes);
+}
+
+bool Numa::bindMemory(void *memory, size_t size, int node) {
+    return setMemoryPolicy(memory, size, MMSEQS_MPOL_BIND, std::vector<int>(1, node));
+}
@@ -0,0 +1,41 @@
+#ifndef MMSEQS_NUMA_H
+#define MMSEQS_NUMA_H
+
+// NUMA topology and memory placement based on sysfs and the raw mbind syscall,
+// so libnuma is not needed. Without NUMA support getNodeCpus returns no nodes
+// and the other functions return false.
+
+#include <cstddef>
+#include <vector>
+
+class Numa {
+public:
+    static const int MODE_OFF = 0;
+    // pages of the index are interleaved over all nodes and threads are pinned to nodes
+    static const int MODE_INTERLEAVE = 1;
+    // every node gets its own copy of the index, falls back to MODE_INTERLEAVE without enough memory
+    static const int MODE_REPLICATE = 2;
+
+    // cpus of every online node
+    static std::vector<std::vector<int> > getNodeCpus();
+
+    // free memory in bytes as reported by the node meminfo, 0 if unknown
+    static size_t getNodeFreeMemory(int node);
+
+    static bool getThreadAffinity(std::vector<int> &cpus);
+
+    static bool setThreadAffinity(const std::vector<int> &cpus);
+
+    // pages of the range are spread round robin over the nodes, already touched pages are migrated
+    static bool interleaveMemory(void *memory, size_t size, size_t nodeCount);
+
+    // pages of the range are allocated on the node, has to be called before the memory is touched
+    static bool bindMemory(void *memory, size_t size, int node);
+
+private:
+    static std::vector<int> parseCpuList(const char *list);
+
+    static bool setMemoryPolicy(void *memory, size_t size, int mode, const std::vector<int> &nodes);
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include "Util.h"
 #include "DistanceCalculator.h"
 #include "Debug.h"
+#include "DBReader.h"
+#include "DBWriter.h"
 
 #include <iomanip>
 #include <regex.h>
@@ -48,6 +50,17 @@ Parameters::Parameters():
         PARAM_RES_LIST_OFFSET(PARAM_RES_LIST_OFFSET_ID,"--offset-result", "Offset result","Offset result list",typeid(int), (void *) &resListOffset, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_EXPERT),
         PARAM_NO_PRELOAD(PARAM_NO_PRELOAD_ID, "--no-preload", "No preload", "Do not preload database", typeid(bool), (void*) &noPreload, "", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
         PARAM_EARLY_EXIT(PARAM_EARLY_EXIT_ID, "--early-exit", "Early exit", "Exit immediately after writing the result", typeid(bool), (void*) &earlyExit, "", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_COMPRESSED(PARAM_COMPRESSED_ID, "--compressed", "Compressed", "Write compressed data files (every entry is compressed separately)", typeid(bool), (void*) &compressed, "", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_ASYNC_WRITE(PARAM_ASYNC_WRITE_ID, "--async-write", "Async write", "Hand results to a background writer thread instead of blocking the compute threads on I/O", typeid(bool), (void*) &asyncWrite, "", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_SHARDED_OUTPUT(PARAM_SHARDED_OUTPUT_ID, "--sharded-output", "Sharded output", "Skip merging the per-thread result files, the result only lists them as shards (they have to be kept)", typeid(bool), (void*) &shardedOutput, "", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_BINARY_OUTPUT(PARAM_BINARY_OUTPUT_ID, "--binary-output", "Binary output", "Write results as binary records instead of text", typeid(bool), (void*) &binaryOutput, "", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_DB_LOAD_MODE(PARAM_DB_LOAD_MODE_ID, "--db-load-mode", "Database load mode", "0: mmap, pages are read on access; 1: mmap and touch all pages in parallel; 2: read into transparent hugepage memory; 3: pread entries on access through a 256 MB block cache per database (network file systems)", typeid(int), (void*) &dbLoadMode, "^[0-3]{1}$", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_NUMA_MODE(PARAM_NUMA_MODE_ID, "--numa-mode", "NUMA mode", "0: off; 1: interleave the index table over all NUMA nodes and pin threads to nodes; 2: copy the index table to every node (falls back to 1 without enough memory)", typeid(int), (void*) &numaMode, "^[0-2]{1}$", MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_COMPRESS_INDEX(PARAM_COMPRESS_INDEX_ID, "--compress-index", "Compress index", "Store the k-mer lists of the index table delta encoded and bit packed, needs less memory at some decoding cost", typeid(bool), (void*) &compressIndex, "", MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_PIPELINE_SPLITS(PARAM_PIPELINE_SPLITS_ID, "--pipeline-splits", "Pipeline target splits", "Build the index table of the next target split in the background while the current split is matched (needs memory for two index tables)", typeid(bool), (void*) &pipelineSplits, "", MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_SHARED_INDEX(PARAM_SHARED_INDEX_ID, "--shared-index", "Shared index", "Publish the index table built at runtime in POSIX shared memory, other processes with the same target and settings attach to it instead of building their own", typeid(bool), (void*) &sharedIndex, "", MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_QUERY_STATS(PARAM_QUERY_STATS_ID, "--query-stats", "Query statistics", "Write the k-mer list length, matched entries, diagonal bins, ungapped alignments, overflows and phase times of every query to <resultDB>_stats (see prefilterstats)", typeid(bool), (void*) &queryStats, "", MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_EXPERT),
+        PARAM_CHECKPOINT_CHUNKS(PARAM_CHECKPOINT_CHUNKS_ID, "--checkpoint-chunks", "Checkpoint chunks", "0: off; otherwise splits and at least this many query chunks are committed to <resultDB>.checkpoint one by one and a restarted run resumes from the finished ones", typeid(int), (void*) &checkpointChunks, "^[0-9]{1}[0-9]*$", MMseqsParameter::COMMAND_MISC|MMseqsParameter::COMMAND_EXPERT),
         // alignment
         PARAM_ALIGNMENT_MODE(PARAM_ALIGNMENT_MODE_ID,"--alignment-mode", "Alignment mode", "What to compute: 0: automatic; 1: score+end_pos; 2:+start_pos+cov; 3: +seq.id",typeid(int), (void *) &alignmentMode, "^[0-4]{1}$", MMseqsParameter::COMMAND_ALIGN|MMseqsParameter::COMMAND_EXPERT),
         PARAM_E(PARAM_E_ID,"-e", "E-value threshold", "list matches below this E-value [0.0, inf]",typeid(float), (void *) &evalThr, "^([-+]?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?)|[0-9]*(\\.[0-9]+)?$", MMseqsParameter::COMMAND_ALIGN),
@@ -129,6 +142,7 @@ Parameters::Parameters():
         PARAM_NUM_ITERATIONS(PARAM_NUM_ITERATIONS_ID, "--num-iterations", "Number search iterations","Search iterations",typeid(int),(void *) &numIterations, "^[1-9]{1}[0-9]*$", MMseqsParameter::COMMAND_PROFILE),
         PARAM_START_SENS(PARAM_START_SENS_ID, "--start-sens", "Start sensitivity","start sensitivity",typeid(float),(void *) &startSens, "^[0-9]*(\\.[0-9]+)?$"),
         PARAM_SENS_STEPS(PARAM_SENS_STEPS_ID, "--sens-steps", "Search steps","Search steps performed from --start-sense and -s.",typeid(int),(void *) &sensSteps, "^[1-9]{1}$"),
+        PARAM_FUSED_SEARCH(PARAM_FUSED_SEARCH_ID, "--fused-search", "Fused search", "align the prefilter hits of every query right away instead of writing a prefilter database (not for iterative or target profile searches)", typeid(bool), (void *) &fusedSearch, "", MMseqsParameter::COMMAND_EXPERT),
         // easysearch
         PARAM_GREEDY_BEST_HITS(PARAM_GREEDY_BEST_HITS_ID, "--greedy-best-hits", "Greedy best hits", "Choose the best hits greedily to cover the query.", typeid(bool), (void*)&greedyBestHits, ""),
         // Orfs
@@ -224,10 +238,16 @@ Parameters::Parameters():
     align.push_back(PARAM_INCLUDE_IDENTITY);
     align.push_back(PARAM_NO_PRELOAD);
     align.push_back(PARAM_EARLY_EXIT);
+    align.push_back(PARAM_COMPRESSED);
+    align.push_back(PARAM_ASYNC_WRITE);
+    align.push_back(PARAM_SHARDED_OUTPUT);
+    align.push_back(PARAM_BINARY_OUTPUT);
     align.push_back(PARAM_PCA);
     align.push_back(PARAM_PCB);
     align.push_back(PARAM_SCORE_BIAS);
     align.push_back(PARAM_THREADS);
+    align.push_back(PARAM_DB_LOAD_MODE);
+    align.push_back(PARAM_CHECKPOINT_CHUNKS);
     align.push_back(PARAM_V);
 
     // prefilter
@@ -253,13 +273,25 @@ Parameters::Parameters():
     prefilter.push_back(PARAM_SPACED_KMER_MODE);
     prefilter.push_back(PARAM_NO_PRELOAD);
     prefilter.push_back(PARAM_EARLY_EXIT);
+    prefilter.push_back(PARAM_COMPRESSED);
+    prefilter.push_back(PARAM_ASYNC_WRITE);
+    prefilter.push_back(PARAM_SHARDED_OUTPUT);
+    prefilter.push_back(PARAM_BINARY_OUTPUT);
+    prefilter.push_back(PARAM_NUMA_MODE);
+    prefilter.push_back(PARAM_COMPRESS_INDEX);
+    prefilter.push_back(PARAM_PIPELINE_SPLITS);
+    prefilter.push_back(PARAM_SHARED_INDEX);
+    prefilter.push_back(PARAM_QUERY_STATS);
+    prefilter.push_back(PARAM_CHECKPOINT_CHUNKS);
     prefilter.push_back(PARAM_PCA);
     prefilter.push_back(PARAM_PCB);
     prefilter.push_back(PARAM_THREADS);
+    prefilter.push_back(PARAM_DB_LOAD_MODE);
     prefilter.push_back(PARAM_V);
 
     // clustering
     clust.push_back(PARAM_CLUSTER_MODE);
+    clust.push_back(PARAM_DB_LOAD_MODE);
     clust.push_back(PARAM_V);
     clust.push_back(PARAM_MAXITERATIONS);
     clust.push_back(PARAM_SIMILARITYSCORE);
@@ -270,6 +302,7 @@ Parameters::Parameters():
     mergeclusters.push_back(PARAM_BY_DB) ;
 
     // find orf
+    onlyverbosity.push_back(PARAM_DB_LOAD_MODE);
     onlyverbosity.push_back(PARAM_V);
 
     // rescorediagonal
@@ -284,6 +317,7 @@ Parameters::Parameters():
     rescorediagonal.push_back(PARAM_SEQ_ID_MODE);
     rescorediagonal.push_back(PARAM_INCLUDE_IDENTITY);
     rescorediagonal.push_back(PARAM_THREADS);
+    rescorediagonal.push_back(PARAM_DB_LOAD_MODE);
     rescorediagonal.push_back(PARAM_V);
 
     // alignbykmer
@@ -297,12 +331,14 @@ Parameters::Parameters():
     alignbykmer.push_back(PARAM_MIN_SEQ_ID);
     alignbykmer.push_back(PARAM_INCLUDE_IDENTITY);
     alignbykmer.push_back(PARAM_THREADS);
+    alignbykmer.push_back(PARAM_DB_LOAD_MODE);
     alignbykmer.push_back(PARAM_V);
 
     // convertprofiledb
     convertprofiledb.push_back(PARAM_SUB_MAT);
     convertprofiledb.push_back(PARAM_PROFILE_TYPE);
     convertprofiledb.push_back(PARAM_THREADS);
+    convertprofiledb.push_back(PARAM_DB_LOAD_MODE);
     convertprofiledb.push_back(PARAM_V);
 
 
@@ -313,9 +349,11 @@ Parameters::Parameters():
     sequence2profile.push_back(PARAM_TAU);
     sequence2profile.push_back(PARAM_THREADS);
     sequence2profile.push_back(PARAM_SUB_MAT);
+    sequence2profile.push_back(PARAM_DB_LOAD_MODE);
     sequence2profile.push_back(PARAM_V);
 
     // create fasta
+    createFasta.push_back(PARAM_DB_LOAD_MODE);
     createFasta.push_back(PARAM_V);
 
     // result2profile
@@ -336,7 +374,9 @@ Parameters::Parameters():
     result2profile.push_back(PARAM_OMIT_CONSENSUS);
     result2profile.push_back(PARAM_NO_PRELOAD);
     result2profile.push_back(PARAM_EARLY_EXIT);
+    result2profile.push_back(PARAM_ASYNC_WRITE);
     result2profile.push_back(PARAM_THREADS);
+    result2profile.push_back(PARAM_DB_LOAD_MODE);
     result2profile.push_back(PARAM_V);
 
     // result2pp
@@ -356,6 +396,7 @@ Parameters::Parameters():
     result2pp.push_back(PARAM_NO_PRELOAD);
     result2pp.push_back(PARAM_EARLY_EXIT);
     result2pp.push_back(PARAM_THREADS);
+    result2pp.push_back(PARAM_DB_LOAD_MODE);
     result2pp.push_back(PARAM_V);
     
     
@@ -365,11 +406,13 @@ Parameters::Parameters():
     createtsv.push_back(PARAM_FULL_HEADER);
     createtsv.push_back(PARAM_DB_OUTPUT);
     createtsv.push_back(PARAM_THREADS);
+    createtsv.push_back(PARAM_DB_LOAD_MODE);
     createtsv.push_back(PARAM_V);
 
     //result2stats
     result2stats.push_back(PARAM_STAT);
     result2stats.push_back(PARAM_THREADS);
+    result2stats.push_back(PARAM_DB_LOAD_MODE);
     result2stats.push_back(PARAM_V);
 
     // format alignment
@@ -378,6 +421,7 @@ Parameters::Parameters():
     convertalignments.push_back(PARAM_EARLY_EXIT);
     convertalignments.push_back(PARAM_DB_OUTPUT);
     convertalignments.push_back(PARAM_THREADS);
+    convertalignments.push_back(PARAM_DB_LOAD_MODE);
     convertalignments.push_back(PARAM_V);
 
     // result2msa
@@ -393,6 +437,7 @@ Parameters::Parameters():
     result2msa.push_back(PARAM_FILTER_COV);
     result2msa.push_back(PARAM_FILTER_NDIFF);
     result2msa.push_back(PARAM_THREADS);
+    result2msa.push_back(PARAM_DB_LOAD_MODE);
     result2msa.push_back(PARAM_V);
     result2msa.push_back(PARAM_COMPRESS_MSA);
     result2msa.push_back(PARAM_SUMMARIZE_HEADER);
@@ -404,6 +449,7 @@ Parameters::Parameters():
 
     // convertmsa
     convertmsa.push_back(PARAM_IDENTIFIER_FIELD);
+    convertmsa.push_back(PARAM_DB_LOAD_MODE);
     convertmsa.push_back(PARAM_V);
 
     // msa2profile
@@ -422,6 +468,7 @@ Parameters::Parameters():
     msa2profile.push_back(PARAM_FILTER_MAX_SEQ_ID);
     msa2profile.push_back(PARAM_FILTER_NDIFF);
     msa2profile.push_back(PARAM_THREADS);
+    msa2profile.push_back(PARAM_DB_LOAD_MODE);
     msa2profile.push_back(PARAM_V);
 
     //mergeclusters
@@ -432,12 +479,14 @@ Parameters::Parameters():
     profile2pssm.push_back(PARAM_NO_COMP_BIAS_CORR);
     profile2pssm.push_back(PARAM_DB_OUTPUT);
     profile2pssm.push_back(PARAM_THREADS);
+    profile2pssm.push_back(PARAM_DB_LOAD_MODE);
     profile2pssm.push_back(PARAM_V);
 
     // profile2cs
     profile2cs.push_back(PARAM_SUB_MAT);
 //    profile2cs.push_back(PARAM_ALPH_SIZE);
     profile2cs.push_back(PARAM_THREADS);
+    profile2cs.push_back(PARAM_DB_LOAD_MODE);
     profile2cs.push_back(PARAM_V);
 
     // extract orf
@@ -471,32 +520,40 @@ Parameters::Parameters():
     indexdb.push_back(PARAM_INCLUDE_HEADER);
     indexdb.push_back(PARAM_SPLIT);
     indexdb.push_back(PARAM_SPLIT_MEMORY_LIMIT);
+    indexdb.push_back(PARAM_COMPRESS_INDEX);
     indexdb.push_back(PARAM_THREADS);
+    indexdb.push_back(PARAM_DB_LOAD_MODE);
     indexdb.push_back(PARAM_V);
 
     // create db
     createdb.push_back(PARAM_MAX_SEQ_LEN);
     createdb.push_back(PARAM_DONT_SPLIT_SEQ_BY_LEN);
     createdb.push_back(PARAM_ID_OFFSET);
+    createdb.push_back(PARAM_COMPRESSED);
+    createdb.push_back(PARAM_DB_LOAD_MODE);
     createdb.push_back(PARAM_V);
 
     // convert2fasta
     convert2fasta.push_back(PARAM_USE_HEADER_FILE);
+    convert2fasta.push_back(PARAM_DB_LOAD_MODE);
     convert2fasta.push_back(PARAM_V);
 
     // result2flat
     result2flat.push_back(PARAM_USE_HEADER);
+    result2flat.push_back(PARAM_DB_LOAD_MODE);
     result2flat.push_back(PARAM_V);
 
     // gff2db
     gff2ffindex.push_back(PARAM_GFF_TYPE);
     gff2ffindex.push_back(PARAM_ID_OFFSET);
+    gff2ffindex.push_back(PARAM_DB_LOAD_MODE);
     gff2ffindex.push_back(PARAM_V);
 
 
     // translate nucleotide
     translatenucs.push_back(PARAM_TRANSLATION_TABLE);
     translatenucs.push_back(PARAM_ADD_ORF_STOP);
+    translatenucs.push_back(PARAM_DB_LOAD_MODE);
     translatenucs.push_back(PARAM_V);
     translatenucs.push_back(PARAM_THREADS);
 
@@ -505,6 +562,7 @@ Parameters::Parameters():
     createseqfiledb.push_back(PARAM_MAX_SEQUENCES);
     createseqfiledb.push_back(PARAM_HH_FORMAT);
     createseqfiledb.push_back(PARAM_THREADS);
+    createseqfiledb.push_back(PARAM_DB_LOAD_MODE);
     createseqfiledb.push_back(PARAM_V);
 
     // filterDb
@@ -516,6 +574,7 @@ Parameters::Parameters():
     filterDb.push_back(PARAM_BEATS_FIRST);
     filterDb.push_back(PARAM_MAPPING_FILE);
     filterDb.push_back(PARAM_THREADS);
+    filterDb.push_back(PARAM_DB_LOAD_MODE);
     filterDb.push_back(PARAM_V);
     filterDb.push_back(PARAM_TRIM_TO_ONE_COL);
     filterDb.push_back(PARAM_EXTRACT_LINES);
@@ -534,6 +593,7 @@ Parameters::Parameters():
     aggregate.push_back(PARAM_ALPHA) ;
     aggregate.push_back(PARAM_SIMPLE_BEST_HIT_MODE);
     onlythreads.push_back(PARAM_THREADS);
+    onlythreads.push_back(PARAM_DB_LOAD_MODE);
     onlythreads.push_back(PARAM_V);
 
     // swap results
@@ -541,16 +601,19 @@ Parameters::Parameters():
     swapresult.push_back(PARAM_E);
     swapresult.push_back(PARAM_SPLIT_MEMORY_LIMIT);
     swapresult.push_back(PARAM_THREADS);
+    swapresult.push_back(PARAM_DB_LOAD_MODE);
     swapresult.push_back(PARAM_V);
 
     // swap results
     swapdb.push_back(PARAM_SPLIT_MEMORY_LIMIT);
     swapdb.push_back(PARAM_THREADS);
+    swapdb.push_back(PARAM_DB_LOAD_MODE);
     swapdb.push_back(PARAM_V);
 
     // subtractdbs
     subtractdbs.push_back(PARAM_THREADS);
     subtractdbs.push_back(PARAM_E_PROFILE);
+    subtractdbs.push_back(PARAM_DB_LOAD_MODE);
     subtractdbs.push_back(PARAM_V);
 
     // clusthash
@@ -559,6 +622,7 @@ Parameters::Parameters():
     clusthash.push_back(PARAM_MIN_SEQ_ID);
     clusthash.push_back(PARAM_MAX_SEQ_LEN);
     clusthash.push_back(PARAM_THREADS);
+    clusthash.push_back(PARAM_DB_LOAD_MODE);
     clusthash.push_back(PARAM_V);
 
     // kmermatcher
@@ -576,23 +640,27 @@ Parameters::Parameters():
     kmermatcher.push_back(PARAM_INCLUDE_ONLY_EXTENDABLE);
     kmermatcher.push_back(PARAM_SKIP_N_REPEAT_KMER);
     kmermatcher.push_back(PARAM_THREADS);
+    kmermatcher.push_back(PARAM_DB_LOAD_MODE);
     kmermatcher.push_back(PARAM_V);
 
 
     // mergedbs
     mergedbs.push_back(PARAM_BY_DB);
     mergedbs.push_back(PARAM_MERGE_PREFIXES);
+    mergedbs.push_back(PARAM_DB_LOAD_MODE);
     mergedbs.push_back(PARAM_V);
 
     // summarize
     summarizeheaders.push_back(PARAM_SUMMARY_PREFIX);
     summarizeheaders.push_back(PARAM_HEADER_TYPE);
     summarizeheaders.push_back(PARAM_THREADS);
+    summarizeheaders.push_back(PARAM_DB_LOAD_MODE);
     summarizeheaders.push_back(PARAM_V);
 
     // diff
     diff.push_back(PARAM_USESEQID);
     diff.push_back(PARAM_THREADS);
+    diff.push_back(PARAM_DB_LOAD_MODE);
     diff.push_back(PARAM_V);
 
     // prefixid
@@ -600,6 +668,7 @@ Parameters::Parameters():
     prefixid.push_back(PARAM_MAPPING_FILE);
     prefixid.push_back(PARAM_TSV);
     prefixid.push_back(PARAM_THREADS);
+    prefixid.push_back(PARAM_DB_LOAD_MODE);
     prefixid.push_back(PARAM_V);
 
     // summarizeresult
@@ -608,6 +677,7 @@ Parameters::Parameters():
     summarizeresult.push_back(PARAM_E);
     summarizeresult.push_back(PARAM_C);
     summarizeresult.push_back(PARAM_THREADS);
+    summarizeresult.push_back(PARAM_DB_LOAD_MODE);
     summarizeresult.push_back(PARAM_V);
 
     // summarizetabs
@@ -615,6 +685,7 @@ Parameters::Parameters():
     summarizetabs.push_back(PARAM_E);
     summarizetabs.push_back(PARAM_C);
     summarizetabs.push_back(PARAM_THREADS);
+    summarizetabs.push_back(PARAM_DB_LOAD_MODE);
     summarizetabs.push_back(PARAM_V);
 
     // annoate
@@ -623,29 +694,37 @@ Parameters::Parameters():
     extractdomains.push_back(PARAM_E);
     extractdomains.push_back(PARAM_C);
     extractdomains.push_back(PARAM_THREADS);
+    extractdomains.push_back(PARAM_DB_LOAD_MODE);
     extractdomains.push_back(PARAM_V);
 
     // concatdbs
     concatdbs.push_back(PARAM_PRESERVEKEYS);
     concatdbs.push_back(PARAM_THREADS);
+    concatdbs.push_back(PARAM_DB_LOAD_MODE);
     concatdbs.push_back(PARAM_V);
 
     // extractalignedregion
     extractalignedregion.push_back(PARAM_EXTRACT_MODE);
     extractalignedregion.push_back(PARAM_THREADS);
+    extractalignedregion.push_back(PARAM_DB_LOAD_MODE);
     extractalignedregion.push_back(PARAM_V);
 
     // convertkb
     convertkb.push_back(PARAM_MAPPING_FILE);
     convertkb.push_back(PARAM_KB_COLUMNS);
+    convertkb.push_back(PARAM_DB_LOAD_MODE);
     convertkb.push_back(PARAM_V);
 
     // lca
     lca.push_back(PARAM_LCA_RANKS);
     lca.push_back(PARAM_BLACKLIST);
+    lca.push_back(PARAM_DB_LOAD_MODE);
     lca.push_back(PARAM_V);
     lca.push_back(PARAM_THREADS);
 
+    // prefilteralign
+    prefilteralign = combineList(prefilter, align);
+
     // WORKFLOWS
     searchworkflow = combineList(align, prefilter);
     searchworkflow = combineList(searchworkflow, result2profile);
@@ -654,6 +733,7 @@ Parameters::Parameters():
     searchworkflow.push_back(PARAM_NUM_ITERATIONS);
     searchworkflow.push_back(PARAM_START_SENS);
     searchworkflow.push_back(PARAM_SENS_STEPS);
+    searchworkflow.push_back(PARAM_FUSED_SEARCH);
     searchworkflow.push_back(PARAM_RUNNER);
     searchworkflow.push_back(PARAM_REMOVE_TMP_FILES);
 
@@ -971,6 +1051,19 @@ void Parameters::parseParameters(int argc, const char* pargv[],
     if (MMseqsMPI::isMaster()) {
         Debug::setDebugLevel(verbosity);
     }
+    DBReader<unsigned int>::setDefaultLoadMode(dbLoadMode);
+    DBReader<std::string>::setDefaultLoadMode(dbLoadMode);
+    // before the parameters are printed, so that the stream is the only output on stdout
+    // stdout itself is only taken over once a writer opens the stream, workflows pass it on to their steps
+    // through MMSEQS_STREAM_STDOUT and the last step streams the result
+    bool streamStdout = getenv("MMSEQS_STREAM_STDOUT") != NULL;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        streamStdout |= (filenames[i] == DBWriter::STREAM_STDOUT);
+    }
+    if (streamStdout) {
+        Debug::setLogToStderr(true);
+        setenv("MMSEQS_STREAM_STDOUT", "1", true);
+    }
 
 #ifdef OPENMP
     omp_set_num_threads(threads);
@@ -1120,6 +1213,7 @@ void Parameters::setDefaults() {
     numIterations = 1;
     startSens = 4;
     sensSteps = 1;
+    fusedSearch = false;
 
     greedyBestHits = false;
 
@@ -1155,6 +1249,17 @@ void Parameters::setDefaults() {
     clusterSteps = 3;
     resListOffset = 0;
     noPreload = false;
+    compressed = false;
+    asyncWrite = false;
+    shardedOutput = false;
+    binaryOutput = false;
+    dbLoadMode = 0;
+    numaMode = 0;
+    compressIndex = false;
+    pipelineSplits = false;
+    sharedIndex = false;
+    queryStats = false;
+    checkpointChunks = 0;
     earlyExit = false;
     scoreBias = 0.0;
 
@@ -1371,7 +1476,7 @@ size_t Parameters::hashParameter(const std::vector<std::string> &filenames, cons
     return Util::hash(hashString.c_str(), hashString.size());
 }
 
-std::string Parameters::createParameterString(const std::vector<MMseqsParameter> &par, bool wasSet) {
+std::string Parameters::createParameterString(const std::vector<MMseqsParameter> &par, bool wasSet) const {
     std::ostringstream ss;
     for (size_t i = 0; i < par.size(); ++i) {
         // Never pass the MPI parameters along, they are passed by the environment
@@ -199,6 +199,17 @@ public:
     size_t resListOffset;                // Offsets result list
     bool   noPreload;                    // Do not preload database into memory
     bool   earlyExit;                    // Exit immediately after writing the result
+    bool   compressed;                   // Write compressed data files
+    bool   asyncWrite;                   // Write results from a background thread
+    bool   shardedOutput;                // Keep per-thread result files instead of merging them
+    bool   binaryOutput;                 // Write results as binary records
+    int    dbLoadMode;                   // How database data files are brought into memory
+    int    numaMode;                     // Placement of the prefilter index on NUMA nodes
+    bool   compressIndex;                // Bit packed k-mer lists in the index table
+    bool   pipelineSplits;               // Build the index table of the next target split while matching
+    bool   sharedIndex;                  // Share the index table built at runtime between processes
+    bool   queryStats;                   // Write per query prefilter counters and phase times
+    int    checkpointChunks;             // Commit results in chunks and resume from the finished ones
     float  scoreBias;			 // Add this bias to the score when computing the alignements
 
     // ALIGNMENT
@@ -228,6 +239,7 @@ public:
     int numIterations;
     float startSens;
     int sensSteps;
+    bool fusedSearch;
 
     // easysearch
     bool greedyBestHits;
@@ -445,6 +457,17 @@ public:
     PARAMETER(PARAM_RES_LIST_OFFSET)
     PARAMETER(PARAM_NO_PRELOAD)
     PARAMETER(PARAM_EARLY_EXIT)
+    PARAMETER(PARAM_COMPRESSED)
+    PARAMETER(PARAM_ASYNC_WRITE)
+    PARAMETER(PARAM_SHARDED_OUTPUT)
+    PARAMETER(PARAM_BINARY_OUTPUT)
+    PARAMETER(PARAM_DB_LOAD_MODE)
+    PARAMETER(PARAM_NUMA_MODE)
+    PARAMETER(PARAM_COMPRESS_INDEX)
+    PARAMETER(PARAM_PIPELINE_SPLITS)
+    PARAMETER(PARAM_SHARED_INDEX)
+    PARAMETER(PARAM_QUERY_STATS)
+    PARAMETER(PARAM_CHECKPOINT_CHUNKS)
     std::vector<MMseqsParameter> prefilter;
 
     // alignment
@@ -544,6 +567,7 @@ public:
     PARAMETER(PARAM_NUM_ITERATIONS)
     PARAMETER(PARAM_START_SENS)
     PARAMETER(PARAM_SENS_STEPS)
+    PARAMETER(PARAM_FUSED_SEARCH)
 
     // easysearch
     PARAMETER(PARAM_GREEDY_BEST_HITS)
@@ -673,6 +697,7 @@ public:
     std::vector<MMseqsParameter> assemblerworkflow;
     std::vector<MMseqsParameter> easysearchworkflow;
     std::vector<MMseqsParameter> searchworkflow;
+    std::vector<MMseqsParameter> prefilteralign;
     std::vector<MMseqsParameter> clusteringWorkflow;
     std::vector<MMseqsParameter> clusterUpdateSearch;
     std::vector<MMseqsParameter> clusterUpdateClust;
@@ -707,7 +732,7 @@ public:
 
     size_t hashParameter(const std::vector<std::string> &filenames, const std::vector<MMseqsParameter> &par);
 
-    std::string createParameterString(const std::vector<MMseqsParameter> &vector, bool wasSet = false);
+    std::string createParameterString(const std::vector<MMseqsParameter> &vector, bool wasSet = false) const;
 
     void overrideParameterDescription(Command& command, int uid, const char* description, const char* regex = NULL, int category = 0);
 
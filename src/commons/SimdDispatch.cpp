@@ -0,0 +1,41 @@
+#include "SimdDispatch.h"
+#include "CpuInfo.h"
+#include "Debug.h"
+
+static SimdDispatch::Level detectLevel() {
+    SimdDispatch::Level level = SimdDispatch::LEVEL_DEFAULT;
+#if defined(SIMD_DISPATCH_AVX2) || defined(SIMD_DISPATCH_AVX512BW)
+    CpuInfo info;
+#endif
+#ifdef SIMD_DISPATCH_AVX2
+    if (info.HW_AVX2 && info.HW_OS_AVX) {
+        level = SimdDispatch::LEVEL_AVX2;
+    }
+#endif
+#ifdef SIMD_DISPATCH_AVX512BW
+    if (info.HW_AVX2 && info.HW_AVX512F && info.HW_AVX512BW && info.HW_OS_AVX512) {
+        level = SimdDispatch::LEVEL_AVX512BW;
+    }
+#endif
+    Debug(Debug::INFO) << "Using " << SimdDispatch::getLevelName(level) << " kernels\n";
+    return level;
+}
+
+SimdDispatch::Level SimdDispatch::getLevel() {
+    static const Level level = detectLevel();
+    return level;
+}
+
+const char *SimdDispatch::getLevelName(Level level) {
+    if (level == LEVEL_AVX512BW) {
+        return "AVX-512BW";
+    }
+    if (level == LEVEL_AVX2) {
+        return "AVX2";
+    }
+#ifdef AVX2
+    return "AVX2";
+#else
+    return "SSE4.1";
+#endif
+}
@@ -0,0 +1,42 @@
+#ifndef MMSEQS_SIMDDISPATCH_H
+#define MMSEQS_SIMDDISPATCH_H
+
+// The SIMD kernels (UngappedAlignment, SmithWaterman and the k-mer list product of KmerGenerator)
+// are compiled for the instruction set of the build in the namespace simd_default.
+// SSE4.1 builds with HAVE_SIMD_DISPATCH compile them a second time with AVX2 in the namespace
+// simd_avx2 (SIMD_KERNEL_VARIANT is defined for that pass) and pick one at runtime.
+// With SIMD_DISPATCH_AVX512BW the UngappedAlignment is also compiled with AVX-512BW in the
+// namespace simd_avx512bw, the other kernels use their AVX2 version on such CPUs.
+
+#ifndef SIMD_KERNEL_NAMESPACE
+#define SIMD_KERNEL_NAMESPACE simd_default
+#endif
+
+#ifdef SIMD_DISPATCH_AVX2
+#define SIMD_KERNEL_DECLARE(declaration) \
+    namespace simd_default { declaration; } \
+    namespace simd_avx2 { declaration; }
+#define SIMD_KERNEL_DISPATCH(call) \
+    (SimdDispatch::getLevel() >= SimdDispatch::LEVEL_AVX2 ? simd_avx2::call : simd_default::call)
+#else
+#define SIMD_KERNEL_DECLARE(declaration) \
+    namespace simd_default { declaration; }
+// getLevel is still called to log the kernels
+#define SIMD_KERNEL_DISPATCH(call) (SimdDispatch::getLevel(), simd_default::call)
+#endif
+
+class SimdDispatch {
+public:
+    enum Level {
+        LEVEL_DEFAULT,
+        LEVEL_AVX2,
+        LEVEL_AVX512BW
+    };
+
+    // detected with CpuInfo on the first call, which also logs the chosen kernels
+    static Level getLevel();
+
+    static const char *getLevelName(Level level);
+};
+
+#endif
@@ -20,6 +20,12 @@ public:
         return ss.str();
     }
 
+    double elapsedSeconds() {
+        struct timeval end;
+        gettimeofday(&end, NULL);
+        return (end.tv_sec - start.tv_sec) + 1e-6 * (end.tv_usec - start.tv_usec);
+    }
+
     void reset() {
         gettimeofday(&start, NULL);
     }
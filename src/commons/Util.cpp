@@ -6,7 +6,9 @@
 #include "SubstitutionMatrix.h"
 #include "Sequence.h"
 #include "Parameters.h"
+#include "DBWriter.h"
 #include <sys/resource.h>
+#include <sys/mman.h>
 
 #include <unistd.h>
 #ifdef __APPLE__
@@ -339,6 +341,87 @@ size_t Util::getTotalMemoryPages() {
     return phys_pages;
 }
 
+static const size_t HUGE_PAGE_SIZE_2M = 2 * 1024 * 1024;
+static const size_t HUGE_PAGE_SIZE_1G = 1024 * 1024 * 1024;
+
+static size_t roundUp(size_t size, size_t alignment) {
+    return ((size + alignment - 1) / alignment) * alignment;
+}
+
+static size_t getMappingSize(size_t size, Util::HugePageType type) {
+    return roundUp(std::max(size, (size_t) 1), (type == Util::HUGEPAGES_1G) ? HUGE_PAGE_SIZE_1G : HUGE_PAGE_SIZE_2M);
+}
+
+void *Util::allocHugePages(size_t size, HugePageType *type) {
+#ifdef MAP_HUGETLB
+    // reserved huge pages only exist if they were set up by the administrator
+    if (size >= HUGE_PAGE_SIZE_1G) {
+#if defined(MAP_HUGE_SHIFT)
+        void *memory = mmap(NULL, getMappingSize(size, HUGEPAGES_1G), PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (30 << MAP_HUGE_SHIFT), -1, 0);
+        if (memory != MAP_FAILED) {
+            *type = HUGEPAGES_1G;
+            return memory;
+        }
+#endif
+    }
+    if (size >= HUGE_PAGE_SIZE_2M) {
+        void *memory = mmap(NULL, getMappingSize(size, HUGEPAGES_2M), PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            *type = HUGEPAGES_2M;
+            return memory;
+        }
+    }
+#endif
+    // over allocate by one huge page to align the mapping, otherwise the first and last
+    // huge page of the range could not be backed by a transparent huge page
+    size_t mapSize = getMappingSize(size, NORMAL_PAGES);
+    char *memory = (char *) mmap(NULL, mapSize + HUGE_PAGE_SIZE_2M, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return NULL;
+    }
+    char *aligned = (char *) roundUp((size_t) memory, HUGE_PAGE_SIZE_2M);
+    if (aligned > memory) {
+        munmap(memory, aligned - memory);
+    }
+    size_t tail = (memory + mapSize + HUGE_PAGE_SIZE_2M) - (aligned + mapSize);
+    if (tail > 0) {
+        munmap(aligned + mapSize, tail);
+    }
+    *type = adviseHugePages(aligned, mapSize) ? TRANSPARENT_HUGEPAGES : NORMAL_PAGES;
+    return aligned;
+}
+
+void Util::freeHugePages(void *memory, size_t size, HugePageType type) {
+    if (memory != NULL) {
+        munmap(memory, getMappingSize(size, type));
+    }
+}
+
+bool Util::adviseHugePages(void *memory, size_t size) {
+#ifdef MADV_HUGEPAGE
+    size_t start = roundUp((size_t) memory, HUGE_PAGE_SIZE_2M);
+    size_t end = (((size_t) memory) + size) & ~(HUGE_PAGE_SIZE_2M - 1);
+    if (end <= start) {
+        return false;
+    }
+    return madvise((void *) start, end - start, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+}
+
+const char *Util::getHugePageTypeName(HugePageType type) {
+    switch (type) {
+        case TRANSPARENT_HUGEPAGES: return "transparent huge pages (advised)";
+        case HUGEPAGES_2M: return "2MB huge pages";
+        case HUGEPAGES_1G: return "1GB huge pages";
+        default: return "normal pages";
+    }
+}
+
 size_t Util::getTotalSystemMemory()
 {
     // check for real physical memory
@@ -506,4 +589,15 @@ float Util::computeSeqId(int seqIdMode, int aaIds, int qLen, int tLen, int alnLe
     return 0.0;
 }
 
-
+std::pair<std::string, std::string> Util::createTmpFileNames(const std::string &db, const std::string &dbindex, int count) {
+    if (db == DBWriter::STREAM_STDOUT) {
+        // the splits would have to be merged into a file named after the stream
+        Debug(Debug::ERROR) << "Results computed in splits or chunks can not be written to " << DBWriter::STREAM_STDOUT
+                            << ". Write them to a database instead.\n";
+        EXIT(EXIT_FAILURE);
+    }
+    std::string suffix = std::string("_tmp_") + SSTR(count);
+    std::string data  = db + suffix;
+    std::string index = dbindex + suffix;
+    return std::make_pair(data, index);
+}
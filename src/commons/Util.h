@@ -60,6 +60,24 @@ public:
     static size_t getTotalMemoryPages();
     static char touchMemory(char* memory, size_t size);
 
+    // pages backing memory returned by allocHugePages
+    enum HugePageType {
+        NORMAL_PAGES = 0,
+        TRANSPARENT_HUGEPAGES, // advised with MADV_HUGEPAGE, the kernel decides whether to use them
+        HUGEPAGES_2M,          // reserved hugetlb pages
+        HUGEPAGES_1G
+    };
+
+    // anonymous memory backed by reserved 1GB or 2MB pages if the system has them,
+    // otherwise 2MB aligned and advised for transparent huge pages. Returns NULL on failure.
+    static void *allocHugePages(size_t size, HugePageType *type);
+    static void freeHugePages(void *memory, size_t size, HugePageType type);
+
+    // advises the 2MB aligned part of existing memory for transparent huge pages
+    static bool adviseHugePages(void *memory, size_t size);
+
+    static const char *getHugePageTypeName(HugePageType type);
+
     static size_t countLines(const char *data, size_t length);
     template<typename T>
     static inline T fast_atoi( const char * str )
@@ -169,13 +187,9 @@ public:
         return counter;
     }
 
+    // names of the split or chunk count of db, fails for a db streamed to stdout
     static std::pair<std::string, std::string> createTmpFileNames(const std::string &db,
-                                                                  const std::string &dbindex, int count){
-        std::string suffix = std::string("_tmp_") + SSTR(count);
-        std::string data  = db + suffix;
-        std::string index = dbindex + suffix;
-        return std::make_pair(data, index);
-    }
+                                                                  const std::string &dbindex, int count);
 
     static std::pair<std::string, std::string> databaseNames(const std::string &basename) {
         std::string index = basename;
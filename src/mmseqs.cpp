@@ -134,6 +134,27 @@ std::vector<struct Command> commands = {
                 "<i:queryDB> <i:targetDB> <i:resultDB> <o:alignmentDB>",
                 CITATION_MMSEQS2},
 
+        {"prefilteralign",       prefilteralign,       &par.prefilteralign,       COMMAND_EXPERT,
+                "Compute Smith-Waterman alignments for the prefilter hits without writing a prefilter DB",
+                "Runs the prefilter and aligns the hits of every query right away in the same thread, so the prefilter DB is never written. If the target DB has to be split the prefilter DB is written to <alignmentDB>_pref and removed after the alignment.",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de> & Maria Hauser",
+                "<i:queryDB> <i:targetDB> <o:alignmentDB>",
+                CITATION_MMSEQS2},
+
+        {"server",               server,               &par.prefilteralign,       COMMAND_EXPERT,
+                "Keep the target DB loaded and search query batches sent over a local socket",
+                "Loads the index table, the sequence lookup and the matrices of the target DB once and answers requests on a Unix domain socket. A request is a FASTA file, the client closes its write side after sending it. The answer has one tab separated line per alignment: query, target, seq. identity, alignment length, query start, query end, target start, target end, e-value and bit score. A query that is longer than --max-seq-len or has other characters than letters is answered with a line ERROR, query and reason instead. The target DB must not need a target split. A client that does not send its request or read the answer within 60 seconds is disconnected. The server does not start if socketPath is taken by another file or a running server. SIGTERM stops the server and removes the socket.",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:targetDB> <i:socketPath> <i:tmpDir>",
+                CITATION_MMSEQS2},
+
+        {"prefilterstats",       prefilterstats,       &par.onlyverbosity,        COMMAND_EXPERT,
+                "Find the queries that dominate the prefilter runtime",
+                "Sums the per query records that prefilter writes to <resultDB>_stats with --query-stats over all splits. Writes one line per query, slowest first: query, length, splits, k-mer list length, matched index entries, diagonal bins, ungapped alignments, hits, overflows, ms for k-mer generation, counting, ungapped alignment, result extraction and in total and the share of the total time. Prints the time per phase and the share of the slowest queries.",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:queryDB> <i:statsDB> <o:tsvFile>",
+                CITATION_MMSEQS2},
+
         {"alignall",             alignall,                &par.align,                COMMAND_EXPERT,
                 "Compute all against all Smith-Waterman alignments for a results (e.g. prefilter DB, cluster DB)",
                 "Calculates an all against all Smith-Waterman alignment scores between all sequences in a result. It reports all hits which passed the alignment criteria.",
@@ -219,6 +240,24 @@ std::vector<struct Command> commands = {
                 "Milot Mirdita <milot@mirdita.de>",
                 "<i:sequenceDB> <o:sequenceDB_1..N>",
                 CITATION_MMSEQS2},
+        {"createbinaryindex",    createbinaryindex,    &par.onlyverbosity,        COMMAND_DB,
+                "Convert the text index of a DB into a binary index that is memory mapped on open",
+                "Writes <DB>.index.bin next to the text index of an existing DB. It contains the sorted keys, offsets and lengths in a fixed-width layout, which DBReader maps and uses in place instead of parsing and sorting the text index. DBWriter already emits it for newly written DBs.",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:DB>",
+                CITATION_MMSEQS2},
+        {"rmdb",                 rmdb,                 &par.onlyverbosity,        COMMAND_DB,
+                "Remove a DB",
+                "Removes the data file, text and binary index and dbtype of a DB.",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:DB>",
+                CITATION_MMSEQS2},
+        {"mvdb",                 mvdb,                 &par.onlyverbosity,        COMMAND_DB,
+                "Move a DB",
+                "Moves the data file, text and binary index and dbtype of a DB to a new name. A dstDB named stdout streams the DB to stdout and removes it.",
+                "Martin Steinegger <martin.steinegger@mpibpc.mpg.de>",
+                "<i:srcDB> <o:dstDB>",
+                CITATION_MMSEQS2},
         {"subtractdbs",          subtractdbs,          &par.subtractdbs,          COMMAND_DB,
                 "Generate a DB with entries of first DB not occurring in second DB",
                 NULL,
@@ -1,6 +1,10 @@
 #include "IndexBuilder.h"
 #include "tantan.h"
 
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
 char* getScoreLookup(BaseMatrix &matrix) {
     char *idScoreLookup = NULL;
     idScoreLookup = new char[matrix.alphabetSize];
@@ -53,9 +57,127 @@ public:
 };
 
 
+// k-mers of a batch of consecutive sequences. The batch is split in blocks of about equal residues, every
+// block is extracted by one thread and its k-mers are bucketed by k-mer range. Every range is then added
+// to the index table by a single thread, so the table needs no atomics and the lists come out sorted by
+// sequence id.
+class KmerBatch {
+public:
+    KmerBatch(size_t blockCount, size_t tableSize) : blockCount(blockCount), batchEnd(0), batchResidues(0), kmersPerResidue(1) {
+        partitionCount = blockCount * 16;
+        partitionSpan = (tableSize + partitionCount - 1) / partitionCount;
+        kmers = new std::vector<IndexEntryLocalTmp>[blockCount];
+        partitioned = new std::vector<IndexEntryLocalTmp>[blockCount];
+        partitionStarts = new size_t[blockCount * (partitionCount + 1)];
+        blockStarts = new size_t[blockCount + 1];
+    }
+
+    ~KmerBatch() {
+        delete[] kmers;
+        delete[] partitioned;
+        delete[] partitionStarts;
+        delete[] blockStarts;
+    }
+
+    // splits the sequences following batchStart in blocks
+    // profiles yield many similar k-mers per residue, so the batch is closed on the k-mers expected from
+    // the densest batch so far. The first batch takes one sequence per block, as nothing is known yet.
+    void nextBatch(size_t batchStart, size_t dbTo, unsigned int *seqLengths) {
+        size_t residues = 0;
+        batchEnd = batchStart;
+        if (batchResidues == 0) {
+            while (batchEnd < dbTo && batchEnd < batchStart + blockCount) {
+                residues += seqLengths[batchEnd++];
+            }
+        } else {
+            size_t batchKmers = 0;
+            for (size_t block = 0; block < blockCount; block++) {
+                batchKmers += kmers[block].size();
+            }
+            kmersPerResidue = std::max(kmersPerResidue, static_cast<double>(batchKmers) / batchResidues);
+            const size_t maxResidues = static_cast<size_t>(blockCount * MAX_BLOCK_KMERS / kmersPerResidue);
+            while (batchEnd < dbTo && residues < maxResidues) {
+                residues += seqLengths[batchEnd++];
+            }
+        }
+        batchResidues = residues;
+        const size_t blockResidues = residues / blockCount + 1;
+        size_t id = batchStart;
+        blockStarts[0] = batchStart;
+        for (size_t block = 0; block < blockCount; block++) {
+            size_t currResidues = 0;
+            while (id < batchEnd && currResidues < blockResidues) {
+                currResidues += seqLengths[id++];
+            }
+            blockStarts[block + 1] = id;
+        }
+        blockStarts[blockCount] = batchEnd;
+    }
+
+    // buckets the k-mers of the block by k-mer range
+    void partition(size_t block) {
+        const std::vector<IndexEntryLocalTmp> &in = kmers[block];
+        std::vector<IndexEntryLocalTmp> &out = partitioned[block];
+        size_t *starts = partitionStarts + block * (partitionCount + 1);
+        memset(starts, 0, (partitionCount + 1) * sizeof(size_t));
+        for (size_t i = 0; i < in.size(); i++) {
+            starts[in[i].kmer / partitionSpan + 1]++;
+        }
+        for (size_t i = 0; i < partitionCount; i++) {
+            starts[i + 1] += starts[i];
+        }
+        std::vector<size_t> writePos(starts, starts + partitionCount);
+        out.resize(in.size());
+        for (size_t i = 0; i < in.size(); i++) {
+            out[writePos[in[i].kmer / partitionSpan]++] = in[i];
+        }
+    }
+
+    // counts or adds the k-mers of one range for all blocks
+    void addPartition(IndexTable *indexTable, size_t partition, bool count) {
+        for (size_t block = 0; block < blockCount; block++) {
+            const size_t *starts = partitionStarts + block * (partitionCount + 1);
+            const size_t kmerCount = starts[partition + 1] - starts[partition];
+            if (kmerCount == 0) {
+                continue;
+            }
+            const IndexEntryLocalTmp *blockKmers = &partitioned[block][starts[partition]];
+            if (count) {
+                indexTable->countKmers(blockKmers, kmerCount);
+            } else {
+                indexTable->addKmers(blockKmers, kmerCount);
+            }
+        }
+    }
+
+    size_t getBlockCount() { return blockCount; }
+    size_t getBlockStart(size_t block) { return blockStarts[block]; }
+    size_t getBatchEnd() { return batchEnd; }
+    size_t getPartitionCount() { return partitionCount; }
+    std::vector<IndexEntryLocalTmp> &getKmers(size_t block) { return kmers[block]; }
+
+private:
+    // bounds the memory of the buffered k-mers
+    static const size_t MAX_BLOCK_KMERS = 256 * 1024;
+
+    size_t blockCount;
+    size_t partitionCount;
+    size_t partitionSpan;
+    size_t batchEnd;
+    size_t batchResidues;
+    // at least one, so that batches of short sequences without k-mers stay bounded
+    double kmersPerResidue;
+    size_t *blockStarts;
+    size_t *partitionStarts;
+    std::vector<IndexEntryLocalTmp> *kmers;
+    std::vector<IndexEntryLocalTmp> *partitioned;
+};
+
+
 void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedLookup, SequenceLookup **unmaskedLookup,
                                 BaseMatrix &subMat, Sequence *seq,
-                                DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr) {
+                                DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr,
+                                bool remapData) {
     Debug(Debug::INFO) << "Index table: counting k-mers...\n";
 
     const bool isProfile = seq->getSeqType() == Sequence::HMM_PROFILE;
@@ -89,10 +211,22 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
         idScoreLookup = getScoreLookup(subMat);
     }
 
+    unsigned int threads = 1;
+#ifdef OPENMP
+    threads = static_cast<unsigned int>(omp_get_max_threads());
+#endif
+    KmerBatch batch(threads, indexTable->getTableSize());
+
     size_t maskedResidues = 0;
     size_t totalKmerCount = 0;
     #pragma omp parallel
     {
+        unsigned int thread_idx = 0;
+        unsigned int teamSize = 1;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+        teamSize = static_cast<unsigned int>(omp_get_num_threads());
+#endif
         Indexer idxer(static_cast<unsigned int>(indexTable->getAlphabetSize()), seq->getKmerSize());
         Sequence s(seq->getMaxLen(), seq->getSeqType(), &subMat, seq->getKmerSize(), seq->isSpaced(), false);
 
@@ -102,56 +236,75 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
             generator->setDivideStrategy(s.profile_matrix);
         }
 
-        unsigned int *buffer = new unsigned int[seq->getMaxLen()];
         char *charSequence = new char[seq->getMaxLen()];
 
-        #pragma omp for schedule(dynamic, 100) reduction(+:totalKmerCount, maskedResidues)
-        for (size_t id = dbFrom; id < dbTo; id++) {
-            Debug::printProgress(id - dbFrom);
-
-            s.resetCurrPos();
-            char *seqData = dbr->getData(id);
-            unsigned int qKey = dbr->getDbKey(id);
-            s.mapSequence(id - dbFrom, qKey, seqData);
-
-            // count similar or exact k-mers based on sequence type
-            if (isProfile) {
-                // Find out if we should also mask profiles
-                totalKmerCount += indexTable->addSimilarKmerCount(&s, generator, &idxer, kmerThr, idScoreLookup);
-                (*unmaskedLookup)->addSequence(s.int_consensus_sequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
-            } else {
-                // Do not mask if column state sequences are used
-                if (unmaskedLookup != NULL) {
-                    (*unmaskedLookup)->addSequence(s.int_sequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
-                }
-                if (maskedLookup != NULL) {
-                    for (int i = 0; i < s.L; ++i) {
-                        charSequence[i] = (char) s.int_sequence[i];
+        size_t threadKmerCount = 0;
+        size_t threadMaskedResidues = 0;
+        for (size_t batchStart = dbFrom; batchStart < dbTo;) {
+            #pragma omp single
+            batch.nextBatch(batchStart, dbTo, dbr->getSeqLens());
+            batchStart = batch.getBatchEnd();
+
+            for (size_t block = thread_idx; block < batch.getBlockCount(); block += teamSize) {
+                std::vector<IndexEntryLocalTmp> &kmers = batch.getKmers(block);
+                kmers.clear();
+                for (size_t id = batch.getBlockStart(block); id < batch.getBlockStart(block + 1); id++) {
+                    Debug::printProgress(id - dbFrom);
+
+                    s.resetCurrPos();
+                    char *seqData = dbr->getData(id);
+                    unsigned int qKey = dbr->getDbKey(id);
+                    s.mapSequence(id - dbFrom, qKey, seqData);
+
+                    // count similar or exact k-mers based on sequence type
+                    if (isProfile) {
+                        // Find out if we should also mask profiles
+                        threadKmerCount += indexTable->extractSimilarKmers(&s, generator, kmers);
+                        (*unmaskedLookup)->addSequence(s.int_consensus_sequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
+                    } else {
+                        // Do not mask if column state sequences are used
+                        if (unmaskedLookup != NULL) {
+                            (*unmaskedLookup)->addSequence(s.int_sequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
+                        }
+                        if (maskedLookup != NULL) {
+                            for (int i = 0; i < s.L; ++i) {
+                                charSequence[i] = (char) s.int_sequence[i];
+                            }
+                            // s.print();
+                            threadMaskedResidues += tantan::maskSequences(charSequence,
+                                                                          charSequence + s.L,
+                                                                          50 /*options.maxCycleLength*/,
+                                                                          probMatrix->probMatrixPointers,
+                                                                          0.005 /*options.repeatProb*/,
+                                                                          0.05 /*options.repeatEndProb*/,
+                                                                          0.9 /*options.repeatOffsetProbDecay*/,
+                                                                          0, 0,
+                                                                          0.9 /*options.minMaskProb*/,
+                                                                          probMatrix->hardMaskTable);
+
+                            for (int i = 0; i < s.L; i++) {
+                                s.int_sequence[i] = charSequence[i];
+                            }
+                            (*maskedLookup)->addSequence(s.int_sequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
+                        }
+
+                        threadKmerCount += indexTable->extractKmers(&s, &idxer, kmers, kmerThr, idScoreLookup);
                     }
-                    // s.print();
-                    maskedResidues += tantan::maskSequences(charSequence,
-                                                            charSequence + s.L,
-                                                            50 /*options.maxCycleLength*/,
-                                                            probMatrix->probMatrixPointers,
-                                                            0.005 /*options.repeatProb*/,
-                                                            0.05 /*options.repeatEndProb*/,
-                                                            0.9 /*options.repeatOffsetProbDecay*/,
-                                                            0, 0,
-                                                            0.9 /*options.minMaskProb*/,
-                                                            probMatrix->hardMaskTable);
-
-                    for (int i = 0; i < s.L; i++) {
-                        s.int_sequence[i] = charSequence[i];
-                    }
-                    (*maskedLookup)->addSequence(s.int_sequence, s.L, id - dbFrom, info->sequenceOffsets[id - dbFrom]);
                 }
+                batch.partition(block);
+            }
+            #pragma omp barrier
 
-                totalKmerCount += indexTable->addKmerCount(&s, &idxer, buffer, kmerThr, idScoreLookup);
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t partition = 0; partition < batch.getPartitionCount(); partition++) {
+                batch.addPartition(indexTable, partition, true);
             }
         }
 
+        __sync_fetch_and_add(&totalKmerCount, threadKmerCount);
+        __sync_fetch_and_add(&maskedResidues, threadMaskedResidues);
+
         delete[] charSequence;
-        delete[] buffer;
 
         if (generator != NULL) {
             delete generator;
@@ -173,7 +326,9 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
         EXIT(EXIT_FAILURE);
     }
 
-    dbr->remapData();
+    if (remapData) {
+        dbr->remapData();
+    }
 
     //TODO find smart way to remove extrem k-mers without harming huge protein families
 //    size_t lowSelectiveResidues = 0;
@@ -198,9 +353,14 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
     Debug(Debug::INFO) << "Index table: fill...\n";
     #pragma omp parallel
     {
+        unsigned int thread_idx = 0;
+        unsigned int teamSize = 1;
+#ifdef OPENMP
+        thread_idx = static_cast<unsigned int>(omp_get_thread_num());
+        teamSize = static_cast<unsigned int>(omp_get_num_threads());
+#endif
         Sequence s(seq->getMaxLen(), seq->getSeqType(), &subMat, seq->getKmerSize(), seq->isSpaced(), false);
         Indexer idxer(static_cast<unsigned int>(indexTable->getAlphabetSize()), seq->getKmerSize());
-        IndexEntryLocalTmp *buffer = new IndexEntryLocalTmp[seq->getMaxLen()];
 
         KmerGenerator *generator = NULL;
         if (isProfile) {
@@ -208,33 +368,45 @@ void IndexBuilder::fillDatabase(IndexTable *indexTable, SequenceLookup **maskedL
             generator->setDivideStrategy(s.profile_matrix);
         }
 
-        #pragma omp for schedule(dynamic, 100)
-        for (size_t id = dbFrom; id < dbTo; id++) {
-            s.resetCurrPos();
-            Debug::printProgress(id - dbFrom);
+        for (size_t batchStart = dbFrom; batchStart < dbTo;) {
+            #pragma omp single
+            batch.nextBatch(batchStart, dbTo, dbr->getSeqLens());
+            batchStart = batch.getBatchEnd();
+
+            for (size_t block = thread_idx; block < batch.getBlockCount(); block += teamSize) {
+                std::vector<IndexEntryLocalTmp> &kmers = batch.getKmers(block);
+                kmers.clear();
+                for (size_t id = batch.getBlockStart(block); id < batch.getBlockStart(block + 1); id++) {
+                    s.resetCurrPos();
+                    Debug::printProgress(id - dbFrom);
+
+                    unsigned int qKey = dbr->getDbKey(id);
+                    if (isProfile) {
+                        s.mapSequence(id - dbFrom, qKey, dbr->getData(id));
+                        indexTable->extractSimilarKmers(&s, generator, kmers);
+                    } else {
+                        s.mapSequence(id - dbFrom, qKey, sequenceLookup->getSequence(id - dbFrom));
+                        indexTable->extractKmers(&s, &idxer, kmers, kmerThr, idScoreLookup);
+                    }
+                }
+                batch.partition(block);
+            }
+            #pragma omp barrier
 
-            unsigned int qKey = dbr->getDbKey(id);
-            if (isProfile) {
-                s.mapSequence(id - dbFrom, qKey, dbr->getData(id));
-                indexTable->addSimilarSequence(&s, generator, &idxer, kmerThr, idScoreLookup);
-            } else {
-                s.mapSequence(id - dbFrom, qKey, sequenceLookup->getSequence(id - dbFrom));
-                indexTable->addSequence(&s, &idxer, buffer, kmerThr, idScoreLookup);
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t partition = 0; partition < batch.getPartitionCount(); partition++) {
+                batch.addPartition(indexTable, partition, false);
             }
         }
 
         if (generator != NULL) {
             delete generator;
         }
-
-        delete [] buffer;
     }
     if(idScoreLookup!=NULL){
         delete[] idScoreLookup;
     }
 
-    indexTable->sortDBSeqLists();
-    Debug(Debug::INFO) << "\nIndex table: removing duplicate entries...\n";
     indexTable->revertPointer();
     Debug(Debug::INFO) << "Index table init done.\n\n";
 }
@@ -5,9 +5,11 @@
 
 class IndexBuilder {
 public:
+    // remapData releases the pages of dbr after counting, it has to be false while other threads read dbr
     static void fillDatabase(IndexTable *indexTable, SequenceLookup **maskedLookup, SequenceLookup **unmaskedLookup,
                              BaseMatrix &subMat, Sequence *seq,
-                             DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr);
+                             DBReader<unsigned int> *dbr, size_t dbFrom, size_t dbTo, int kmerThr,
+                             bool remapData = true);
 };
 
 #endif
@@ -0,0 +1,35 @@
+#include "IndexTable.h"
+
+#include <cstring>
+#include <stdint.h>
+
+void IndexTable::unpackDBSeqList(const unsigned char *list, size_t listSize, IndexEntryLocal *output) {
+    size_t seqId;
+    list = readVarint(list, &seqId);
+    output[0].seqId = static_cast<unsigned int>(seqId);
+    if (listSize == 1) {
+        size_t position;
+        readVarint(list, &position);
+        output[0].position_j = static_cast<unsigned short>(position);
+        return;
+    }
+    const unsigned int seqBits = list[0];
+    const unsigned int posBits = list[1];
+    const unsigned char *bits = list + 2;
+    uint64_t word;
+    memcpy(&word, bits, sizeof(uint64_t));
+    output[0].position_j = static_cast<unsigned short>(word & ((UINT64_C(1) << posBits) - 1));
+
+    const unsigned int width = seqBits + posBits;
+    const uint64_t fieldMask = (UINT64_C(1) << width) - 1;
+    const uint64_t seqMask = (UINT64_C(1) << seqBits) - 1;
+    size_t bitPos = posBits;
+    for (size_t i = 1; i < listSize; i++) {
+        memcpy(&word, bits + (bitPos >> 3), sizeof(uint64_t));
+        const uint64_t field = (word >> (bitPos & 7)) & fieldMask;
+        seqId += field & seqMask;
+        output[i].seqId = static_cast<unsigned int>(seqId);
+        output[i].position_j = static_cast<unsigned short>(field >> seqBits);
+        bitPos += width;
+    }
+}
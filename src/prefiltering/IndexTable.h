@@ -6,6 +6,16 @@
 //
 // Abstract: Index table stores the list of DB sequences containing a certain k-mer, for each k-mer.
 //
+// The lists can be compressed after they are sorted (compress). The k-mers are then grouped in buckets
+// of BUCKET_SIZE, offsets holds one byte offset per bucket and every bucket is stored as
+//   16 bit mask of the non-empty lists, varint byte size of the list header,
+//   list header of varint size and varint byte size of each non-empty list, the non-empty lists
+// so a list is found by reading the list header only.
+// A list of a single entry is stored as varint seqId, varint position. Longer lists are stored as
+//   varint first seqId, 1 byte seqId delta bits, 1 byte position bits,
+//   position of the first entry, (seqId delta | position << delta bits) for every following entry
+// with the fields bit packed in fixed width, so a list decodes with one unaligned 64 bit load per entry.
+//
 
 #include <iostream>
 #include <fstream>
@@ -13,6 +23,7 @@
 #include <list>
 #include <sys/mman.h>
 #include <new>
+#include <vector>
 
 #include "DBReader.h"
 #include "Sequence.h"
@@ -70,10 +81,12 @@ public:
     IndexTable(int alphabetSize, int kmerSize, bool externalData)
             : tableSize(MathUtil::ipow<size_t>(alphabetSize, kmerSize)), alphabetSize(alphabetSize),
               kmerSize(kmerSize), externalData(externalData), tableEntriesNum(0), size(0),
-              indexer(new Indexer(alphabetSize, kmerSize)), entries(NULL), offsets(NULL) {
+              indexer(new Indexer(alphabetSize, kmerSize)), entries(NULL), offsets(NULL),
+              compressed(false), packedEntries(NULL), packedEntriesSize(0),
+              entriesPageType(Util::NORMAL_PAGES), offsetsPageType(Util::NORMAL_PAGES) {
         if (externalData == false) {
-            offsets = new(std::nothrow) size_t[tableSize + 1];
-            memset(offsets, 0, (tableSize + 1) * sizeof(size_t));
+            // anonymous mappings are zero filled
+            offsets = (size_t *) Util::allocHugePages((tableSize + 1) * sizeof(size_t), &offsetsPageType);
             Util::checkAllocation(offsets, "Could not allocate entries memory in IndexTable");
         }
     }
@@ -87,99 +100,83 @@ public:
     void deleteEntries() {
         if (externalData == false) {
             if (entries != NULL) {
-                delete[] entries;
+                Util::freeHugePages(entries, tableEntriesNum * sizeof(IndexEntryLocal), entriesPageType);
                 entries = NULL;
             }
+            if (packedEntries != NULL) {
+                Util::freeHugePages(packedEntries, packedEntriesSize, entriesPageType);
+                packedEntries = NULL;
+            }
             if (offsets != NULL) {
-                delete[] offsets;
+                Util::freeHugePages(offsets, getOffsetsSize(), offsetsPageType);
                 offsets = NULL;
             }
         }
     }
 
-    // count k-mers in the sequence, so enough memory for the sequence lists can be allocated in the end
-    size_t addSimilarKmerCount (Sequence* s, KmerGenerator * kmerGenerator, Indexer * idxer,
-                                int threshold, char * diagonalScore){
-
+    // appends the similar k-mers of the profile to buffer, only the first position of every k-mer is kept
+    size_t extractSimilarKmers(Sequence *s, KmerGenerator *kmerGenerator, std::vector<IndexEntryLocalTmp> &buffer) {
+        const size_t start = buffer.size();
         s->resetCurrPos();
-        std::vector<unsigned int> seqKmerPosBuffer;
-
-        //idxer->reset();
-        while(s->hasNextKmer()){
-            const int * kmer = s->nextKmer();
-            const ScoreMatrix kmerList = kmerGenerator->generateKmerList(kmer);
-
-            //unsigned int kmerIdx = idxer->int2index(kmer, 0, kmerSize);
-            for(size_t i = 0; i < kmerList.elementSize; i++){
-                seqKmerPosBuffer.push_back(kmerList.index[i]);
-            }
-        }
-        if(seqKmerPosBuffer.size() > 1){
-            std::sort(seqKmerPosBuffer.begin(), seqKmerPosBuffer.end());
-        }
-        size_t countUniqKmer = 0;
-        unsigned int prevKmerIdx = UINT_MAX;
-        for(size_t i = 0; i < seqKmerPosBuffer.size(); i++){
-            unsigned int kmerIdx = seqKmerPosBuffer[i];
-            if(prevKmerIdx != kmerIdx){
-                //table[kmerIdx] += 1;
-                // size increases by one
-                __sync_fetch_and_add(&(offsets[kmerIdx]), 1);
-                countUniqKmer++;
+        while (s->hasNextKmer()) {
+            const int *kmer = s->nextKmer();
+            ScoreMatrix scoreMatrix = kmerGenerator->generateKmerList(kmer);
+            for (size_t i = 0; i < scoreMatrix.elementSize; i++) {
+                buffer.push_back(IndexEntryLocalTmp(scoreMatrix.index[i], s->getId(), s->getCurrentPosition()));
             }
-            prevKmerIdx = kmerIdx;
         }
-        return countUniqKmer;
+        return uniqueKmers(buffer, start);
     }
 
-    // count k-mers in the sequence, so enough memory for the sequence lists can be allocated in the end
-    size_t addKmerCount(Sequence *s, Indexer *idxer, unsigned int *seqKmerPosBuffer,
-                        int threshold, char *diagonalScore) {
+    // appends the k-mers of the sequence to buffer, only the first position of every k-mer is kept
+    size_t extractKmers(Sequence *s, Indexer *idxer, std::vector<IndexEntryLocalTmp> &buffer, int threshold, char *diagonalScore) {
+        const size_t start = buffer.size();
         s->resetCurrPos();
-        size_t countKmer = 0;
         bool removeX = (s->getSequenceType() == Sequence::NUCLEOTIDES ||
                         s->getSequenceType() == Sequence::AMINO_ACIDS);
         const int xIndex = s->subMat->aa2int[(int)'X'];
-        while(s->hasNextKmer()){
-            const int * kmer = s->nextKmer();
-            if(removeX){
+        while (s->hasNextKmer()) {
+            const int *kmer = s->nextKmer();
+            if (removeX) {
                 int xCount = 0;
-                for(int pos = 0; pos < kmerSize; pos++){
+                for (int pos = 0; pos < kmerSize; pos++) {
                     xCount += (kmer[pos] == xIndex);
                 }
-                if(xCount > 0){
+                if (xCount > 0) {
                     continue;
                 }
             }
-            if(threshold > 0){
+            if (threshold > 0) {
                 int score = 0;
-                for(int pos = 0; pos < kmerSize; pos++){
+                for (int pos = 0; pos < kmerSize; pos++) {
                     score += diagonalScore[kmer[pos]];
                 }
-                if(score < threshold){
+                if (score < threshold) {
                     continue;
                 }
             }
             unsigned int kmerIdx = idxer->int2index(kmer, 0, kmerSize);
-            seqKmerPosBuffer[countKmer] = kmerIdx;
-            countKmer++;
-        }
-        if(countKmer > 1){
-            std::sort(seqKmerPosBuffer, seqKmerPosBuffer + countKmer);
-        }
-        size_t countUniqKmer = 0;
-        unsigned int prevKmerIdx = UINT_MAX;
-        for(size_t i = 0; i < countKmer; i++){
-            unsigned int kmerIdx = seqKmerPosBuffer[i];
-            if(prevKmerIdx != kmerIdx){
-                //table[kmerIdx] += 1;
-                // size increases by one
-                __sync_fetch_and_add(&(offsets[kmerIdx]), 1);
-                countUniqKmer++;
-            }
-            prevKmerIdx = kmerIdx;
+            buffer.push_back(IndexEntryLocalTmp(kmerIdx, s->getId(), s->getCurrentPosition()));
+        }
+        return uniqueKmers(buffer, start);
+    }
+
+    // count the k-mers so enough memory for the sequence lists can be allocated in the end
+    // no other thread may add k-mers of the same range at the same time
+    void countKmers(const IndexEntryLocalTmp *kmers, size_t kmerCount) {
+        for (size_t i = 0; i < kmerCount; i++) {
+            offsets[kmers[i].kmer] += 1;
+        }
+    }
+
+    // add the k-mers to their sequence lists after init
+    // no other thread may add k-mers of the same range at the same time
+    void addKmers(const IndexEntryLocalTmp *kmers, size_t kmerCount) {
+        for (size_t i = 0; i < kmerCount; i++) {
+            IndexEntryLocal *entry = &entries[offsets[kmers[i].kmer]++];
+            entry->seqId = kmers[i].seqId;
+            entry->position_j = kmers[i].position_j;
         }
-        return countUniqKmer;
     }
 
     // get list of DB sequences containing this k-mer
@@ -189,13 +186,42 @@ public:
         return (entries + offsets[kmer]);
     }
 
-    void sortDBSeqLists() {
-        #pragma omp parallel for
-        for (size_t i = 0; i < getTableSize(); i++) {
-            size_t entrySize;
-            IndexEntryLocal *entries = getDBSeqList(i, &entrySize);
-            std::sort(entries, entries + entrySize, IndexEntryLocal::comapreByIdAndPos);
+    // compressed tables: get the packed list of DB sequences containing this k-mer, see unpackDBSeqList
+    inline const unsigned char *getPackedDBSeqList(size_t kmer, size_t *matchedListSize) {
+        const unsigned char *bucket = packedEntries + offsets[kmer / BUCKET_SIZE];
+        unsigned short mask;
+        memcpy(&mask, bucket, sizeof(unsigned short));
+        const unsigned int bit = kmer % BUCKET_SIZE;
+        if (((mask >> bit) & 1) == 0) {
+            *matchedListSize = 0;
+            return bucket;
+        }
+        const unsigned int before = __builtin_popcount(mask & ((1u << bit) - 1));
+        size_t headerSize;
+        const unsigned char *header = readVarint(bucket + sizeof(unsigned short), &headerSize);
+        const unsigned char *list = header + headerSize;
+        size_t listSize;
+        size_t listBytes;
+        for (unsigned int i = 0; i < before; i++) {
+            header = readVarint(header, &listSize);
+            header = readVarint(header, &listBytes);
+            list += listBytes;
+        }
+        readVarint(header, matchedListSize);
+        return list;
+    }
+
+    // decodes listSize entries of a packed list into output
+    // not inlined, the decoder is too large for every call site
+    static void unpackDBSeqList(const unsigned char *list, size_t listSize, IndexEntryLocal *output);
+
+    inline size_t getDBSeqListSize(size_t kmer) {
+        if (compressed == false) {
+            return offsets[kmer + 1] - offsets[kmer];
         }
+        size_t listSize;
+        getPackedDBSeqList(kmer, &listSize);
+        return listSize;
     }
 
     // get pointer to entries array
@@ -203,6 +229,83 @@ public:
         return entries;
     }
 
+    bool isCompressed() {
+        return compressed;
+    }
+
+    // memory of the k-mer lists, IndexEntryLocal array or packed lists including their padding
+    char *getEntriesData() {
+        return compressed ? (char *) packedEntries : (char *) entries;
+    }
+
+    size_t getEntriesDataSize() {
+        return compressed ? packedEntriesSize : tableEntriesNum * sizeof(IndexEntryLocal);
+    }
+
+    // compressed tables have one offset per bucket
+    size_t getOffsetsSize() {
+        return (compressed ? (getBucketCount() + 1) : (tableSize + 1)) * sizeof(size_t);
+    }
+
+    // packs the sorted lists, the pages of the uncompressed entries are released while packing
+    // so the memory peak stays close to the uncompressed index
+    void compress() {
+        const size_t buckets = getBucketCount();
+        // buckets per chunk, every chunk is packed by a single thread
+        const size_t chunkSize = 4096;
+        const size_t chunks = (buckets + chunkSize - 1) / chunkSize;
+        std::vector<size_t> chunkOffsets(chunks + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            const size_t end = std::min(buckets, (chunk + 1) * chunkSize);
+            size_t size = 0;
+            for (size_t bucket = chunk * chunkSize; bucket < end; bucket++) {
+                size += packBucket(bucket, NULL);
+            }
+            chunkOffsets[chunk + 1] = size;
+        }
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            chunkOffsets[chunk + 1] += chunkOffsets[chunk];
+        }
+
+        // unpackDBSeqList loads 8 bytes at a time and might read past the last list
+        packedEntriesSize = chunkOffsets[chunks] + sizeof(uint64_t);
+        Util::HugePageType packedPageType;
+        packedEntries = (unsigned char *) Util::allocHugePages(packedEntriesSize, &packedPageType);
+        Util::checkAllocation(packedEntries, "Could not allocate packed entries memory in IndexTable::compress");
+        memset(packedEntries + chunkOffsets[chunks], 0, sizeof(uint64_t));
+        Util::HugePageType bucketOffsetsPageType;
+        size_t *bucketOffsets = (size_t *) Util::allocHugePages((buckets + 1) * sizeof(size_t), &bucketOffsetsPageType);
+        Util::checkAllocation(bucketOffsets, "Could not allocate offsets memory in IndexTable::compress");
+
+        const size_t pageSize = Util::getPageSize();
+#pragma omp parallel for schedule(dynamic, 1)
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            const size_t end = std::min(buckets, (chunk + 1) * chunkSize);
+            size_t offset = chunkOffsets[chunk];
+            for (size_t bucket = chunk * chunkSize; bucket < end; bucket++) {
+                bucketOffsets[bucket] = offset;
+                offset += packBucket(bucket, packedEntries + offset);
+            }
+            // release the pages only used by this chunk, fails for reserved huge pages
+            const size_t kmerEnd = std::min(tableSize, end * BUCKET_SIZE);
+            size_t from = ((size_t) (entries + offsets[chunk * chunkSize * BUCKET_SIZE]) + pageSize - 1) & ~(pageSize - 1);
+            size_t to = ((size_t) (entries + offsets[kmerEnd])) & ~(pageSize - 1);
+            if (from < to) {
+                madvise((void *) from, to - from, MADV_DONTNEED);
+            }
+        }
+        bucketOffsets[buckets] = chunkOffsets[chunks];
+
+        Util::freeHugePages(entries, tableEntriesNum * sizeof(IndexEntryLocal), entriesPageType);
+        entries = NULL;
+        entriesPageType = packedPageType;
+        Util::freeHugePages(offsets, (tableSize + 1) * sizeof(size_t), offsetsPageType);
+        offsets = bucketOffsets;
+        offsetsPageType = bucketOffsetsPageType;
+        compressed = true;
+    }
+
     inline size_t getOffset(size_t kmer) {
         return offsets[kmer];
     }
@@ -222,7 +325,8 @@ public:
         this->size = dbSize; // amount of sequences added
 
         // allocate memory for the sequence id lists
-        entries = new(std::nothrow) IndexEntryLocal[tableEntriesNum];
+        // the k-mer lists are accessed randomly during matching, huge pages avoid most TLB misses
+        entries = (IndexEntryLocal *) Util::allocHugePages(tableEntriesNum * sizeof(IndexEntryLocal), &entriesPageType);
         Util::checkAllocation(entries, "Could not allocate entries memory in IndexTable::initMemory");
     }
 
@@ -248,6 +352,18 @@ public:
         this->offsets = entryOffsets;
     }
 
+    // init index table with external packed lists (needed for index readin)
+    void initPackedTableByExternalData(size_t sequenceCount, size_t tableEntriesNum,
+                                       unsigned char *packedEntries, size_t packedEntriesSize, size_t *entryOffsets) {
+        this->tableEntriesNum = tableEntriesNum;
+        this->size = sequenceCount;
+
+        this->compressed = true;
+        this->packedEntries = packedEntries;
+        this->packedEntriesSize = packedEntriesSize;
+        this->offsets = entryOffsets;
+    }
+
     void revertPointer() {
         for (size_t i = tableSize; i > 0; i--) {
             offsets[i] = offsets[i - 1];
@@ -266,7 +382,7 @@ public:
         size_t minKmer = 0;
         size_t emptyKmer = 0;
         for (size_t i = 0; i < tableSize; i++) {
-            const ptrdiff_t size = offsets[i + 1] - offsets[i];
+            const ptrdiff_t size = getDBSeqListSize(i);
             minKmer = std::min(minKmer, (size_t) size);
             entrySize += size;
             if (size == 0) {
@@ -286,7 +402,10 @@ public:
         double avgKmer = ((double) entrySize) / ((double) tableSize);
         Debug(Debug::INFO) << "DB statistic\n";
         Debug(Debug::INFO) << "Entries:         " << entrySize << "\n";
-        Debug(Debug::INFO) << "DB Size:         " << entrySize * sizeof(IndexEntryLocal) + tableSize * sizeof(size_t) << " (byte)\n";
+        Debug(Debug::INFO) << "DB Size:         " << getEntriesDataSize() + getOffsetsSize() << " (byte)\n";
+        if (compressed) {
+            Debug(Debug::INFO) << "Packed entries:  " << ((double) packedEntriesSize) / ((double) std::max(entrySize, (size_t) 1)) << " byte per entry\n";
+        }
         Debug(Debug::INFO) << "Avg Kmer Size:   " << avgKmer << "\n";
         Debug(Debug::INFO) << "Top " << top_N << " Kmers\n   ";
         for (size_t j = 0; j < top_N; j++) {
@@ -295,118 +414,29 @@ public:
             Debug(Debug::INFO) << "\t\t" << topElements[j].first << "\n";
         }
         Debug(Debug::INFO) << "Min Kmer Size:   " << minKmer << "\n";
-        Debug(Debug::INFO) << "Empty list: " << emptyKmer << "\n\n";
+        Debug(Debug::INFO) << "Empty list: " << emptyKmer << "\n";
+        Debug(Debug::INFO) << "Entries memory:  " << Util::getHugePageTypeName(entriesPageType) << "\n";
+        Debug(Debug::INFO) << "Offsets memory:  " << Util::getHugePageTypeName(offsetsPageType) << "\n\n";
 
     }
 
-    // FUNCTIONS TO OVERWRITE
-    // add k-mers of the sequence to the index table
-    void addSimilarSequence (Sequence* s, KmerGenerator * kmerGenerator, Indexer * idxer,
-
-                             int threshold, char * diagonalScore){
-        std::vector<IndexEntryLocalTmp> buffer;
-        // iterate over all k-mers of the sequence and add the id of s to the sequence list of the k-mer (tableDummy)
-        s->resetCurrPos();
-        idxer->reset();
-        size_t kmerPos = 0;
-        while(s->hasNextKmer()){
-            const int * kmer = s->nextKmer();
-            ScoreMatrix scoreMatrix = kmerGenerator->generateKmerList(kmer);
-            for(size_t i = 0; i < scoreMatrix.elementSize; i++) {
-                unsigned int kmerIdx = scoreMatrix.index[i];
-
-                // if region got masked do not add kmer
-                if (offsets[kmerIdx + 1] - offsets[kmerIdx] == 0)
-                    continue;
-                buffer.push_back(IndexEntryLocalTmp(kmerIdx,s->getId(), s->getCurrentPosition()));
-                kmerPos++;
-            }
-        }
-
-        if(kmerPos>1){
-            std::sort(buffer.begin(), buffer.end(), IndexEntryLocalTmp::comapreByIdAndPos);
-        }
-        unsigned int prevKmer = UINT_MAX;
-        for(size_t pos = 0; pos < buffer.size(); pos++){
-            unsigned int kmerIdx = buffer[pos].kmer;
-            if(kmerIdx != prevKmer){
-                size_t offset = __sync_fetch_and_add(&(offsets[kmerIdx]), 1);
-                IndexEntryLocal *entry = &entries[offset];
-                entry->seqId      = buffer[pos].seqId;
-                entry->position_j = buffer[pos].position_j;
-            }
-            prevKmer = kmerIdx;
-        }
-    }
-
-    // add k-mers of the sequence to the index table
-    void addSequence (Sequence* s, Indexer * idxer,
-                      IndexEntryLocalTmp * buffer,
-                      int threshold, char * diagonalScore){
-        // iterate over all k-mers of the sequence and add the id of s to the sequence list of the k-mer (tableDummy)
-        s->resetCurrPos();
-        idxer->reset();
-        size_t kmerPos = 0;
-        bool removeX = (s->getSequenceType() == Sequence::NUCLEOTIDES ||
-                        s->getSequenceType() == Sequence::AMINO_ACIDS);
-        const int xIndex = s->subMat->aa2int[(int)'X'];
-        while (s->hasNextKmer()){
-            const int * kmer = s->nextKmer();
-            if(removeX){
-                int xCount = 0;
-                for(int pos = 0; pos < kmerSize; pos++){
-                    xCount += (kmer[pos] == xIndex);
-                }
-                if(xCount > 0){
-                    continue;
-                }
-            }
-            if(threshold > 0) {
-                int score = 0;
-                for (int pos = 0; pos < kmerSize; pos++) {
-                    score += diagonalScore[kmer[pos]];
-                }
-                if (score < threshold) {
-                    continue;
-                }
-            }
-            unsigned int kmerIdx = idxer->int2index(kmer, 0, kmerSize);
-            // if region got masked do not add kmer
-            if (offsets[kmerIdx + 1] - offsets[kmerIdx] == 0)
-                continue;
-
-            buffer[kmerPos].kmer = kmerIdx;
-            buffer[kmerPos].seqId      = s->getId();
-            buffer[kmerPos].position_j = s->getCurrentPosition();
-            kmerPos++;
-        }
-
-        if(kmerPos>1){
-            std::sort(buffer, buffer+kmerPos, IndexEntryLocalTmp::comapreByIdAndPos);
-        }
-
-        unsigned int prevKmer = UINT_MAX;
-        for(size_t pos = 0; pos < kmerPos; pos++){
-            unsigned int kmerIdx = buffer[pos].kmer;
-            if(kmerIdx != prevKmer){
-                size_t offset = __sync_fetch_and_add(&(offsets[kmerIdx]), 1);
-                IndexEntryLocal *entry = &entries[offset];
-                entry->seqId      = buffer[pos].seqId;
-                entry->position_j = buffer[pos].position_j;
-            }
-            prevKmer = kmerIdx;
-        }
-    }
-
     // prints the IndexTable
     void print(char *int2aa) {
+        std::vector<IndexEntryLocal> unpacked;
         for (size_t i = 0; i < tableSize; i++) {
-            ptrdiff_t entrySize = offsets[i + 1] - offsets[i];
+            size_t entrySize = getDBSeqListSize(i);
             if (entrySize > 0) {
                 indexer->printKmer(i, kmerSize, int2aa);
 
                 Debug(Debug::INFO) << "\n";
-                IndexEntryLocal *e = &entries[offsets[i]];
+                IndexEntryLocal *e;
+                if (compressed) {
+                    unpacked.resize(entrySize);
+                    unpackDBSeqList(getPackedDBSeqList(i, &entrySize), entrySize, &unpacked[0]);
+                    e = &unpacked[0];
+                } else {
+                    e = &entries[offsets[i]];
+                }
                 for (unsigned int j = 0; j < entrySize; j++) {
                     Debug(Debug::INFO) << "\t(" << e[j].seqId << ", " << e[j].position_j << ")\n";
                 }
@@ -453,6 +483,144 @@ public:
 
 
 protected:
+    static inline const unsigned char *readVarint(const unsigned char *data, size_t *value) {
+        size_t result = 0;
+        unsigned int shift = 0;
+        while (*data & 0x80) {
+            result |= ((size_t) (*data & 0x7F)) << shift;
+            shift += 7;
+            data++;
+        }
+        *value = result | (((size_t) *data) << shift);
+        return data + 1;
+    }
+
+    static inline unsigned char *writeVarint(unsigned char *data, size_t value) {
+        while (value >= 0x80) {
+            *data++ = (unsigned char) (value | 0x80);
+            value >>= 7;
+        }
+        *data++ = (unsigned char) value;
+        return data;
+    }
+
+    static inline unsigned int bitWidth(size_t value) {
+        return (value == 0) ? 0 : (64 - __builtin_clzll(value));
+    }
+
+    // sorts the k-mers appended after start and removes repeated k-mers, returns the remaining count
+    static size_t uniqueKmers(std::vector<IndexEntryLocalTmp> &buffer, size_t start) {
+        if (buffer.size() - start > 1) {
+            std::sort(buffer.begin() + start, buffer.end(), IndexEntryLocalTmp::comapreByIdAndPos);
+        }
+        size_t end = start;
+        unsigned int prevKmer = UINT_MAX;
+        for (size_t pos = start; pos < buffer.size(); pos++) {
+            if (buffer[pos].kmer != prevKmer) {
+                buffer[end++] = buffer[pos];
+            }
+            prevKmer = buffer[pos].kmer;
+        }
+        buffer.resize(end);
+        return end - start;
+    }
+
+    // bytes needed to pack the list, optionally returns the field widths
+    static size_t packedListSize(const IndexEntryLocal *list, size_t listSize, unsigned int *seqBits, unsigned int *posBits) {
+        unsigned char header[20];
+        if (listSize == 1) {
+            return writeVarint(writeVarint(header, list[0].seqId), list[0].position_j) - header;
+        }
+        unsigned int maxDelta = 0;
+        unsigned short maxPos = list[0].position_j;
+        for (size_t i = 1; i < listSize; i++) {
+            maxDelta = std::max(maxDelta, list[i].seqId - list[i - 1].seqId);
+            maxPos = std::max(maxPos, list[i].position_j);
+        }
+        unsigned int deltaWidth = bitWidth(maxDelta);
+        unsigned int posWidth = bitWidth(maxPos);
+        if (seqBits != NULL) {
+            *seqBits = deltaWidth;
+            *posBits = posWidth;
+        }
+        size_t headerSize = writeVarint(header, list[0].seqId) - header + 2;
+        return headerSize + (posWidth + (listSize - 1) * (deltaWidth + posWidth) + 7) / 8;
+    }
+
+    static unsigned char *packList(const IndexEntryLocal *list, size_t listSize, unsigned char *out) {
+        if (listSize == 1) {
+            return writeVarint(writeVarint(out, list[0].seqId), list[0].position_j);
+        }
+        unsigned int seqBits;
+        unsigned int posBits;
+        packedListSize(list, listSize, &seqBits, &posBits);
+        out = writeVarint(out, list[0].seqId);
+        *out++ = (unsigned char) seqBits;
+        *out++ = (unsigned char) posBits;
+
+        uint64_t buffer = list[0].position_j;
+        unsigned int bufferBits = posBits;
+        for (size_t i = 1; i <= listSize; i++) {
+            while (bufferBits >= 8) {
+                *out++ = (unsigned char) buffer;
+                buffer >>= 8;
+                bufferBits -= 8;
+            }
+            if (i == listSize) {
+                break;
+            }
+            const uint64_t field = (list[i].seqId - list[i - 1].seqId) | (((uint64_t) list[i].position_j) << seqBits);
+            buffer |= field << bufferBits;
+            bufferBits += seqBits + posBits;
+        }
+        if (bufferBits > 0) {
+            *out++ = (unsigned char) buffer;
+        }
+        return out;
+    }
+
+    // packs the lists of the bucket into out and returns the bytes written, out may be NULL to only count them
+    size_t packBucket(size_t bucket, unsigned char *out) {
+        const size_t from = bucket * BUCKET_SIZE;
+        const size_t to = std::min(tableSize, from + BUCKET_SIZE);
+        unsigned short mask = 0;
+        unsigned char listHeader[BUCKET_SIZE * 20];
+        unsigned char *listHeaderEnd = listHeader;
+        size_t listBytes = 0;
+        for (size_t kmer = from; kmer < to; kmer++) {
+            const size_t listSize = offsets[kmer + 1] - offsets[kmer];
+            if (listSize > 0) {
+                mask |= (unsigned short) (1u << (kmer - from));
+                const size_t bytes = packedListSize(entries + offsets[kmer], listSize, NULL, NULL);
+                listHeaderEnd = writeVarint(writeVarint(listHeaderEnd, listSize), bytes);
+                listBytes += bytes;
+            }
+        }
+        unsigned char header[sizeof(unsigned short) + 10];
+        memcpy(header, &mask, sizeof(unsigned short));
+        const size_t headerSize = writeVarint(header + sizeof(unsigned short), listHeaderEnd - listHeader) - header;
+        const size_t listHeaderSize = listHeaderEnd - listHeader;
+        if (out != NULL) {
+            memcpy(out, header, headerSize);
+            memcpy(out + headerSize, listHeader, listHeaderSize);
+            unsigned char *list = out + headerSize + listHeaderSize;
+            for (size_t kmer = from; kmer < to; kmer++) {
+                const size_t listSize = offsets[kmer + 1] - offsets[kmer];
+                if (listSize > 0) {
+                    list = packList(entries + offsets[kmer], listSize, list);
+                }
+            }
+        }
+        return headerSize + listHeaderSize + listBytes;
+    }
+
+    size_t getBucketCount() {
+        return (tableSize + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    }
+
+    // k-mers per bucket of a compressed table, limited by the 16 bit mask
+    static const size_t BUCKET_SIZE = 16;
+
     // alphabetSize**kmerSize
     const size_t tableSize;
     const int alphabetSize;
@@ -472,6 +640,15 @@ protected:
     IndexEntryLocal *entries;
     size_t *offsets;
 
+    // entries are replaced by the packed lists and offsets are byte offsets into them
+    bool compressed;
+    unsigned char *packedEntries;
+    // includes the padding of the last list
+    size_t packedEntriesSize;
+
+    Util::HugePageType entriesPageType;
+    Util::HugePageType offsetsPageType;
+
     // sequence lookup
     SequenceLookup *sequenceLookup;
 };
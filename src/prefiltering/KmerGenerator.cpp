@@ -3,8 +3,53 @@
 #include <MathUtil.h>
 #include "simd.h"
 
+namespace SIMD_KERNEL_NAMESPACE {
+
+int calculateArrayProduct(const short        * __restrict scoreArray1,
+                          const unsigned int * __restrict indexArray1,
+                          const size_t array1Size,
+                          const short        * __restrict scoreArray2,
+                          const unsigned int * __restrict indexArray2,
+                          const size_t array2Size,
+                          short              * __restrict outputScoreArray,
+                          unsigned int       * __restrict outputIndexArray,
+                          const size_t maxResultSize,
+                          const short threshold,
+                          const short cutoff1,
+                          const short possibleRest,
+                          const unsigned int pow){
+    size_t counter=0;
+    for(size_t i = 0 ; i< array1Size;i++){
+        const short score_i = scoreArray1[i];
+        const unsigned int kmer_i = indexArray1[i];
+        if(score_i < cutoff1 )
+            break;
+        const short cutoff2=threshold-score_i-possibleRest;
+        // count the elements above the cutoff first, the loop below has a fixed trip count and is vectorized
+        size_t elements = 0;
+        while(elements < array2Size && scoreArray2[elements] >= cutoff2){
+            elements++;
+        }
+        elements = std::min(elements, maxResultSize - 1 - counter);
+        short * __restrict outputScore = outputScoreArray + counter;
+        unsigned int * __restrict outputIndex = outputIndexArray + counter;
+        for(size_t j = 0; j < elements; j++){
+            outputScore[j] = score_i + scoreArray2[j];
+            outputIndex[j] = kmer_i + (indexArray2[j] * pow);
+        }
+        counter += elements;
+        if(counter+1 >= maxResultSize){
+            return counter;
+        }
+    }
+    return counter;
+}
+
+}
 
+#ifndef SIMD_KERNEL_VARIANT
 KmerGenerator::KmerGenerator(size_t kmerSize, size_t alphabetSize, short threshold ){
+    this->arrayProduct = SIMD_KERNEL_DISPATCH(calculateArrayProduct);
     this->threshold = threshold;
     this->kmerSize = kmerSize;
     this->indexer = new Indexer((int) alphabetSize, (int)kmerSize);
@@ -145,17 +190,19 @@ ScoreMatrix KmerGenerator::generateKmerList(const int * int_seq){
         const short        * nextScoreArray = &nextScoreMatrix->score[index*nextScoreMatrix->rowSize];
         const unsigned int * nextIndexArray = &nextScoreMatrix->index[index*nextScoreMatrix->rowSize];
 
-        const int lastElm=calculateArrayProduct(inputScoreArray,
-                                                inputIndexArray,
-                                                sizeInputMatrix,
-                                                nextScoreArray,
-                                                nextIndexArray,
-                                                nextScoreMatrix->elementSize,
-                                                outputScoreArray[i],
-                                                outputIndexArray[i],
-                                                cutoff1,
-                                                possibleRest[i+1],
-                                                stepMultiplicator[i+1]);
+        const int lastElm=arrayProduct(inputScoreArray,
+                                       inputIndexArray,
+                                       sizeInputMatrix,
+                                       nextScoreArray,
+                                       nextIndexArray,
+                                       nextScoreMatrix->elementSize,
+                                       outputScoreArray[i],
+                                       outputIndexArray[i],
+                                       MAX_KMER_RESULT_SIZE,
+                                       this->threshold,
+                                       cutoff1,
+                                       possibleRest[i+1],
+                                       stepMultiplicator[i+1]);
 
         inputScoreArray = this->outputScoreArray[i];
         inputIndexArray = this->outputIndexArray[i];
@@ -181,37 +228,4 @@ ScoreMatrix KmerGenerator::generateKmerList(const int * int_seq){
 //    }
     return ScoreMatrix(outputScoreArray[i-1], outputIndexArray[i-1], sizeInputMatrix, MAX_KMER_RESULT_SIZE);
 }
-
-
-int KmerGenerator::calculateArrayProduct(const short        * __restrict scoreArray1,
-                                         const unsigned int * __restrict indexArray1,
-                                         const size_t array1Size,
-                                         const short        * __restrict scoreArray2,
-                                         const unsigned int * __restrict indexArray2,
-                                         const size_t array2Size,
-                                         short              * __restrict outputScoreArray,
-                                         unsigned int       * __restrict outputIndexArray,
-                                         const short cutoff1,
-                                         const short possibleRest,
-                                         const unsigned int pow){
-    int counter=0;
-    for(size_t i = 0 ; i< array1Size;i++){
-        const short score_i = scoreArray1[i];
-        const unsigned int kmer_i = indexArray1[i];
-        if(score_i < cutoff1 )
-            break;
-        const short cutoff2=this->threshold-score_i-possibleRest;
-        for(size_t j = 0; j < array2Size && (counter+1 < (int) MAX_KMER_RESULT_SIZE) && (scoreArray2[j] >= cutoff2); j++){
-            const short score_j       = scoreArray2[j];
-            const unsigned int kmer_j = indexArray2[j];
-            outputScoreArray[counter]=score_i+score_j;
-            outputIndexArray[counter]=kmer_i+(kmer_j*pow);
-            counter++;
-        }
-        if(counter+1 >= (int) MAX_KMER_RESULT_SIZE){
-            return counter;
-        }
-    }
-    return counter;
-}
-
+#endif
@@ -5,7 +5,23 @@
 #include "Indexer.h"
 #include "ScoreMatrix.h"
 #include "Debug.h"
+#include "SimdDispatch.h"
 
+/* creates the product between two arrays and writes the elements above the score threshold to the output array,
+   the input arrays are sorted by score */
+SIMD_KERNEL_DECLARE(int calculateArrayProduct(const short        * __restrict scoreArray1,
+                                              const unsigned int * __restrict indexArray1,
+                                              const size_t array1Size,
+                                              const short        * __restrict scoreArray2,
+                                              const unsigned int * __restrict indexArray2,
+                                              const size_t array2Size,
+                                              short              * __restrict outputScoreArray,
+                                              unsigned int       * __restrict outputIndexArray,
+                                              const size_t maxResultSize,
+                                              const short threshold,
+                                              const short cutoff1,
+                                              const short possibleRest,
+                                              const unsigned int pow))
 
 class KmerGenerator 
 {
@@ -25,21 +41,12 @@ class KmerGenerator
 
 	void setThreshold(short threshold);
     private:
-    
-        /*creates the product between two arrays and write it to the output array */
-        int calculateArrayProduct(const short        * __restrict scoreArray1,
-                                  const unsigned int * __restrict indexArray1,
-                                  const size_t array1Size,
-                                  const short        * __restrict scoreArray2,
-                                  const unsigned int * __restrict indexArray2,
-                                  const size_t array2Size,
-                                  short              * __restrict outputScoreArray,
-                                  unsigned int       * __restrict outputIndexArray,
-                                  const short cutoff1,
-                                  const short possibleRest,
-                                  const unsigned int pow);
-    
-    
+        /* calculateArrayProduct for the instruction set of the CPU */
+        int (*arrayProduct)(const short *, const unsigned int *, const size_t,
+                            const short *, const unsigned int *, const size_t,
+                            short *, unsigned int *, const size_t,
+                            const short, const short, const short, const unsigned int);
+
         /* maximum return values */
         /* 48   MB */
         const static size_t MAX_KMER_RESULT_SIZE = 262144*32;
@@ -1,5 +1,7 @@
 
 #include "Prefiltering.h"
+#include "Alignment.h"
+#include "FileUtil.h"
 #include "Util.h"
 #include "Parameters.h"
 #include "MMseqsMPI.h"
@@ -53,3 +55,60 @@ int prefilter(int argc, const char **argv, const Command& command) {
 
     return EXIT_SUCCESS;
 }
+
+int prefilteralign(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, 3, true, 0, MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_ALIGN);
+
+#ifdef OPENMP
+    omp_set_num_threads(par.threads);
+#endif
+
+    Timer timer;
+    Debug(Debug::INFO) << "Initialising data structures...\n";
+
+    int queryDbType = DBReader<unsigned int>::parseDbType(par.db1.c_str());
+    int targetDbType = DBReader<unsigned int>::parseDbType(par.db2.c_str());
+    if (queryDbType == -1 || targetDbType == -1) {
+        Debug(Debug::ERROR) << "Please recreate your database or add a .dbtype file to your sequence/profile database.\n";
+        return EXIT_FAILURE;
+    }
+    if (queryDbType == Sequence::HMM_PROFILE && targetDbType == Sequence::HMM_PROFILE) {
+        Debug(Debug::ERROR) << "Only the query OR the target database can be a profile database.\n";
+        return EXIT_FAILURE;
+    }
+    if (queryDbType != Sequence::HMM_PROFILE && targetDbType == Sequence::PROFILE_STATE_SEQ) {
+        Debug(Debug::ERROR) << "The query has to be a profile when using a target profile state database.\n";
+        return EXIT_FAILURE;
+    }
+    // profile state targets are aligned against their sequences
+    std::string alignmentTarget = par.db2;
+    if (targetDbType == Sequence::PROFILE_STATE_SEQ) {
+        alignmentTarget.append(".255");
+    }
+    if (queryDbType == Sequence::HMM_PROFILE && targetDbType == Sequence::PROFILE_STATE_SEQ) {
+        queryDbType = Sequence::PROFILE_STATE_PROFILE;
+    }
+
+    Prefiltering pref(par.db2, par.db2Index, queryDbType, targetDbType, par);
+    Alignment aln(par.db1, par.db1Index, alignmentTarget, alignmentTarget + ".index", "", "", par.db3, par.db3Index, par);
+    Debug(Debug::INFO) << "Time for init: " << timer.lap() << "\n";
+
+    if (pref.setAligner(&aln, par.maxAccept, par.maxRejected)) {
+        pref.runAllSplits(par.db1, par.db1Index, par.db3, par.db3Index);
+    } else {
+        Debug(Debug::INFO) << "Target database is split, writing a prefilter database for the alignment.\n";
+        std::string prefDB = par.db3 + "_pref";
+        std::string prefDBIndex = prefDB + ".index";
+        pref.runAllSplits(par.db1, par.db1Index, prefDB, prefDBIndex);
+
+        Alignment splitAln(par.db1, par.db1Index, alignmentTarget, alignmentTarget + ".index",
+                           prefDB, prefDBIndex, par.db3, par.db3Index, par);
+        splitAln.run(par.maxAccept, par.maxRejected);
+
+        DBReader<unsigned int>::removeDb(prefDB, prefDBIndex);
+    }
+    Debug(Debug::INFO) << "Time for prefiltering and alignment: " << timer.lap() << "\n";
+
+    return EXIT_SUCCESS;
+}
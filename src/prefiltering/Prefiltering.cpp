@@ -7,15 +7,24 @@
 #include "FileUtil.h"
 #include "IndexBuilder.h"
 #include "Timer.h"
+#include "Numa.h"
+#include "Alignment.h"
+#include "Checkpoint.h"
+#include "SharedIndex.h"
 
 namespace prefilter {
 #include "ExpOpt3_8_polished.cs32.lib.h"
 }
 
+#include <algorithm>
+#include <sys/stat.h>
+
 #ifdef OPENMP
 #include <omp.h>
 #endif
 
+extern const char* version;
+
 Prefiltering::Prefiltering(const std::string &targetDB,
                            const std::string &targetDBIndex,
                            int querySeqType, int targetSeqType_,
@@ -42,21 +51,41 @@ Prefiltering::Prefiltering(const std::string &targetDB,
         covThr(par.covThr), covMode(par.covMode), includeIdentical(par.includeIdentity),
         earlyExit(par.earlyExit),
         noPreload(par.noPreload),
-        threads(static_cast<unsigned int>(par.threads)) {
+        threads(static_cast<unsigned int>(par.threads)),
+        checkpointChunks(par.checkpointChunks), checkpointParameters(Checkpoint::describeParameters(par, par.prefilter)),
+        writerMode((par.compressed ? DBWriter::COMPRESSED_MODE : DBWriter::ASCII_MODE)
+                   | (par.asyncWrite ? DBWriter::ASYNC_MODE : 0)
+                   | (par.binaryOutput ? DBWriter::BINARY_MODE : 0)),
+        finalWriterMode(writerMode | (par.shardedOutput ? DBWriter::SHARDED_MODE : 0)),
+        binaryOutput(par.binaryOutput),
+        outputDbType(par.binaryOutput ? DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY : -1),
+        aligner(NULL), alignMaxAccept(0), alignMaxRejected(0),
+        numaMode(par.numaMode), placedIndexTable(NULL), compressIndex(par.compressIndex), prefaultRunning(false),
+        shareIndex(par.sharedIndex), sharedIndex(NULL), queryStats(par.queryStats),
+        pipelineSplits(par.pipelineSplits), nextBuildRunning(false), nextBuildSplit(SIZE_MAX),
+        buildSeconds(0.0), buildWaitSeconds(0.0), matchSeconds(0.0) {
 #ifdef OPENMP
     Debug(Debug::INFO) << "Using " << threads << " threads.\n";
 #endif
+    if (numaMode != Numa::MODE_OFF) {
+        numaNodes = Numa::getNodeCpus();
+        if (numaNodes.size() < 2) {
+            Debug(Debug::INFO) << "Single NUMA node, ignoring --numa-mode.\n";
+            numaNodes.clear();
+        }
+    }
 
     int minKmerThr = INT_MIN;
     std::string indexDB = PrefilteringIndexReader::searchForIndex(targetDB);
     if (indexDB != "") {
         Debug(Debug::INFO) << "Use index  " << indexDB << "\n";
 
-        int dataMode = DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA;
-        if (noPreload == false) {
-            dataMode |= DBReader<unsigned int>::USE_FREAD;
+        // the blocks are page aligned and used in place, reading the whole index before the first query is not needed
+        tdbr = new DBReader<unsigned int>(indexDB.c_str(), (indexDB + ".index").c_str());
+        // index blocks are referenced for the whole run and cannot be read entry by entry
+        if (tdbr->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD) {
+            tdbr->setLoadMode(DBReader<unsigned int>::LOAD_MODE_MMAP);
         }
-        tdbr = new DBReader<unsigned int>(indexDB.c_str(), (indexDB + ".index").c_str(), dataMode);
         tdbr->open(DBReader<unsigned int>::NOSORT);
         templateDBIsIndex = PrefilteringIndexReader::checkIfIndexFile(tdbr);
         if (templateDBIsIndex == true) {
@@ -79,6 +108,7 @@ Prefiltering::Prefiltering(const std::string &targetDB,
             spacedKmer = data.spacedKmer != 0;
             minKmerThr = data.kmerThr;
             scoringMatrixFile = PrefilteringIndexReader::getSubstitutionMatrixName(tidxdbr);
+            compressIndex = PrefilteringIndexReader::isCompressed(tidxdbr);
         } else {
             Debug(Debug::ERROR) << "Outdated index version. Please recompute it with 'createindex'!\n";
             EXIT(EXIT_FAILURE);
@@ -139,14 +169,13 @@ Prefiltering::Prefiltering(const std::string &targetDB,
     }
 
     int originalSplits = splits;
-    size_t memoryLimit;
     if (par.splitMemoryLimit > 0) {
         memoryLimit = static_cast<size_t>(par.splitMemoryLimit) * 1024;
     } else {
         memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
     }
     setupSplit(*tdbr, alphabetSize - 1, querySeqType,
-               threads, templateDBIsIndex, maxResListLen,
+               threads, templateDBIsIndex, compressIndex, shareIndex, maxResListLen,
                memoryLimit, &kmerSize, &splits, &splitMode);
 
     if(targetSeqType != Sequence::NUCLEOTIDES){
@@ -169,6 +198,20 @@ Prefiltering::Prefiltering(const std::string &targetDB,
 
     Debug(Debug::INFO) << "Target database: " << targetDB << "(Size: " << tdbr->getSize() << ")\n";
 
+    if (checkpointChunks > 1 && (splitMode == Parameters::QUERY_DB_SPLIT || splits == 1)) {
+        // the whole index fits, the queries are split into chunks that are committed one by one
+        splitMode = Parameters::QUERY_DB_SPLIT;
+        splits = std::max(splits, checkpointChunks);
+    }
+
+    if (templateDBIsIndex == true && noPreload == false) {
+        if (pthread_create(&prefaultThread, NULL, prefaultThreadMain, tidxdbr) != 0) {
+            Debug(Debug::ERROR) << "Could not start index prefault thread\n";
+            EXIT(EXIT_FAILURE);
+        }
+        prefaultRunning = true;
+    }
+
     if (splitMode == Parameters::QUERY_DB_SPLIT) {
         // create the whole index table
         getIndexTable(0, 0, tdbr->getSize());
@@ -185,6 +228,8 @@ Prefiltering::Prefiltering(const std::string &targetDB,
 }
 
 Prefiltering::~Prefiltering() {
+    joinPrefault();
+    freeNodeReplicas();
     if (indexTable != NULL) {
         delete indexTable;
     }
@@ -192,6 +237,9 @@ Prefiltering::~Prefiltering() {
     if (sequenceLookup != NULL) {
         delete sequenceLookup;
     }
+    if (sharedIndex != NULL) {
+        delete sharedIndex;
+    }
 
     tdbr->close();
     delete tdbr;
@@ -211,7 +259,20 @@ Prefiltering::~Prefiltering() {
     }
 }
 
+void *Prefiltering::prefaultThreadMain(void *arg) {
+    PrefilteringIndexReader::prefaultIndex((DBReader<unsigned int> *) arg);
+    return NULL;
+}
+
+void Prefiltering::joinPrefault() {
+    if (prefaultRunning) {
+        pthread_join(prefaultThread, NULL);
+        prefaultRunning = false;
+    }
+}
+
 void Prefiltering::reopenTargetDb() {
+    joinPrefault();
     if (templateDBIsIndex == true) {
         tidxdbr->close();
         delete tidxdbr;
@@ -234,18 +295,19 @@ void Prefiltering::reopenTargetDb() {
 }
 
 void Prefiltering::setupSplit(DBReader<unsigned int>& dbr, const int alphabetSize, const unsigned int querySeqTyp, const int threads,
-                              const bool templateDBIsIndex, const size_t maxResListLen, const size_t memoryLimit,
-                              int *kmerSize, int *split, int *splitMode) {
+                              const bool templateDBIsIndex, const bool compressedIndex, const bool publishIndex, const size_t maxResListLen,
+                              const size_t memoryLimit, int *kmerSize, int *split, int *splitMode) {
     size_t neededSize = estimateMemoryConsumption(1,
                                                   dbr.getSize(), dbr.getAminoAcidDBSize(),  maxResListLen, alphabetSize,
                                                   *kmerSize == 0 ? // if auto detect kmerSize
                                                   IndexTable::computeKmerSize(dbr.getAminoAcidDBSize()) : *kmerSize, querySeqTyp,
-                                                  threads);
+                                                  threads, compressedIndex, publishIndex);
     if (neededSize > 0.9 * memoryLimit) {
         // memory is not enough to compute everything at once
         //TODO add PROFILE_STATE (just 6-mers)
         std::pair<int, int> splitSettings = Prefiltering::optimizeSplit(memoryLimit, &dbr,
-                                                                        alphabetSize, *kmerSize, querySeqTyp, threads);
+                                                                        alphabetSize, *kmerSize, querySeqTyp, threads,
+                                                                        compressedIndex, publishIndex);
         if (splitSettings.second == -1) {
             Debug(Debug::ERROR) << "Can not fit databased into " << memoryLimit
                                 << " byte. Please use a computer with more main memory.\n";
@@ -291,7 +353,8 @@ void Prefiltering::setupSplit(DBReader<unsigned int>& dbr, const int alphabetSiz
     Debug(Debug::INFO) << "Use kmer size " << *kmerSize << " and split "
                        << *split << " using " << Parameters::getSplitModeName(*splitMode) << " split mode.\n";
     neededSize = estimateMemoryConsumption((*splitMode == Parameters::TARGET_DB_SPLIT) ? *split : 1, dbr.getSize(),
-                                           dbr.getAminoAcidDBSize(), maxResListLen, alphabetSize, *kmerSize, querySeqTyp, threads);
+                                           dbr.getAminoAcidDBSize(), maxResListLen, alphabetSize, *kmerSize, querySeqTyp, threads,
+                                           compressedIndex, publishIndex);
     Debug(Debug::INFO) << "Needed memory (" << neededSize << " byte) of total memory (" << memoryLimit
                        << " byte)\n";
     if (neededSize > 0.9 * memoryLimit) {
@@ -303,12 +366,39 @@ void Prefiltering::setupSplit(DBReader<unsigned int>& dbr, const int alphabetSiz
     }
 }
 
+// the hits of every split are already sorted, merging these runs avoids sorting all hits again
+static void mergeSortedRuns(std::vector<hit_t> &hits) {
+    std::vector<size_t> runStarts;
+    runStarts.push_back(0);
+    for (size_t i = 1; i < hits.size(); i++) {
+        if (hit_t::compareHitsByPValueAndId(hits[i], hits[i - 1])) {
+            runStarts.push_back(i);
+        }
+    }
+    runStarts.push_back(hits.size());
+    // merge neighbouring runs pairwise until a single run is left
+    while (runStarts.size() > 2) {
+        std::vector<size_t> merged;
+        size_t i = 0;
+        for (; i + 2 < runStarts.size(); i += 2) {
+            std::inplace_merge(hits.begin() + runStarts[i], hits.begin() + runStarts[i + 1],
+                               hits.begin() + runStarts[i + 2], hit_t::compareHitsByPValueAndId);
+            merged.push_back(runStarts[i]);
+        }
+        for (; i < runStarts.size() - 1; i++) {
+            merged.push_back(runStarts[i]);
+        }
+        merged.push_back(hits.size());
+        runStarts.swap(merged);
+    }
+}
+
 void Prefiltering::mergeOutput(const std::string &outDB, const std::string &outDBIndex,
                                const std::vector<std::pair<std::string, std::string>> &filenames) {
     Timer timer;
     if (filenames.size() < 2) {
         std::rename(filenames[0].first.c_str(), outDB.c_str());
-        std::rename(filenames[0].second.c_str(), outDBIndex.c_str());
+        DBReader<unsigned int>::moveIndex(filenames[0].second, outDBIndex);
         Debug(Debug::INFO) << "No merging needed.\n";
         return;
     }
@@ -318,7 +408,7 @@ void Prefiltering::mergeOutput(const std::string &outDB, const std::string &outD
                                                                    (outDBIndex + "_merged"));
 
 
-    DBWriter writer(out.first.c_str(), out.second.c_str(), 1);
+    DBWriter writer(out.first.c_str(), out.second.c_str(), 1, writerMode);
     writer.open(1024 * 1024 * 1024); // 1 GB buffer
     writer.mergeFilePair(filenames);
     writer.close();
@@ -329,8 +419,7 @@ void Prefiltering::mergeOutput(const std::string &outDB, const std::string &outD
             Debug(Debug::ERROR) << "Error while deleting " << filenames[i].first << " in mergeOutput!\n";
             EXIT(EXIT_FAILURE);
         }
-        error = remove(filenames[i].second.c_str());
-        if(error != 0){
+        if (DBReader<unsigned int>::removeIndex(filenames[i].second) == false) {
             Debug(Debug::ERROR) << "Error while deleting " << filenames[i].second << " in mergeOutput!\n";
             EXIT(EXIT_FAILURE);
         }
@@ -338,7 +427,7 @@ void Prefiltering::mergeOutput(const std::string &outDB, const std::string &outD
     // sort merged entries by evalue
     DBReader<unsigned int> dbr(out.first.c_str(), out.second.c_str());
     dbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
-    DBWriter dbw(outDB.c_str(), outDBIndex.c_str(), threads);
+    DBWriter dbw(outDB.c_str(), outDBIndex.c_str(), threads, finalWriterMode);
     dbw.open(1024 * 1024 * 1024);
 #pragma omp parallel
     {
@@ -353,11 +442,20 @@ void Prefiltering::mergeOutput(const std::string &outDB, const std::string &outD
 #endif
             unsigned int dbKey = dbr.getDbKey(id);
             char *data = dbr.getData(id);
-            std::vector<hit_t> hits = QueryMatcher::parsePrefilterHits(data);
+            std::vector<hit_t> hits;
+            if (binaryOutput) {
+                hits = QueryMatcher::parseBinaryPrefilterHits(data, dbr.getSeqLens(id));
+            } else {
+                hits = QueryMatcher::parsePrefilterHits(data);
+            }
             if (hits.size() > 1) {
-                std::sort(hits.begin(), hits.end(), hit_t::compareHitsByPValueAndId);
+                mergeSortedRuns(hits);
             }
             for(size_t hit_id = 0; hit_id < hits.size(); hit_id++){
+                if (binaryOutput) {
+                    prefResultsOutString.append((const char *) &hits[hit_id], sizeof(hit_t));
+                    continue;
+                }
                 int len = QueryMatcher::prefilterHitToBuffer(buffer, hits[hit_id]);
                 prefResultsOutString.append(buffer, len);
             }
@@ -373,8 +471,7 @@ void Prefiltering::mergeOutput(const std::string &outDB, const std::string &outD
         Debug(Debug::ERROR) << "Error while deleting " << out.first << " in mergeOutput!\n";
         EXIT(EXIT_FAILURE);
     }
-    error = remove(out.second.c_str());
-    if(error != 0){
+    if (DBReader<unsigned int>::removeIndex(out.second) == false) {
         Debug(Debug::ERROR) << "Error while deleting " << out.second << " in mergeOutput!\n";
         EXIT(EXIT_FAILURE);
     }
@@ -424,31 +521,278 @@ void Prefiltering::getIndexTable(int split, size_t dbFrom, size_t dbSize) {
     }
 
     Timer timer;
+    std::string sharedName;
+    if (shareIndex) {
+        sharedName = SharedIndex::getName(getSharedIndexKey(dbFrom, dbSize));
+        sharedIndex = SharedIndex::attach(sharedName);
+        if (sharedIndex != NULL) {
+            indexTable = sharedIndex->getIndexTable();
+            sequenceLookup = sharedIndex->getSequenceLookup();
+            Debug(Debug::INFO) << "Attached to shared index " << sharedName << " (" << sharedIndex->getSize() << " byte)\n";
+            Debug(Debug::INFO) << "Time for index table init: " << timer.lap() << "\n";
+            return;
+        }
+    }
+
+    buildIndexTable(dbFrom, dbSize, true, &indexTable, &sequenceLookup);
+    indexTable->printStatistics(subMat->int2aa);
+    if (sequenceLookup != NULL) {
+        Debug(Debug::INFO) << "Sequence lookup memory: " << Util::getHugePageTypeName(sequenceLookup->getDataPageType()) << "\n";
+    }
+    tdbr->remapData();
+    if (shareIndex) {
+        sharedIndex = SharedIndex::publish(sharedName, indexTable, sequenceLookup);
+        if (sharedIndex != NULL) {
+            // the process keeps using the shared copy like every other one
+            delete indexTable;
+            delete sequenceLookup;
+            indexTable = sharedIndex->getIndexTable();
+            sequenceLookup = sharedIndex->getSequenceLookup();
+            Debug(Debug::INFO) << "Published shared index " << sharedName << " (" << sharedIndex->getSize() << " byte)\n";
+        }
+    }
+    buildSeconds += timer.elapsedSeconds();
+    Debug(Debug::INFO) << "Time for index table init: " << timer.lap() << "\n";
+}
+
+int Prefiltering::getIndexKmerThr() {
+    return (querySeqType == Sequence::HMM_PROFILE ||
+            querySeqType == Sequence::PROFILE_STATE_PROFILE ||
+            querySeqType == Sequence::NUCLEOTIDES ||
+            (targetSeqType != Sequence::HMM_PROFILE && takeOnlyBestKmer == true) ) ? 0 : kmerThr;
+}
+
+std::string Prefiltering::getSharedIndexKey(size_t dbFrom, size_t dbSize) {
+    // a rewritten target database gets a new segment
+    std::string path = tdbr->getDataFileName();
+    char *absolutePath = realpath(tdbr->getDataFileName(), NULL);
+    if (absolutePath != NULL) {
+        path = absolutePath;
+        free(absolutePath);
+    }
+    struct stat sb;
+    if (stat(tdbr->getDataFileName(), &sb) != 0) {
+        memset(&sb, 0, sizeof(sb));
+    }
+    return path + " " + SSTR(sb.st_size) + " " + SSTR(sb.st_mtime) + "." + SSTR(DBReader<unsigned int>::getMtimeNsec(sb)) + " " + SSTR(dbFrom) + " " + SSTR(dbSize)
+           + " " + SSTR(targetSeqType) + " " + SSTR(kmerSize) + " " + SSTR(alphabetSize) + " " + SSTR(getIndexKmerThr())
+           + " " + SSTR(spacedKmer) + " " + SSTR(maskMode) + " " + SSTR(diagonalScoring) + " " + SSTR(compressIndex)
+           + " " + SSTR(aaBiasCorrection) + " " + SSTR(maxSeqLen) + " " + scoringMatrixFile + " " + version;
+}
 
+void Prefiltering::buildIndexTable(size_t dbFrom, size_t dbSize, bool remapData,
+                                   IndexTable **table, SequenceLookup **lookup) {
     Sequence tseq(maxSeqLen, targetSeqType, subMat, kmerSize, spacedKmer, aaBiasCorrection);
-    int localKmerThr = (querySeqType == Sequence::HMM_PROFILE ||
-                        querySeqType == Sequence::PROFILE_STATE_PROFILE ||
-                        querySeqType == Sequence::NUCLEOTIDES ||
-                        (targetSeqType != Sequence::HMM_PROFILE && takeOnlyBestKmer == true) ) ? 0 : kmerThr;
+    int localKmerThr = getIndexKmerThr();
 
     // remove X or N for seeding
     int adjustAlphabetSize = (targetSeqType == Sequence::NUCLEOTIDES || targetSeqType == Sequence::AMINO_ACIDS)
                        ? alphabetSize -1 : alphabetSize;
-    indexTable = new IndexTable(adjustAlphabetSize, kmerSize, false);
-    SequenceLookup **maskedLookup   = maskMode == 1 ? &sequenceLookup : NULL;
-    SequenceLookup **unmaskedLookup = maskMode == 0 ? &sequenceLookup : NULL;
+    *table = new IndexTable(adjustAlphabetSize, kmerSize, false);
+    *lookup = NULL;
+    SequenceLookup **maskedLookup   = maskMode == 1 ? lookup : NULL;
+    SequenceLookup **unmaskedLookup = maskMode == 0 ? lookup : NULL;
     
     Debug(Debug::INFO) << "Index table k-mer threshold: " << localKmerThr << "\n";
-    IndexBuilder::fillDatabase(indexTable, maskedLookup, unmaskedLookup, *subMat,  &tseq, tdbr, dbFrom, dbFrom + dbSize, localKmerThr);
+    IndexBuilder::fillDatabase(*table, maskedLookup, unmaskedLookup, *subMat,  &tseq, tdbr, dbFrom, dbFrom + dbSize, localKmerThr, remapData);
+    if (compressIndex) {
+        (*table)->compress();
+    }
 
     if (diagonalScoring == false) {
-        delete sequenceLookup;
-        sequenceLookup = NULL;
+        delete *lookup;
+        *lookup = NULL;
     }
+}
 
+bool Prefiltering::canPipelineSplits(size_t splitCount) {
+    if (templateDBIsIndex == true || splitMode != Parameters::TARGET_DB_SPLIT || splitCount != (size_t) splits) {
+        Debug(Debug::WARNING) << "Pipelined splits need a target split index table computed at runtime. Building splits one by one!\n";
+        return false;
+    }
+    // both threads read the target database, per-thread read and decompression buffers would be shared
+    if (tdbr->isCompressed() || tdbr->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD) {
+        Debug(Debug::WARNING) << "Pipelined splits need a mapped uncompressed target database. Building splits one by one!\n";
+        return false;
+    }
+    // the index table of the next split is held next to the current one
+    size_t neededSize = estimateMemoryConsumption(splitCount, tdbr->getSize(), tdbr->getAminoAcidDBSize(), maxResListLen,
+                                                  alphabetSize - 1, kmerSize, querySeqType, threads, compressIndex, shareIndex);
+    // unpacked entries are needed while it is built, see estimateMemoryConsumption
+    size_t tableSize = (tdbr->getAminoAcidDBSize() / splitCount) * 7
+                       + static_cast<size_t>(pow(alphabetSize - 1, kmerSize)) * sizeof(size_t *);
+    if (neededSize + tableSize > 0.9 * memoryLimit) {
+        Debug(Debug::WARNING) << "Two index tables need " << (neededSize + tableSize) << " byte, more than the memory limit of "
+                              << memoryLimit << " byte. Building splits one by one!\n";
+        return false;
+    }
+    return true;
+}
+
+void *Prefiltering::nextBuildThreadMain(void *arg) {
+    SplitBuild *build = (SplitBuild *) arg;
+#ifdef OPENMP
+    // the number of threads is set per thread, a new thread starts with the default
+    omp_set_num_threads(build->threads);
+#endif
+    Timer timer;
+    build->prefiltering->buildIndexTable(build->dbFrom, build->dbSize, false, &build->indexTable, &build->sequenceLookup);
+    build->seconds = timer.elapsedSeconds();
+    return NULL;
+}
+
+void Prefiltering::startNextBuild(size_t split, size_t splitCount) {
+    size_t dbFrom = 0;
+    size_t dbSize = 0;
+    Util::decomposeDomainByAminoAcid(tdbr->getAminoAcidDBSize(), tdbr->getSeqLens(), tdbr->getSize(),
+                                     split, splitCount, &dbFrom, &dbSize);
+    if (dbSize == 0) {
+        return;
+    }
+    Debug(Debug::INFO) << "Build index table of prefiltering step " << (split + 1) << " in the background\n";
+    nextBuild.prefiltering = this;
+    nextBuild.split = split;
+    nextBuild.dbFrom = dbFrom;
+    nextBuild.dbSize = dbSize;
+    // most cores keep matching, the build only has to finish before the current split does
+    nextBuild.threads = std::max(1u, threads / 4);
+    nextBuild.indexTable = NULL;
+    nextBuild.sequenceLookup = NULL;
+    nextBuild.seconds = 0.0;
+    if (pthread_create(&nextBuildThread, NULL, nextBuildThreadMain, &nextBuild) != 0) {
+        Debug(Debug::ERROR) << "Could not start index table build thread\n";
+        EXIT(EXIT_FAILURE);
+    }
+    nextBuildRunning = true;
+}
+
+void Prefiltering::finishNextBuild() {
+    Timer timer;
+    pthread_join(nextBuildThread, NULL);
+    nextBuildRunning = false;
+    buildWaitSeconds += timer.elapsedSeconds();
+    buildSeconds += nextBuild.seconds;
+
+    indexTable = nextBuild.indexTable;
+    sequenceLookup = nextBuild.sequenceLookup;
     indexTable->printStatistics(subMat->int2aa);
+    if (sequenceLookup != NULL) {
+        Debug(Debug::INFO) << "Sequence lookup memory: " << Util::getHugePageTypeName(sequenceLookup->getDataPageType()) << "\n";
+    }
     tdbr->remapData();
-    Debug(Debug::INFO) << "Time for index table init: " << timer.lap() << "\n";
+    Debug(Debug::INFO) << "Time for index table init: " << nextBuild.seconds << "s in the background, waited " << timer.lap() << "\n";
+}
+
+static void copyParallel(char *dst, const char *src, size_t size) {
+    const size_t chunkSize = 64 * 1024 * 1024;
+    const size_t chunks = (size + chunkSize - 1) / chunkSize;
+#pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < chunks; i++) {
+        size_t offset = i * chunkSize;
+        memcpy(dst + offset, src + offset, std::min(chunkSize, size - offset));
+    }
+}
+
+static size_t alignToCacheLine(size_t size) {
+    return (size + 63) & ~((size_t) 63);
+}
+
+void Prefiltering::placeIndexOnNodes() {
+    const size_t entriesSize = indexTable->getEntriesDataSize();
+    const size_t offsetsSize = indexTable->getOffsetsSize();
+    size_t lookupDataSize = 0;
+    size_t lookupOffsetsSize = 0;
+    if (sequenceLookup != NULL) {
+        lookupDataSize = sequenceLookup->getDataSize() + 1;
+        lookupOffsetsSize = (sequenceLookup->getSequenceCount() + 1) * sizeof(size_t);
+    }
+    const size_t replicaSize = alignToCacheLine(entriesSize) + alignToCacheLine(offsetsSize)
+                               + alignToCacheLine(lookupDataSize) + lookupOffsetsSize;
+
+    if (numaMode == Numa::MODE_REPLICATE) {
+        bool enoughMemory = true;
+        for (size_t node = 0; node < numaNodes.size(); node++) {
+            enoughMemory &= (Numa::getNodeFreeMemory(node) > replicaSize);
+        }
+        for (size_t node = 0; enoughMemory && node < numaNodes.size(); node++) {
+            NodeReplica replica;
+            replica.memorySize = replicaSize;
+            replica.memory = (char *) Util::allocHugePages(replicaSize, &replica.pageType);
+            if (replica.memory == NULL || Numa::bindMemory(replica.memory, replicaSize, node) == false) {
+                Util::freeHugePages(replica.memory, replicaSize, replica.pageType);
+                enoughMemory = false;
+                break;
+            }
+
+            char *entries = replica.memory;
+            char *offsets = entries + alignToCacheLine(entriesSize);
+            copyParallel(entries, indexTable->getEntriesData(), entriesSize);
+            copyParallel(offsets, (const char *) indexTable->getOffsets(), offsetsSize);
+            replica.indexTable = new IndexTable(indexTable->getAlphabetSize(), indexTable->getKmerSize(), true);
+            if (indexTable->isCompressed()) {
+                replica.indexTable->initPackedTableByExternalData(indexTable->getSize(), indexTable->getTableEntriesNum(),
+                                                                  (unsigned char *) entries, entriesSize, (size_t *) offsets);
+            } else {
+                replica.indexTable->initTableByExternalData(indexTable->getSize(), indexTable->getTableEntriesNum(),
+                                                            (IndexEntryLocal *) entries, (size_t *) offsets);
+            }
+
+            replica.sequenceLookup = NULL;
+            if (sequenceLookup != NULL) {
+                char *lookupData = offsets + alignToCacheLine(offsetsSize);
+                char *lookupOffsets = lookupData + alignToCacheLine(lookupDataSize);
+                copyParallel(lookupData, sequenceLookup->getData(), lookupDataSize);
+                copyParallel(lookupOffsets, (const char *) sequenceLookup->getOffsets(), lookupOffsetsSize);
+                replica.sequenceLookup = new SequenceLookup(sequenceLookup->getSequenceCount());
+                replica.sequenceLookup->initLookupByExternalData(lookupData, sequenceLookup->getDataSize(), (size_t *) lookupOffsets);
+            }
+            nodeReplicas.push_back(replica);
+        }
+
+        if (enoughMemory) {
+            Debug(Debug::INFO) << "Index table copied to " << numaNodes.size() << " NUMA nodes (" << replicaSize << " bytes each, "
+                               << Util::getHugePageTypeName(nodeReplicas[0].pageType) << ")\n";
+            return;
+        }
+        freeNodeReplicas();
+        Debug(Debug::INFO) << "Not enough memory to copy the index table to every NUMA node, interleaving it instead.\n";
+    }
+
+    bool interleaved = Numa::interleaveMemory(indexTable->getEntriesData(), entriesSize, numaNodes.size())
+                       && Numa::interleaveMemory(indexTable->getOffsets(), offsetsSize, numaNodes.size());
+    if (sequenceLookup != NULL) {
+        interleaved &= Numa::interleaveMemory((void *) sequenceLookup->getData(), lookupDataSize, numaNodes.size());
+    }
+    if (interleaved) {
+        Debug(Debug::INFO) << "Index table interleaved over " << numaNodes.size() << " NUMA nodes.\n";
+    } else {
+        Debug(Debug::WARNING) << "Could not interleave the index table over the NUMA nodes, only pinning threads.\n";
+    }
+}
+
+void Prefiltering::freeNodeReplicas() {
+    for (size_t i = 0; i < nodeReplicas.size(); i++) {
+        delete nodeReplicas[i].indexTable;
+        if (nodeReplicas[i].sequenceLookup != NULL) {
+            delete nodeReplicas[i].sequenceLookup;
+        }
+        Util::freeHugePages(nodeReplicas[i].memory, nodeReplicas[i].memorySize, nodeReplicas[i].pageType);
+    }
+    nodeReplicas.clear();
+}
+
+bool Prefiltering::setAligner(Alignment *aligner, unsigned int maxAlnNum, unsigned int maxRejected) {
+    if (splitMode == Parameters::TARGET_DB_SPLIT && splits > 1) {
+        return false;
+    }
+    this->aligner = aligner;
+    alignMaxAccept = maxAlnNum;
+    alignMaxRejected = maxRejected;
+    // the result databases are written and merged as alignment databases
+    writerMode = aligner->getWriterMode() & ~DBWriter::SHARDED_MODE;
+    finalWriterMode = aligner->getWriterMode();
+    outputDbType = aligner->getOutputDbType();
+    return true;
 }
 
 bool Prefiltering::isSameQTDB(const std::string &queryDB) {
@@ -467,6 +811,10 @@ bool Prefiltering::isSameQTDB(const std::string &queryDB) {
 
 void Prefiltering::runAllSplits(const std::string &queryDB, const std::string &queryDBIndex,
                                 const std::string &resultDB, const std::string &resultDBIndex) {
+    if (outputDbType == -1) {
+        // text results have no dbtype, one of an earlier binary run would describe them as binary
+        DBWriter::removeDbtypeFile(resultDB.c_str());
+    }
     runSplits(queryDB, queryDBIndex, resultDB, resultDBIndex, 0, splits);
 }
 
@@ -474,6 +822,9 @@ void Prefiltering::runAllSplits(const std::string &queryDB, const std::string &q
 void Prefiltering::runMpiSplits(const std::string &queryDB, const std::string &queryDBIndex,
                                 const std::string &resultDB, const std::string &resultDBIndex) {
 
+    if (outputDbType == -1 && MMseqsMPI::isMaster()) {
+        DBWriter::removeDbtypeFile(resultDB.c_str());
+    }
     splits = std::max(MMseqsMPI::numProc, splits);
     size_t fromSplit = 0;
     size_t splitCount = 1;
@@ -514,6 +865,9 @@ void Prefiltering::runMpiSplits(const std::string &queryDB, const std::string &q
         if (splitFiles.size() > 0) {
             // merge output ffindex databases
             mergeFiles(resultDB, resultDBIndex, splitFiles);
+            if (queryStats) {
+                mergeQueryStats(queryDB, queryDBIndex, resultDB, splitFiles);
+            }
         } else {
             Debug(Debug::ERROR) << "Aborting. No results were computed!\n";
             EXIT(EXIT_FAILURE);
@@ -555,20 +909,88 @@ bool Prefiltering::runSplits(const std::string &queryDB, const std::string &quer
 
     bool hasResult = false;
     size_t totalSplits = std::min(dbSize, (size_t) splits);
-    if (splitProcessCount > 1) {
+    // checkpointed runs commit even a single split, like the alignment commits a single chunk
+    if (splitProcessCount > 1 || (splitProcessCount == 1 && checkpointChunks > 0)) {
         // splits template database into x sequence steps
+        Checkpoint *checkpoint = NULL;
+        if (checkpointChunks > 0) {
+            // derived settings like the k-mer size are not part of the parameters
+            std::string job = "prefilter " + SSTR(splitMode) + " " + SSTR(totalSplits) + " " + SSTR(fromSplit)
+                              + " " + Checkpoint::describeDatabase(qdbr->getIndexFileName())
+                              + " " + Checkpoint::describeDatabase(tdbr->getIndexFileName())
+                              + " " + SSTR(kmerSize) + " " + SSTR(kmerThr) + " " + SSTR(maxResListLen) + " " + checkpointParameters;
+            if (aligner != NULL) {
+                job += "align " + SSTR(alignMaxAccept) + " " + SSTR(alignMaxRejected) + " " + aligner->getCheckpointParameters();
+            }
+            checkpoint = new Checkpoint(resultDB, job);
+        }
+        const size_t toSplit = std::min(fromSplit + splitProcessCount, totalSplits);
+        std::vector<bool> splitDone(toSplit, false);
+        std::vector<bool> splitHasResults(toSplit, false);
+        if (checkpoint != NULL) {
+            for (size_t i = fromSplit; i < toSplit; i++) {
+                bool splitHasResult;
+                std::pair<std::string, std::string> filenamePair = Util::createTmpFileNames(resultDB, resultDBIndex, i);
+                splitDone[i] = checkpoint->isDone(i, filenamePair, &splitHasResult);
+                splitHasResults[i] = splitHasResult;
+            }
+        }
+        bool pipeline = false;
+        if (pipelineSplits && splitMode == Parameters::TARGET_DB_SPLIT) {
+            pipeline = canPipelineSplits(totalSplits);
+        }
+        Timer splitsTimer;
+        buildSeconds = 0.0;
+        buildWaitSeconds = 0.0;
+        matchSeconds = 0.0;
         std::vector<std::pair<std::string, std::string> > splitFiles;
-        for (size_t i = fromSplit; i < (fromSplit + splitProcessCount) && i < totalSplits; i++) {
+        for (size_t i = fromSplit; i < toSplit; i++) {
             std::pair<std::string, std::string> filenamePair = Util::createTmpFileNames(resultDB, resultDBIndex, i);
-            if (runSplit(qdbr, filenamePair.first.c_str(), filenamePair.second.c_str(), i, totalSplits, sameQTDB)) {
+            bool splitHasResult;
+            if (splitDone[i]) {
+                splitHasResult = splitHasResults[i];
+                Debug(Debug::INFO) << "Prefiltering step " << (i + 1) << " of " << totalSplits << " was finished before\n";
+            } else {
+                nextBuildSplit = SIZE_MAX;
+                if (pipeline) {
+                    for (size_t next = i + 1; next < toSplit; next++) {
+                        if (splitDone[next] == false) {
+                            nextBuildSplit = next;
+                            break;
+                        }
+                    }
+                }
+                splitHasResult = runSplit(qdbr, filenamePair.first.c_str(), filenamePair.second.c_str(), i, totalSplits, sameQTDB);
+                if (checkpoint != NULL) {
+                    checkpoint->commit(i, splitHasResult, filenamePair);
+                }
+            }
+            if (splitHasResult) {
                 splitFiles.push_back(filenamePair);
-
             }
         }
+        nextBuildSplit = SIZE_MAX;
+        if (nextBuildRunning) {
+            finishNextBuild();
+        }
+        if (splitMode == Parameters::TARGET_DB_SPLIT && templateDBIsIndex == false) {
+            // the serial time is what building and matching one after the other would have taken
+            Debug(Debug::INFO) << "Index table build: " << buildSeconds << "s, matching: " << matchSeconds << "s, "
+                               << "serial: " << (buildSeconds + matchSeconds) << "s, "
+                               << (pipeline ? "pipelined" : "elapsed") << ": " << splitsTimer.elapsedSeconds() << "s "
+                               << "(waited " << buildWaitSeconds << "s for background builds)\n";
+        }
         if (splitFiles.size() > 0) {
             mergeFiles(resultDB, resultDBIndex, splitFiles);
+            if (queryStats) {
+                mergeQueryStats(queryDB, queryDBIndex, resultDB, splitFiles);
+            }
             hasResult = true;
         }
+        if (checkpoint != NULL) {
+            checkpoint->finish();
+            delete checkpoint;
+        }
     } else if (splitProcessCount == 1) {
         if (runSplit(qdbr, resultDB.c_str(), resultDBIndex.c_str(), fromSplit, totalSplits, sameQTDB)) {
             hasResult = true;
@@ -601,7 +1023,8 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
     size_t querySize = qdbr->getSize();
 
     size_t maxResults = maxResListLen;
-    if (splitCount > 1) {
+    // every query split is searched against the whole target database
+    if (splitMode == Parameters::TARGET_DB_SPLIT && splitCount > 1) {
         size_t fourTimesStdDeviation = 4*sqrt(static_cast<double>(maxResListLen) / static_cast<double>(splitCount));
         maxResults = (maxResListLen / splitCount) + std::max(static_cast<size_t >(1), fourTimesStdDeviation);
     }
@@ -613,7 +1036,13 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
         if (dbSize == 0) {
             return false;
         }
+    }
 
+    // the table of an unsplit target covers the whole database, repeated runs (server) keep it
+    const bool keepIndexTable = (splitMode == Parameters::TARGET_DB_SPLIT && splitCount == 1 && indexTable != NULL);
+    if (splitMode == Parameters::TARGET_DB_SPLIT && keepIndexTable == false) {
+        freeNodeReplicas();
+        placedIndexTable = NULL;
         if (indexTable != NULL) {
             delete indexTable;
             indexTable = NULL;
@@ -624,6 +1053,11 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
             sequenceLookup = NULL;
         }
 
+        if (sharedIndex != NULL) {
+            delete sharedIndex;
+            sharedIndex = NULL;
+        }
+
         if(splitCount != (size_t) splits) {
             reopenTargetDb();
             if (sameQTDB == true) {
@@ -631,7 +1065,14 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
             }
         }
 
-        getIndexTable(split, dbFrom, dbSize);
+        if (nextBuildRunning && nextBuild.split == split) {
+            finishNextBuild();
+        } else {
+            getIndexTable(split, dbFrom, dbSize);
+        }
+        if (nextBuildSplit < splitCount && nextBuildRunning == false) {
+            startNextBuild(nextBuildSplit, splitCount);
+        }
     } else if (splitMode == Parameters::QUERY_DB_SPLIT) {
         Util::decomposeDomainByAminoAcid(qdbr->getAminoAcidDBSize(), qdbr->getSeqLens(), qdbr->getSize(),
                                          split, splitCount, &queryFrom, &querySize);
@@ -640,6 +1081,7 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
         }
     }
 
+    Timer matchTimer;
     double kmerMatchProb;
     if (diagonalScoring) {
         kmerMatchProb = 0.0f;
@@ -659,6 +1101,8 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
     size_t resSize = 0;
     size_t realResSize = 0;
     size_t diagonalOverflow = 0;
+    size_t alignmentsNum = 0;
+    size_t alignmentsPassed = 0;
     size_t totalQueryDBSize = querySize;
 
 #ifdef OPENMP
@@ -672,9 +1116,16 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
         localThreads = querySize;
     }
 
-    DBWriter tmpDbw(resultDB.c_str(), resultDBIndex.c_str(), localThreads);
+    DBWriter tmpDbw(resultDB.c_str(), resultDBIndex.c_str(), localThreads, (splitCount == 1) ? finalWriterMode : writerMode);
     tmpDbw.open();
 
+    DBWriter *statsDbw = NULL;
+    if (queryStats) {
+        const std::string statsDB = resultDB + "_stats";
+        statsDbw = new DBWriter(statsDB.c_str(), (statsDB + ".index").c_str(), localThreads);
+        statsDbw->open();
+    }
+
     // init all thread-specific data structures
     char *notEmpty = new char[querySize];
     memset(notEmpty, 0, querySize * sizeof(char)); // init notEmpty
@@ -694,15 +1145,36 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
     Debug(Debug::INFO) << "Target db start  " << (dbFrom + 1) << " to " << dbFrom + dbSize << "\n";
     EvalueComputation evaluer(tdbr->getAminoAcidDBSize(), subMat, 0, 0, false);
 
+    if (numaNodes.empty() == false && placedIndexTable != indexTable) {
+        placeIndexOnNodes();
+        placedIndexTable = indexTable;
+    }
+    size_t *threadResidues = new size_t[localThreads];
+    double *threadSeconds = new double[localThreads];
+
 #pragma omp parallel num_threads(localThreads)
     {
         unsigned int thread_idx = 0;
 #ifdef OPENMP
         thread_idx = static_cast<unsigned int>(omp_get_thread_num());
 #endif
+        threadResidues[thread_idx] = 0;
+        threadSeconds[thread_idx] = 0.0;
+
+        // pin before the thread local buffers are allocated, so they are placed on the node as well
+        size_t node = 0;
+        std::vector<int> previousAffinity;
+        if (numaNodes.empty() == false) {
+            node = (thread_idx * numaNodes.size()) / localThreads;
+            Numa::getThreadAffinity(previousAffinity);
+            Numa::setThreadAffinity(numaNodes[node]);
+        }
+        IndexTable *nodeIndexTable = nodeReplicas.empty() ? indexTable : nodeReplicas[node].indexTable;
+        SequenceLookup *nodeSequenceLookup = nodeReplicas.empty() ? sequenceLookup : nodeReplicas[node].sequenceLookup;
+
         Sequence seq(maxSeqLen, querySeqType, subMat, kmerSize, spacedKmer, aaBiasCorrection);
 
-        QueryMatcher matcher(indexTable, sequenceLookup, subMat, evaluer, tdbr->getSeqLens() + dbFrom, kmerThr, kmerMatchProb,
+        QueryMatcher matcher(nodeIndexTable, nodeSequenceLookup, subMat, evaluer, tdbr->getSeqLens() + dbFrom, kmerThr, kmerMatchProb,
                              kmerSize, dbSize, maxSeqLen, seq.getEffectiveKmerSize(),
                              maxResults, aaBiasCorrection, diagonalScoring, minDiagScoreThr, takeOnlyBestKmer);
 
@@ -711,9 +1183,17 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
         } else {
             matcher.setSubstitutionMatrix(_3merSubMatrix, _2merSubMatrix);
         }
+        matcher.setPhaseTiming(queryStats);
+        char statsBuffer[1024];
 
-#pragma omp for schedule(dynamic, 10) reduction (+: kmersPerPos, resSize, dbMatches, doubleMatches, querySeqLenSum, diagonalOverflow)
+        Alignment::Worker *alignmentWorker = NULL;
+        if (aligner != NULL) {
+            alignmentWorker = new Alignment::Worker(*aligner);
+        }
+
+#pragma omp for schedule(dynamic, 10) reduction (+: kmersPerPos, resSize, dbMatches, doubleMatches, querySeqLenSum, diagonalOverflow, alignmentsNum, alignmentsPassed)
         for (size_t id = queryFrom; id < queryFrom + querySize; id++) {
+            Timer queryTimer;
             Debug::printProgress(id);
             // get query sequence
             char *seqData = qdbr->getData(id);
@@ -730,8 +1210,19 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
             // calculate prefiltering results
             std::pair<hit_t *, size_t> prefResults = matcher.matchQuery(&seq, targetSeqId);
             size_t resultSize = prefResults.second;
-            // write
-            writePrefilterOutput(qdbr, &tmpDbw, thread_idx, id, prefResults, dbFrom, resListOffset, maxResults);
+            if (aligner != NULL) {
+                const size_t hitCount = selectPrefilterHits(qdbr, id, prefResults, dbFrom, resListOffset, maxResults);
+                const hit_t *hits = prefResults.first + resListOffset;
+                alignmentWorker->targets.clear();
+                for (size_t i = 0; i < hitCount; i++) {
+                    Alignment::Target target = { hits[i].seqId, hits[i].diagonal };
+                    alignmentWorker->targets.push_back(target);
+                }
+                alignmentsNum += aligner->alignQuery(*alignmentWorker, qKey, alignMaxAccept, alignMaxRejected,
+                                                     tmpDbw, thread_idx, alignmentsPassed);
+            } else {
+                writePrefilterOutput(qdbr, &tmpDbw, thread_idx, id, prefResults, dbFrom, resListOffset, maxResults);
+            }
 
             // update statistics counters
             if (resultSize != 0) {
@@ -746,13 +1237,39 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
             resSize += resultSize;
             realResSize += std::min(resultSize, maxResults);
             reslens[thread_idx]->emplace_back(resultSize);
+            threadResidues[thread_idx] += seq.L;
+            const double querySeconds = queryTimer.elapsedSeconds();
+            threadSeconds[thread_idx] += querySeconds;
+
+            if (statsDbw != NULL) {
+                // split, length, k-mer list length, matched entries, diagonal bins, ungapped alignments, hits,
+                // overflows and the ms for k-mer generation, counting, ungapped alignment, result extraction and in total
+                const statistics_t *queryStatistics = matcher.getStatistics();
+                int len = snprintf(statsBuffer, sizeof(statsBuffer), "%zu\t%d\t%zu\t%zu\t%zu\t%zu\t%zu\t%zu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n",
+                                   split, seq.L, queryStatistics->kmerListLen, queryStatistics->dbMatches,
+                                   queryStatistics->diagonalBins, queryStatistics->ungappedCount, resultSize,
+                                   queryStatistics->overflowCount, queryStatistics->kmerSeconds * 1000.0,
+                                   queryStatistics->countSeconds * 1000.0, queryStatistics->ungappedSeconds * 1000.0,
+                                   queryStatistics->resultSeconds * 1000.0,
+                                   querySeconds * 1000.0);
+                statsDbw->writeData(statsBuffer, len, qKey, thread_idx);
+            }
         } // step end
 
+        delete alignmentWorker;
+
+        if (previousAffinity.empty() == false) {
+            Numa::setThreadAffinity(previousAffinity);
+        }
+
 #ifndef HAVE_MPI
         if (earlyExit && splitCount == 1) {
             #pragma omp barrier
             if (thread_idx == 0) {
-                tmpDbw.close();
+                tmpDbw.close(outputDbType);
+                if (statsDbw != NULL) {
+                    statsDbw->close();
+                }
                 Debug(Debug::INFO) << "Done. Exiting early now.\n";
             }
             #pragma omp barrier
@@ -776,9 +1293,36 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
         }
 
         printStatistics(stats, reslens, localThreads, empty, maxResults);
+        if (aligner != NULL) {
+            Debug(Debug::INFO) << alignmentsNum << " alignments calculated.\n";
+            Debug(Debug::INFO) << alignmentsPassed << " sequence pairs passed the thresholds.\n";
+        }
+
+        // throughput of a node is the sum of the throughput of its threads
+        for (size_t node = 0; node < numaNodes.size(); node++) {
+            size_t nodeThreads = 0;
+            size_t nodeResidues = 0;
+            double nodeThroughput = 0.0;
+            for (unsigned int i = 0; i < localThreads; i++) {
+                if ((i * numaNodes.size()) / localThreads != node) {
+                    continue;
+                }
+                nodeThreads++;
+                nodeResidues += threadResidues[i];
+                if (threadSeconds[i] > 0.0) {
+                    nodeThroughput += threadResidues[i] / threadSeconds[i];
+                }
+            }
+            Debug(Debug::INFO) << "NUMA node " << node << ": " << nodeThreads << " threads, "
+                               << nodeResidues << " query residues, " << static_cast<size_t>(nodeThroughput) << " residues/s\n";
+        }
     }
     Debug(Debug::INFO) << "\nTime for prefiltering scores calculation: " << timer.lap() << "\n";
-    tmpDbw.close(); // sorts the index
+    tmpDbw.close(outputDbType); // sorts the index
+    if (statsDbw != NULL) {
+        statsDbw->close();
+        delete statsDbw;
+    }
 
     // sort by ids
     // needed to speed up merge later one
@@ -786,15 +1330,14 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
     if (splitCount > 1 && splitMode == Parameters::TARGET_DB_SPLIT) {
         DBReader<unsigned int> resultReader(tmpDbw.getDataFileName(), tmpDbw.getIndexFileName());
         resultReader.open(DBReader<unsigned int>::NOSORT);
-        DBWriter resultWriter((resultDB + "_tmp").c_str(), (resultDBIndex + "_tmp").c_str(), localThreads);
+        DBWriter resultWriter((resultDB + "_tmp").c_str(), (resultDBIndex + "_tmp").c_str(), localThreads, writerMode);
         resultWriter.open();
         resultWriter.sortDatafileByIdOrder(resultReader);
         resultWriter.close();
         resultReader.close();
         remove(resultDB.c_str());
-        remove(resultDBIndex.c_str());
         std::rename((resultDB + "_tmp").c_str(), resultDB.c_str());
-        std::rename((resultDBIndex + "_tmp").c_str(), resultDBIndex.c_str());
+        DBReader<unsigned int>::moveIndex(resultDBIndex + "_tmp", resultDBIndex);
     }
 
     for (unsigned int i = 0; i < localThreads; i++) {
@@ -803,21 +1346,18 @@ bool Prefiltering::runSplit(DBReader<unsigned int>* qdbr, const std::string &res
     }
     delete[] reslens;
     delete[] notEmpty;
+    delete[] threadResidues;
+    delete[] threadSeconds;
 
+    matchSeconds += matchTimer.elapsedSeconds();
     return true;
 }
 
-// write prefiltering to ffindex database
-void Prefiltering::writePrefilterOutput(DBReader<unsigned int> *qdbr, DBWriter *dbWriter, unsigned int thread_idx, size_t id,
-                                        const std::pair<hit_t *, size_t> &prefResults, size_t seqIdOffset,
-                                        size_t resultOffsetPos, size_t maxResults) {
-    // write prefiltering results to a string
+size_t Prefiltering::selectPrefilterHits(DBReader<unsigned int> *qdbr, size_t id, const std::pair<hit_t *, size_t> &prefResults,
+                                         size_t seqIdOffset, size_t resultOffsetPos, size_t maxResults) {
     size_t l = 0;
     hit_t *resultVector = prefResults.first + resultOffsetPos;
     const size_t resultSize = (prefResults.second < resultOffsetPos) ? 0 : prefResults.second - resultOffsetPos;
-    std::string prefResultsOutString;
-    prefResultsOutString.reserve(BUFFER_SIZE);
-    char buffer[100];
     for (size_t i = 0; i < resultSize; i++) {
         hit_t *res = resultVector + i;
         size_t targetSeqId = res->seqId + seqIdOffset;
@@ -835,14 +1375,35 @@ void Prefiltering::writePrefilterOutput(DBReader<unsigned int> *qdbr, DBWriter *
 
 
         res->seqId = tdbr->getDbKey(targetSeqId);
-        int len = QueryMatcher::prefilterHitToBuffer(buffer, *res);
-        // TODO: error handling for len
-        prefResultsOutString.append(buffer, len);
+        resultVector[l] = *res;
         l++;
         // maximum allowed result list length is reached
         if (l >= maxResults)
             break;
     }
+    return l;
+}
+
+// write prefiltering to ffindex database
+void Prefiltering::writePrefilterOutput(DBReader<unsigned int> *qdbr, DBWriter *dbWriter, unsigned int thread_idx, size_t id,
+                                        const std::pair<hit_t *, size_t> &prefResults, size_t seqIdOffset,
+                                        size_t resultOffsetPos, size_t maxResults) {
+    const size_t resultSize = selectPrefilterHits(qdbr, id, prefResults, seqIdOffset, resultOffsetPos, maxResults);
+    hit_t *resultVector = prefResults.first + resultOffsetPos;
+    // write prefiltering results to a string
+    std::string prefResultsOutString;
+    prefResultsOutString.reserve(BUFFER_SIZE);
+    char buffer[100];
+    for (size_t i = 0; i < resultSize; i++) {
+        hit_t *res = resultVector + i;
+        if (binaryOutput) {
+            prefResultsOutString.append((const char *) res, sizeof(hit_t));
+        } else {
+            int len = QueryMatcher::prefilterHitToBuffer(buffer, *res);
+            // TODO: error handling for len
+            prefResultsOutString.append(buffer, len);
+        }
+    }
     // write prefiltering results string to ffindex database
     const size_t prefResultsLength = prefResultsOutString.length();
     char *prefResultsOutData = (char *) prefResultsOutString.c_str();
@@ -962,11 +1523,49 @@ double Prefiltering::setKmerThreshold(DBReader<unsigned int> *qdbr) {
 
 void Prefiltering::mergeFiles(const std::string &outDB, const std::string &outDBIndex,
                               const std::vector<std::pair<std::string, std::string>> &splitFiles) {
+    if (outputDbType != -1) {
+        for (size_t i = 0; i < splitFiles.size(); i++) {
+            std::string dbTypeFile = splitFiles[i].first + ".dbtype";
+            if (FileUtil::fileExists(dbTypeFile.c_str())) {
+                FileUtil::deleteFile(dbTypeFile);
+            }
+        }
+    }
     if (splitMode == Parameters::TARGET_DB_SPLIT) {
         mergeOutput(outDB, outDBIndex, splitFiles);
     } else if (splitMode == Parameters::QUERY_DB_SPLIT) {
         DBWriter::mergeResults(outDB, outDBIndex, splitFiles);
     }
+    if (outputDbType != -1) {
+        DBWriter::writeDbtypeFile(outDB.c_str(), outputDbType);
+    }
+}
+
+void Prefiltering::mergeQueryStats(const std::string &queryDB, const std::string &queryDBIndex, const std::string &resultDB,
+                                   const std::vector<std::pair<std::string, std::string>> &splitFiles) {
+    // splits that were finished by an earlier run might have been computed without statistics
+    std::vector<std::pair<std::string, std::string>> statsFiles;
+    for (size_t i = 0; i < splitFiles.size(); i++) {
+        const std::string statsDB = splitFiles[i].first + "_stats";
+        if (FileUtil::fileExists(statsDB.c_str())) {
+            statsFiles.push_back(std::make_pair(statsDB, statsDB + ".index"));
+        }
+    }
+    if (statsFiles.empty()) {
+        return;
+    }
+    // the reader of runSplits can be the target reader, which is reopened by the splits
+    DBReader<unsigned int> qdbr(queryDB.c_str(), queryDBIndex.c_str());
+    qdbr.open(DBReader<unsigned int>::NOSORT);
+    const std::string statsDB = resultDB + "_stats";
+    DBWriter writer(statsDB.c_str(), (statsDB + ".index").c_str());
+    writer.open();
+    writer.mergeFiles(qdbr, statsFiles, std::vector<std::string>());
+    writer.close();
+    qdbr.close();
+    for (size_t i = 0; i < statsFiles.size(); i++) {
+        DBReader<unsigned int>::removeDb(statsFiles[i].first, statsFiles[i].second);
+    }
 }
 
 int Prefiltering::getKmerThreshold(const float sensitivity, const int querySeqType,
@@ -1002,10 +1601,11 @@ int Prefiltering::getKmerThreshold(const float sensitivity, const int querySeqTy
 size_t Prefiltering::estimateMemoryConsumption(int split, size_t dbSize, size_t resSize,
                                                size_t maxHitsPerQuery,
                                                int alphabetSize, int kmerSize, unsigned int querySeqType,
-                                               int threads) {
+                                               int threads, bool compressedIndex, bool publishIndex) {
     // for each residue in the database we need 7 byte
+    // (6 byte index entry and 1 byte sequence lookup, packed index entries take about 4 byte)
     size_t dbSizeSplit = (dbSize) / split;
-    size_t residueSize = (resSize / split * 7);
+    size_t residueSize = (resSize / split * (compressedIndex ? 5 : 7));
     // 21^7 * pointer size is needed for the index
     size_t indexTableSize = static_cast<size_t>(pow(alphabetSize, kmerSize)) * sizeof(size_t *);
     // memory needed for the threads
@@ -1026,7 +1626,18 @@ size_t Prefiltering::estimateMemoryConsumption(int split, size_t dbSize, size_t
     }
     // some memory needed to keep the index, ....
     size_t background = dbSize * 22;
-    return residueSize + indexTableSize + threadSize + background + extendedMatrix;
+    size_t neededSize = residueSize + indexTableSize + threadSize + background + extendedMatrix;
+    if (compressedIndex) {
+        // the entries are packed while the index is built, before the thread memory is allocated
+        size_t buildSize = (resSize / split * 7) + indexTableSize + background + extendedMatrix;
+        neededSize = std::max(neededSize, buildSize);
+    }
+    if (publishIndex) {
+        // the shared segment is filled from the built index, both are held until the built one is freed
+        size_t publishSize = 2 * (residueSize + indexTableSize) + background + extendedMatrix;
+        neededSize = std::max(neededSize, publishSize);
+    }
+    return neededSize;
 }
 
 size_t Prefiltering::estimateHDDMemoryConsumption(size_t dbSize, size_t maxResListLen) {
@@ -1036,14 +1647,16 @@ size_t Prefiltering::estimateHDDMemoryConsumption(size_t dbSize, size_t maxResLi
 }
 
 std::pair<int, int> Prefiltering::optimizeSplit(size_t totalMemoryInByte, DBReader<unsigned int> *tdbr,
-                                                int alphabetSize, int externalKmerSize, unsigned int querySeqType, unsigned int threads) {
+                                                int alphabetSize, int externalKmerSize, unsigned int querySeqType, unsigned int threads,
+                                                bool compressedIndex, bool publishIndex) {
     for (int optSplit = 1; optSplit < 100; optSplit++) {
         for (int optKmerSize = 6; optKmerSize <= 7; optKmerSize++) {
             if (optKmerSize == externalKmerSize || externalKmerSize == 0) { // 0: set k-mer based on aa size in database
                 size_t aaUpperBoundForKmerSize = IndexTable::getUpperBoundAACountForKmerSize(optKmerSize);
                 if ((tdbr->getAminoAcidDBSize() / optSplit) < aaUpperBoundForKmerSize) {
                     size_t neededSize = estimateMemoryConsumption(optSplit, tdbr->getSize(), tdbr->getAminoAcidDBSize(),
-                                                                  0, alphabetSize, optKmerSize, querySeqType, threads);
+                                                                  0, alphabetSize, optKmerSize, querySeqType, threads,
+                                                                  compressedIndex, publishIndex);
                     if (neededSize < 0.9 * totalMemoryInByte) {
                         return std::make_pair(optKmerSize, optSplit);
                     }
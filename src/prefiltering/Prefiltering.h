@@ -13,7 +13,10 @@
 #include <string>
 #include <list>
 #include <utility>
+#include <pthread.h>
 
+class Alignment;
+class SharedIndex;
 
 class Prefiltering {
 public:
@@ -46,12 +49,16 @@ public:
                                              float bitFactor, bool ignoreX, bool profileState);
 
     static void setupSplit(DBReader<unsigned int>& dbr, const int alphabetSize, const unsigned int querySeqType, const int threads,
-                           const bool templateDBIsIndex, const size_t maxResListLen, const size_t memoryLimit,
-                           int *kmerSize, int *split, int *splitMode);
+                           const bool templateDBIsIndex, const bool compressedIndex, const bool publishIndex,
+                           const size_t maxResListLen, const size_t memoryLimit, int *kmerSize, int *split, int *splitMode);
 
     static int getKmerThreshold(const float sensitivity, const int querySeqType,
                                 const int kmerScore, const int kmerSize);
 
+    // the hits of every query are aligned right away and the result databases hold alignments instead of hits
+    // returns false if the target database is split, its hits have to be merged in a prefilter database first
+    bool setAligner(Alignment *aligner, unsigned int maxAlnNum, unsigned int maxRejected);
+
 private:
     static const size_t BUFFER_SIZE = 1000000;
 
@@ -95,19 +102,99 @@ private:
     const bool earlyExit;
     const bool noPreload;
     const unsigned int threads;
+    // finished splits are recorded and skipped by a restarted run
+    const int checkpointChunks;
+    const std::string checkpointParameters;
+    size_t writerMode;
+    // only final results are sharded, split results are spliced byte by byte when merging
+    size_t finalWriterMode;
+    // hits are written as packed hit_t records
+    const bool binaryOutput;
+    int outputDbType;
+
+    Alignment *aligner;
+    unsigned int alignMaxAccept;
+    unsigned int alignMaxRejected;
+
+    // NUMA placement of the index table, numaNodes holds the cpus of each node
+    // and is empty if the mode is off or the system has a single node
+    const int numaMode;
+    std::vector<std::vector<int> > numaNodes;
+    struct NodeReplica {
+        IndexTable *indexTable;
+        SequenceLookup *sequenceLookup;
+        char *memory;
+        size_t memorySize;
+        Util::HugePageType pageType;
+    };
+    std::vector<NodeReplica> nodeReplicas;
+    // index table the replicas or the interleaving were made for
+    IndexTable *placedIndexTable;
+
+    // k-mer lists of the index table are bit packed, also set if the precomputed index is packed
+    bool compressIndex;
+
+    // the precomputed index is mapped and used in place, a background thread faults it in
+    pthread_t prefaultThread;
+    bool prefaultRunning;
+    static void *prefaultThreadMain(void *arg);
+    void joinPrefault();
+
+    // the index table built at runtime is published in shared memory, see SharedIndex
+    const bool shareIndex;
+    SharedIndex *sharedIndex;
+    std::string getSharedIndexKey(size_t dbFrom, size_t dbSize);
+
+    // every split writes one record per query to <resultDB>_stats, the records of all splits are merged by query
+    const bool queryStats;
+
+    size_t memoryLimit;
+
+    // the index table of the next target split is built by a background thread while the current split is matched
+    bool pipelineSplits;
+    struct SplitBuild {
+        Prefiltering *prefiltering;
+        size_t split;
+        size_t dbFrom;
+        size_t dbSize;
+        unsigned int threads;
+        IndexTable *indexTable;
+        SequenceLookup *sequenceLookup;
+        double seconds;
+    };
+    SplitBuild nextBuild;
+    pthread_t nextBuildThread;
+    bool nextBuildRunning;
+    // split runSplit starts to build after its own index table is ready, SIZE_MAX for none
+    size_t nextBuildSplit;
+    // phase times of the target splits
+    double buildSeconds;
+    double buildWaitSeconds;
+    double matchSeconds;
+
+    bool canPipelineSplits(size_t splitCount);
+    void startNextBuild(size_t split, size_t splitCount);
+    // waits for the background build and takes over its index table
+    void finishNextBuild();
+    static void *nextBuildThreadMain(void *arg);
+
+    // copies the index table to every node or interleaves it over the nodes
+    void placeIndexOnNodes();
+    void freeNodeReplicas();
 
     bool runSplit(DBReader<unsigned int> *qdbr, const std::string &resultDB, const std::string &resultDBIndex,
                   size_t split, size_t splitCount, bool sameQTDB);
 
     // compute kmer size and split size for index table
     static std::pair<int, int> optimizeSplit(size_t totalMemoryInByte, DBReader<unsigned int> *tdbr, int alphabetSize, int kmerSize,
-                                             unsigned int querySeqType, unsigned int threads);
+                                             unsigned int querySeqType, unsigned int threads, bool compressedIndex,
+                                             bool publishIndex);
 
     // estimates memory consumption while runtime
     static size_t estimateMemoryConsumption(int split, size_t dbSize, size_t resSize,
                                             size_t maxHitsPerQuery,
                                             int alphabetSize, int kmerSize, unsigned int querySeqType,
-                                            int threads);
+                                            int threads, bool compressedIndex, bool publishIndex);
 
     static size_t estimateHDDMemoryConsumption(size_t dbSize, size_t maxResListLen);
 
@@ -117,12 +204,25 @@ private:
     // needed for index lookup
     void getIndexTable(int split, size_t dbFrom, size_t dbSize);
 
+    // k-mer threshold of the index table, 0 if only the exact k-mers are indexed
+    int getIndexKmerThr();
+
+    // builds the index table of the target sequences dbFrom to dbFrom + dbSize
+    // does not modify any member, so it can run next to the matching of another split
+    void buildIndexTable(size_t dbFrom, size_t dbSize, bool remapData,
+                         IndexTable **table, SequenceLookup **lookup);
+
     /*
      * Set the k-mer similarity threshold that regulates the length of k-mer lists for each k-mer in the query sequence.
      * As a result, the prefilter always has roughly the same speed for different k-mer and alphabet sizes.
      */
     double setKmerThreshold(DBReader<unsigned int> *qdb);
 
+    // moves the hits that are written to the front of the result list and replaces their ids by keys
+    // returns their number
+    size_t selectPrefilterHits(DBReader<unsigned int> *qdbr, size_t id, const std::pair<hit_t *, size_t> &prefResults,
+                               size_t seqIdOffset, size_t resultOffsetPos, size_t maxResults);
+
     // write prefiltering to ffindex database
     void writePrefilterOutput(DBReader<unsigned int> *qdbr, DBWriter *dbWriter, unsigned int thread_idx, size_t id,
                               const std::pair<hit_t *, size_t> &prefResults, size_t seqIdOffset,
@@ -134,6 +234,9 @@ private:
     void mergeOutput(const std::string &outDb, const std::string &outDBIndex,
                      const std::vector<std::pair<std::string, std::string>> &filenames);
 
+    void mergeQueryStats(const std::string &queryDB, const std::string &queryDBIndex, const std::string &resultDB,
+                         const std::vector<std::pair<std::string, std::string>> &splitFiles);
+
     bool isSameQTDB(const std::string &queryDB);
 
     void reopenTargetDb();
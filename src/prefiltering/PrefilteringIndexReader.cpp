@@ -5,7 +5,9 @@
 #include "FileUtil.h"
 #include "IndexBuilder.h"
 
-const char*  PrefilteringIndexReader::CURRENT_VERSION = "7";
+const char*  PrefilteringIndexReader::CURRENT_VERSION = "8";
+// the format without packed k-mer lists did not change, so such indexes keep the version before packing
+const char*  PrefilteringIndexReader::UNPACKED_VERSION = "7";
 unsigned int PrefilteringIndexReader::VERSION = 0;
 unsigned int PrefilteringIndexReader::META = 1;
 unsigned int PrefilteringIndexReader::SCOREMATRIXNAME = 2;
@@ -23,21 +25,31 @@ unsigned int PrefilteringIndexReader::SEQINDEXDATASIZE = 12;
 unsigned int PrefilteringIndexReader::SEQINDEXSEQOFFSET = 13;
 unsigned int PrefilteringIndexReader::UNMASKEDSEQINDEXDATA = 14;
 unsigned int PrefilteringIndexReader::GENERATOR = 15;
+// size of the packed k-mer lists in ENTRIES, only exists for compressed index tables
+unsigned int PrefilteringIndexReader::ENTRIESPACKED = 16;
 
 extern const char* version;
 
+// the precomputed blocks are accessed as randomly as a freshly built index table,
+// advise them for transparent huge pages before they are touched
+static Util::HugePageType adviseHugePages(DBReader<unsigned int> *dbr, size_t id) {
+    bool advised = Util::adviseHugePages(dbr->getData(id), dbr->getSeqLens(id));
+    return advised ? Util::TRANSPARENT_HUGEPAGES : Util::NORMAL_PAGES;
+}
+
 bool PrefilteringIndexReader::checkIfIndexFile(DBReader<unsigned int>* reader) {
     char * version = reader->getDataByDBKey(VERSION);
     if(version == NULL){
         return false;
     }
-    return (strncmp(version, CURRENT_VERSION, strlen(CURRENT_VERSION)) == 0 ) ? true : false;
+    return (strncmp(version, CURRENT_VERSION, strlen(CURRENT_VERSION)) == 0
+            || strncmp(version, UNPACKED_VERSION, strlen(UNPACKED_VERSION)) == 0) ? true : false;
 }
 
 void PrefilteringIndexReader::createIndexFile(const std::string &outDB, DBReader<unsigned int> *dbr, DBReader<unsigned int> *hdbr,
                                               BaseMatrix * subMat, int maxSeqLen, bool hasSpacedKmer,
                                               bool compBiasCorrection, int alphabetSize, int kmerSize,
-                                              int maskMode, int kmerThr) {
+                                              int maskMode, int kmerThr, bool compressIndex) {
     std::string outIndexName(outDB);
     std::string spaced = (hasSpacedKmer == true) ? "s" : "";
     outIndexName.append(".").append(spaced).append("k").append(SSTR(kmerSize));
@@ -49,21 +61,16 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB, DBReader
     if (seqType != Sequence::HMM_PROFILE && seqType != Sequence::PROFILE_STATE_SEQ) {
         int alphabetSize = subMat->alphabetSize;
         subMat->alphabetSize = subMat->alphabetSize-1;
+        // one matrix at a time and without a serialized copy, the 3-mer matrix dominates the peak memory on small databases
         ScoreMatrix *s3 = ExtendedSubstitutionMatrix::calcScoreMatrix(*subMat, 3);
-        ScoreMatrix *s2 = ExtendedSubstitutionMatrix::calcScoreMatrix(*subMat, 2);
-        subMat->alphabetSize = alphabetSize;
-        char* serialized3mer = ScoreMatrix::serialize(*s3);
         Debug(Debug::INFO) << "Write SCOREMATRIX3MER (" << SCOREMATRIX3MER << ")\n";
-        writer.writeData(serialized3mer, ScoreMatrix::size(*s3), SCOREMATRIX3MER, 0);
-        writer.alignToPageSize();
-        free(serialized3mer);
+        writeScoreMatrix(writer, *s3, SCOREMATRIX3MER);
         ScoreMatrix::cleanup(s3);
 
-        char* serialized2mer = ScoreMatrix::serialize(*s2);
+        ScoreMatrix *s2 = ExtendedSubstitutionMatrix::calcScoreMatrix(*subMat, 2);
+        subMat->alphabetSize = alphabetSize;
         Debug(Debug::INFO) << "Write SCOREMATRIX2MER (" << SCOREMATRIX2MER << ")\n";
-        writer.writeData(serialized2mer, ScoreMatrix::size(*s2), SCOREMATRIX2MER, 0);
-        writer.alignToPageSize();
-        free(serialized2mer);
+        writeScoreMatrix(writer, *s2, SCOREMATRIX2MER);
         ScoreMatrix::cleanup(s2);
     }
 
@@ -79,6 +86,9 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB, DBReader
                                (maskMode == 1 || maskMode == 2) ? &maskedLookup : NULL,
                                (maskMode == 0 || maskMode == 2) ? &unmaskedLookup : NULL,
                                *subMat, &seq, dbr, 0, dbr->getSize(), kmerThr);
+    if (compressIndex) {
+        indexTable->compress();
+    }
 
     SequenceLookup *sequenceLookup = maskedLookup;
     if (sequenceLookup == NULL) {
@@ -93,16 +103,23 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB, DBReader
 
     // save the entries
     Debug(Debug::INFO) << "Write ENTRIES (" << ENTRIES << ")\n";
-    char *entries = (char *) indexTable->getEntries();
-    size_t entriesSize = indexTable->getTableEntriesNum() * indexTable->getSizeOfEntry();
+    char *entries = indexTable->getEntriesData();
+    size_t entriesSize = indexTable->getEntriesDataSize();
     writer.writeData(entries, entriesSize, ENTRIES, 0);
     writer.alignToPageSize();
 
+    if (indexTable->isCompressed()) {
+        Debug(Debug::INFO) << "Write ENTRIESPACKED (" << ENTRIESPACKED << ")\n";
+        uint64_t packedSize = entriesSize;
+        writer.writeData((char *) &packedSize, 1 * sizeof(uint64_t), ENTRIESPACKED, 0);
+        writer.alignToPageSize();
+    }
+
     // save the size
     Debug(Debug::INFO) << "Write ENTRIESOFFSETS (" << ENTRIESOFFSETS << ")\n";
 
     char *offsets = (char*)indexTable->getOffsets();
-    size_t offsetsSize = (indexTable->getTableSize() + 1) * sizeof(size_t);
+    size_t offsetsSize = indexTable->getOffsetsSize();
     writer.writeData(offsets, offsetsSize, ENTRIESOFFSETS, 0);
     writer.alignToPageSize();
     indexTable->deleteEntries();
@@ -164,7 +181,8 @@ void PrefilteringIndexReader::createIndexFile(const std::string &outDB, DBReader
     writer.alignToPageSize();
 
     Debug(Debug::INFO) << "Write VERSION (" << VERSION << ")\n";
-    writer.writeData((char *) CURRENT_VERSION, strlen(CURRENT_VERSION) * sizeof(char), VERSION, 0);
+    const char *indexVersion = compressIndex ? CURRENT_VERSION : UNPACKED_VERSION;
+    writer.writeData((char *) indexVersion, strlen(indexVersion) * sizeof(char), VERSION, 0);
     writer.alignToPageSize();
 
     Debug(Debug::INFO) << "Write DBRINDEX (" << DBRINDEX << ")\n";
@@ -233,6 +251,8 @@ SequenceLookup *PrefilteringIndexReader::getMaskedSequenceLookup(DBReader<unsign
     size_t sequenceCountId = dbr->getId(SEQCOUNT);
     size_t sequenceCount = *((size_t *)dbr->getData(sequenceCountId));
 
+    Util::HugePageType pageType = adviseHugePages(dbr, id);
+    Debug(Debug::INFO) << "Sequence lookup memory: " << Util::getHugePageTypeName(pageType) << "\n";
     if (touch) {
         dbr->touchData(id);
         dbr->touchData(seqOffsetsId);
@@ -261,6 +281,8 @@ SequenceLookup *PrefilteringIndexReader::getUnmaskedSequenceLookup(DBReader<unsi
     size_t sequenceCountId = dbr->getId(SEQCOUNT);
     size_t sequenceCount = *((size_t *)dbr->getData(sequenceCountId));
 
+    Util::HugePageType pageType = adviseHugePages(dbr, id);
+    Debug(Debug::INFO) << "Sequence lookup memory: " << Util::getHugePageTypeName(pageType) << "\n";
     if (touch) {
         dbr->touchData(id);
         dbr->touchData(seqOffsetsId);
@@ -295,6 +317,10 @@ IndexTable *PrefilteringIndexReader::generateIndexTable(DBReader<unsigned int> *
     size_t entriesOffsetsDataId = dbr->getId(ENTRIESOFFSETS);
     char *entriesOffsetsData = dbr->getData(entriesOffsetsDataId);
 
+    Util::HugePageType entriesPageType = adviseHugePages(dbr, entriesDataId);
+    Util::HugePageType offsetsPageType = adviseHugePages(dbr, entriesOffsetsDataId);
+    Debug(Debug::INFO) << "Index table entries memory: " << Util::getHugePageTypeName(entriesPageType) << "\n";
+    Debug(Debug::INFO) << "Index table offsets memory: " << Util::getHugePageTypeName(offsetsPageType) << "\n";
     if (touch) {
         dbr->touchData(entriesNumId);
         dbr->touchData(sequenceCountId);
@@ -302,10 +328,25 @@ IndexTable *PrefilteringIndexReader::generateIndexTable(DBReader<unsigned int> *
         dbr->touchData(entriesOffsetsDataId);
     }
 
-    retTable->initTableByExternalData(sequenceCount, entriesNum, (IndexEntryLocal*) entriesData, (size_t *)entriesOffsetsData);
+    size_t packedId = dbr->getId(ENTRIESPACKED);
+    if (packedId != UINT_MAX) {
+        uint64_t packedSize = *((uint64_t *)dbr->getData(packedId));
+        retTable->initPackedTableByExternalData(sequenceCount, entriesNum, (unsigned char *) entriesData, packedSize,
+                                                (size_t *)entriesOffsetsData);
+    } else {
+        retTable->initTableByExternalData(sequenceCount, entriesNum, (IndexEntryLocal*) entriesData, (size_t *)entriesOffsetsData);
+    }
     return retTable;
 }
 
+void PrefilteringIndexReader::writeScoreMatrix(DBWriter &writer, const ScoreMatrix &mat, unsigned int key) {
+    writer.writeStart(0);
+    writer.writeAdd((const char *) mat.score, mat.elementSize * mat.rowSize * sizeof(short), 0);
+    writer.writeAdd((const char *) mat.index, mat.elementSize * mat.rowSize * sizeof(unsigned int), 0);
+    writer.writeEnd(key, 0);
+    writer.alignToPageSize();
+}
+
 void PrefilteringIndexReader::printMeta(int *metadata_tmp) {
     Debug(Debug::INFO) << "KmerSize:     " << metadata_tmp[0] << "\n";
     Debug(Debug::INFO) << "AlphabetSize: " << metadata_tmp[1] << "\n";
@@ -326,10 +367,15 @@ void PrefilteringIndexReader::printSummary(DBReader<unsigned int> *dbr) {
 
     int *meta = (int *)dbr->getDataByDBKey(META);
     printMeta(meta);
+    Debug(Debug::INFO) << "Compressed:   " << (isCompressed(dbr) ? 1 : 0) << "\n";
 
     Debug(Debug::INFO) << "ScoreMatrix:  " << dbr->getDataByDBKey(SCOREMATRIXNAME) << "\n";
 }
 
+bool PrefilteringIndexReader::isCompressed(DBReader<unsigned int> *dbr) {
+    return dbr->getId(ENTRIESPACKED) != UINT_MAX;
+}
+
 PrefilteringIndexData PrefilteringIndexReader::getMetadata(DBReader<unsigned int> *dbr) {
     int *meta = (int *)dbr->getDataByDBKey(META);
 
@@ -397,4 +443,19 @@ std::string PrefilteringIndexReader::searchForIndex(const std::string &pathToDB)
     return "";
 }
 
-
+void PrefilteringIndexReader::prefaultIndex(DBReader<unsigned int> *dbr) {
+    // in the order the prefilter reads them
+    const unsigned int keys[] = {SCOREMATRIX2MER, SCOREMATRIX3MER, ENTRIESOFFSETS, ENTRIES,
+                                 SEQINDEXSEQOFFSET, MASKEDSEQINDEXDATA, UNMASKEDSEQINDEXDATA};
+    std::vector<size_t> ids;
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        size_t id = dbr->getId(keys[i]);
+        if (id != UINT_MAX) {
+            ids.push_back(id);
+        }
+    }
+    dbr->prefetch(ids);
+    for (size_t i = 0; i < ids.size(); i++) {
+        dbr->touchData(ids[i]);
+    }
+}
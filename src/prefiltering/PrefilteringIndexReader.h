@@ -6,6 +6,8 @@
 #include "DBReader.h"
 #include <string>
 
+class DBWriter;
+
 struct PrefilteringIndexData {
     int kmerSize;
     int alphabetSize;
@@ -20,6 +22,7 @@ struct PrefilteringIndexData {
 class PrefilteringIndexReader {
 public:
     static const char*  CURRENT_VERSION;
+    static const char*  UNPACKED_VERSION;
     static unsigned int VERSION;
     static unsigned int ENTRIES;
     static unsigned int ENTRIESOFFSETS;
@@ -36,12 +39,13 @@ public:
     static unsigned int DBRINDEX;
     static unsigned int HDRINDEX;
     static unsigned int GENERATOR;
+    static unsigned int ENTRIESPACKED;
 
     static bool checkIfIndexFile(DBReader<unsigned int> *reader);
 
     static void createIndexFile(const std::string &outDb, DBReader<unsigned int> *dbr, DBReader<unsigned int> *hdbr,
                                 BaseMatrix *subMat, int maxSeqLen, bool spacedKmer, bool compBiasCorrection,
-                                int alphabetSize, int kmerSize, int maskMode, int kmerThr);
+                                int alphabetSize, int kmerSize, int maskMode, int kmerThr, bool compressIndex);
 
     static DBReader<unsigned int> *openNewHeaderReader(DBReader<unsigned int> *dbr, const char* dataFileName, bool touch);
 
@@ -57,6 +61,9 @@ public:
 
     static PrefilteringIndexData getMetadata(DBReader<unsigned int> *dbr);
 
+    // k-mer lists are stored bit packed
+    static bool isCompressed(DBReader<unsigned int> *dbr);
+
     static std::string getSubstitutionMatrixName(DBReader<unsigned int> *dbr);
 
     static ScoreMatrix *get2MerScoreMatrix(DBReader<unsigned int> *dbr, bool touch);
@@ -65,8 +72,15 @@ public:
 
     static std::string searchForIndex(const std::string &pathToDB);
 
+    // faults in the blocks a search reads while the index is already used in place,
+    // the reads of all blocks are queued first, so the pages are mapped without waiting for each read
+    static void prefaultIndex(DBReader<unsigned int> *dbr);
+
 private:
     static void printMeta(int *meta);
+
+    // writes the matrix in the layout of ScoreMatrix::serialize
+    static void writeScoreMatrix(DBWriter &writer, const ScoreMatrix &mat, unsigned int key);
 };
 
 #endif
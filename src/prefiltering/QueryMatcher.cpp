@@ -7,6 +7,7 @@
 #include "SubstitutionMatrix.h"
 #include "QueryMatcher.h"
 #include "Util.h"
+#include "Timer.h"
 
 #define FE_1(WHAT, X) WHAT(X)
 #define FE_2(WHAT, X, ...) WHAT(X)FE_1(WHAT, __VA_ARGS__)
@@ -68,7 +69,7 @@ QueryMatcher::QueryMatcher(IndexTable *indexTable, SequenceLookup *sequenceLooku
     // needed for p-value calc.
     this->logScoreFactorial=NULL;
     if (diagonalScoring == true) {
-        ungappedAlignment = new UngappedAlignment(maxSeqLen, m, sequenceLookup);
+        ungappedAlignment = UngappedAlignment::create(maxSeqLen, m, sequenceLookup);
         this->seqLens = NULL;
     } else {
         this->mu = kmerMatchProb;
@@ -87,6 +88,7 @@ QueryMatcher::QueryMatcher(IndexTable *indexTable, SequenceLookup *sequenceLooku
         }
     }
     compositionBias = new float[maxSeqLen];
+    this->phaseTiming = false;
 }
 
 QueryMatcher::~QueryMatcher(){
@@ -139,11 +141,21 @@ std::pair<hit_t *, size_t> QueryMatcher::matchQuery (Sequence * querySeq, unsign
         memset(compositionBias, 0, sizeof(float) * querySeq->L);
     }
 
+    Timer phaseTimer;
     size_t resultSize = match(querySeq, compositionBias);
+    stats->countSeconds = phaseTimer.elapsedSeconds() - stats->kmerSeconds;
+    phaseTimer.reset();
+    stats->ungappedCount = 0;
+    stats->ungappedSeconds = 0.0;
     std::pair<hit_t *, size_t > queryResult;
+    // getResult takes at most maxHitsPerQuery hits and skips the query itself
+    const size_t maxSortedHits = maxHitsPerQuery + 1;
     if(diagonalScoring == true) {
         // write diagonal scores in count value
+        Timer ungappedTimer;
         ungappedAlignment->processQuery(querySeq, compositionBias, foundDiagonals, resultSize, 0);
+        stats->ungappedCount += resultSize;
+        stats->ungappedSeconds += ungappedTimer.elapsedSeconds();
         memset(scoreSizes, 0, SCORE_RANGE * sizeof(unsigned int));
 
 
@@ -158,14 +170,19 @@ std::pair<hit_t *, size_t> QueryMatcher::matchQuery (Sequence * querySeq, unsign
         if(resultSize < counterResultSize/2){
             unsigned int maxDiagonalScoreThr = (UCHAR_MAX - ungappedAlignment->getQueryBias());
             bool scoreIsTruncated = (diagonalThr >= maxDiagonalScoreThr) ? true : false;
-            int elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, foundDiagonals + resultSize, diagonalThr, foundDiagonals, resultSize);
+            // hits above the truncated score are rescored before they are ranked, all of them are needed
+            const size_t maxElements = (scoreIsTruncated == true) ? resultSize : maxSortedHits;
+            int elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, foundDiagonals + resultSize, diagonalThr, foundDiagonals, resultSize, maxElements);
             if(scoreIsTruncated == true){
                 memset(scoreSizes, 0, SCORE_RANGE * sizeof(unsigned int));
+                ungappedTimer.reset();
                 std::pair<size_t, unsigned int> rescoreResult = rescoreHits(querySeq, scoreSizes, foundDiagonals + resultSize, resultSize, ungappedAlignment, maxDiagonalScoreThr);
                 size_t newResultSize = rescoreResult.first;
+                stats->ungappedCount += newResultSize;
+                stats->ungappedSeconds += ungappedTimer.elapsedSeconds();
                 unsigned int maxSelfScoreMinusDiag = rescoreResult.second;
 
-                elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, foundDiagonals, 0, foundDiagonals + resultSize, newResultSize);
+                elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, foundDiagonals, 0, foundDiagonals + resultSize, newResultSize, maxSortedHits);
                 queryResult = getResult(foundDiagonals, elementsCntAboveDiagonalThr, maxHitsPerQuery,
                                         querySeq->L, identityId, 0, ungappedAlignment, true, maxSelfScoreMinusDiag);
             }else{
@@ -179,7 +196,7 @@ std::pair<hit_t *, size_t> QueryMatcher::matchQuery (Sequence * querySeq, unsign
         unsigned int thr = computeScoreThreshold(scoreSizes, this->maxHitsPerQuery);
         if(resultSize < counterResultSize/2) {
 
-            int elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, foundDiagonals + resultSize, thr, foundDiagonals, resultSize);
+            int elementsCntAboveDiagonalThr = radixSortByScoreSize(scoreSizes, foundDiagonals + resultSize, thr, foundDiagonals, resultSize, maxSortedHits);
             queryResult = getResult(foundDiagonals + resultSize, elementsCntAboveDiagonalThr, maxHitsPerQuery, querySeq->L, identityId, thr, ungappedAlignment,
                                     false, 0);
         }else{
@@ -195,6 +212,7 @@ std::pair<hit_t *, size_t> QueryMatcher::matchQuery (Sequence * querySeq, unsign
             std::sort(resList, resList + queryResult.second, hit_t::compareHitsByPValueAndId);
         }
     }
+    stats->resultSeconds = phaseTimer.elapsedSeconds() - stats->ungappedSeconds;
     return queryResult;
 }
 
@@ -206,12 +224,18 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
     size_t overflowHitCount = 0;
     //size_t pos = 0;
     stats->diagonalOverflow = false;
+    stats->overflowCount = 0;
+    stats->kmerSeconds = 0.0;
     IndexEntryLocal* sequenceHits = databaseHits;
     size_t seqListSize;
     unsigned short indexStart = 0;
     unsigned short indexTo = 0;
     Indexer idx(indexTable->getAlphabetSize(), kmerSize);
     const int xIndex = m->aa2int[(int)'X'];
+    const bool compressedIndex = indexTable->isCompressed();
+    const IndexEntryLocal *entries = NULL;
+    const unsigned char *packedEntries = NULL;
+    Timer kmerTimer;
 
     while(seq->hasNextKmer()){
         const int * kmer = seq->nextKmer();
@@ -244,9 +268,15 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
             exactKmer = idx.int2index(kmer);
             index = &exactKmer;
         }else{
+            if (phaseTiming) {
+                kmerTimer.reset();
+            }
             ScoreMatrix kmerList = kmerGenerator->generateKmerList(kmer);
             kmerElementSize = kmerList.elementSize;
             index = kmerList.index;
+            if (phaseTiming) {
+                stats->kmerSeconds += kmerTimer.elapsedSeconds();
+            }
         }
         //std::cout << kmer << std::endl;
         indexPointer[current_i] = sequenceHits;
@@ -261,7 +291,11 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
 //                        idx.printKmer(index[kmerPos], kmerSize, m->int2aa);
 //                        std::cout << std::endl;
 
-            const IndexEntryLocal *entries = indexTable->getDBSeqList(index[kmerPos], &seqListSize);
+            if (compressedIndex) {
+                packedEntries = indexTable->getPackedDBSeqList(index[kmerPos], &seqListSize);
+            } else {
+                entries = indexTable->getDBSeqList(index[kmerPos], &seqListSize);
+            }
 
             /////DEBUG
            /* 
@@ -277,6 +311,7 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
             // detected overflow while matching
             if ((sequenceHits + seqListSize) >= lastSequenceHit) {
                 stats->diagonalOverflow = true;
+                stats->overflowCount++;
                 // last pointer
                 indexPointer[current_i + 1] = sequenceHits;
 //                std::cout << "Overflow in i=" << indexStart << std::endl;
@@ -300,7 +335,13 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
                     goto outer;
                 }
             };
-            memcpy(sequenceHits, entries, sizeof(IndexEntryLocal) * seqListSize);
+            if (compressedIndex) {
+                if (seqListSize > 0) {
+                    IndexTable::unpackDBSeqList(packedEntries, seqListSize, sequenceHits);
+                }
+            } else {
+                memcpy(sequenceHits, entries, sizeof(IndexEntryLocal) * seqListSize);
+            }
             sequenceHits += seqListSize;
             numMatches += seqListSize;
         }
@@ -323,6 +364,8 @@ size_t QueryMatcher::match(Sequence *seq, float *compositionBias) {
     stats->kmersPerPos   = ((double)kmerListLen/(double)seq->L);
     stats->querySeqLen   = seq->L;
     stats->dbMatches     = overflowNumMatches + numMatches;
+    stats->kmerListLen   = kmerListLen;
+    stats->diagonalBins  = hitCount;
     return hitCount;
 }
 
@@ -477,19 +520,26 @@ size_t QueryMatcher::radixSortByScoreSize(const unsigned int * scoreSizes,
                                         CounterResult *writePos,
                                         const unsigned int scoreThreshold,
                                         const CounterResult *results,
-                                        const size_t resultSize) {
+                                        const size_t resultSize,
+                                        const size_t maxElements) {
+    // highest score first, every bucket keeps the earliest elements that still fit into maxElements
     CounterResult * ptr[SCORE_RANGE];
-    ptr[0] = writePos+resultSize;
-    CounterResult * ptr_prev=ptr[0];
-    for(unsigned int i = 0; i < SCORE_RANGE; i++){
-        ptr[i] = ptr_prev - scoreSizes[i];
-        ptr_prev = ptr[i];
+    size_t bucketFree[SCORE_RANGE];
+    size_t capacity = 0;
+    CounterResult * ptr_prev = writePos;
+    for(unsigned int i = SCORE_RANGE; i-- > 0; ){
+        bucketFree[i] = (i >= scoreThreshold) ? std::min(static_cast<size_t>(scoreSizes[i]), maxElements - capacity) : 0;
+        capacity += bucketFree[i];
+        ptr[i] = ptr_prev;
+        ptr_prev += bucketFree[i];
     }
     size_t aboveThresholdCnt = 0;
-    for (size_t i = 0; i < resultSize; i++) {
+    // stop as soon as all kept buckets are full, the remaining elements would be cut off anyway
+    for (size_t i = 0; i < resultSize && aboveThresholdCnt < capacity; i++) {
         const unsigned int scoreCurr = results[i].count;
-        if(scoreCurr >= scoreThreshold) {
+        if(bucketFree[scoreCurr] > 0) {
             aboveThresholdCnt++;
+            bucketFree[scoreCurr]--;
             CounterResult*res = ptr[scoreCurr];
             res->id = results[i].id;
             res->count = results[i].count;
@@ -6,6 +6,9 @@
 #define MMSEQS_QUERYTEMPLATEMATCHEREXACTMATCH_H
 
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
 #include "itoa.h"
 #include "EvalueComputation.h"
 #include "CacheFriendlyOperations.h"
@@ -20,14 +23,29 @@ struct statistics_t{
     size_t querySeqLen;
     size_t diagonalOverflow;
     size_t resultsPassedPrefPerSeq;
-    statistics_t() : kmersPerPos(0.0) , dbMatches(0) , doubleMatches(0), querySeqLen(0), diagonalOverflow(0), resultsPassedPrefPerSeq(0) {};
+    // per query counters and phase times of the last matchQuery call
+    size_t kmerListLen;
+    size_t diagonalBins;
+    size_t ungappedCount;
+    size_t overflowCount;
+    double kmerSeconds;
+    double countSeconds;
+    double ungappedSeconds;
+    double resultSeconds;
+    statistics_t() : kmersPerPos(0.0) , dbMatches(0) , doubleMatches(0), querySeqLen(0), diagonalOverflow(0), resultsPassedPrefPerSeq(0),
+                     kmerListLen(0), diagonalBins(0), ungappedCount(0), overflowCount(0),
+                     kmerSeconds(0.0), countSeconds(0.0), ungappedSeconds(0.0), resultSeconds(0.0) {};
     statistics_t(double kmersPerPos, size_t dbMatches,
                  size_t doubleMatches, size_t querySeqLen, size_t diagonalOverflow, size_t resultsPassedPrefPerSeq) : kmersPerPos(kmersPerPos),
                                                                                                                       dbMatches(dbMatches),
                                                                                                                       doubleMatches(doubleMatches),
                                                                                                                       querySeqLen(querySeqLen),
                                                                                                                       diagonalOverflow(diagonalOverflow),
-                                                                                                                      resultsPassedPrefPerSeq(resultsPassedPrefPerSeq){};
+                                                                                                                      resultsPassedPrefPerSeq(resultsPassedPrefPerSeq),
+                                                                                                                      kmerListLen(0), diagonalBins(0),
+                                                                                                                      ungappedCount(0), overflowCount(0),
+                                                                                                                      kmerSeconds(0.0), countSeconds(0.0),
+                                                                                                                      ungappedSeconds(0.0), resultSeconds(0.0){};
 };
 
 struct hit_t {
@@ -89,6 +107,11 @@ public:
         this->kmerGenerator->setDivideStrategy(three, two );
     }
 
+    // also time the k-mer generation separately from the index lookup, costs a clock read per query position
+    void setPhaseTiming(bool phaseTiming) {
+        this->phaseTiming = phaseTiming;
+    }
+
     // get statistics
     const statistics_t * getStatistics(){
         return stats;
@@ -147,6 +170,27 @@ public:
         return ret;
     }
 
+    // entries of DBReader::DBTYPE_PREFILTER_BINARY databases are packed hit_t records
+    static std::vector<hit_t> parseBinaryPrefilterHits(const char *data, size_t entryLength) {
+        const size_t count = (entryLength == 0) ? 0 : (entryLength - 1) / sizeof(hit_t);
+        std::vector<hit_t> ret(count);
+        if (count > 0) {
+            memcpy(&ret[0], data, count * sizeof(hit_t));
+        }
+        return ret;
+    }
+
+    static void binaryPrefilterHitsToText(const char *data, size_t entryLength, std::string &out) {
+        char buffer[100];
+        const size_t count = (entryLength == 0) ? 0 : (entryLength - 1) / sizeof(hit_t);
+        for (size_t i = 0; i < count; i++) {
+            hit_t hit;
+            memcpy(&hit, data + i * sizeof(hit_t), sizeof(hit_t));
+            size_t len = prefilterHitToBuffer(buffer, hit);
+            out.append(buffer, len);
+        }
+    }
+
     static size_t prefilterHitToBuffer(char *buff1, hit_t &h)
     {
         char * basePos = buff1;
@@ -245,6 +289,8 @@ protected:
     // match sequence against the IndexTable
     size_t match(Sequence *seq, float *pDouble);
 
+    bool phaseTiming;
+
     // extract result from databaseHits
     std::pair<hit_t *, size_t> getResult(CounterResult * results,
                                          size_t resultSize,
@@ -272,9 +318,12 @@ protected:
 
     size_t keepMaxScoreElementOnly(CounterResult *foundDiagonals, size_t resultSize);
 
+    // writes the results with a score of at least scoreThreshold to writePos, ordered by descending score
+    // only the first maxElements of that order are written, so ties at the threshold are not all copied
     size_t radixSortByScoreSize(const unsigned int *scoreSizes,
                               CounterResult *writePos, const unsigned int scoreThreshold,
-                              const CounterResult *results, const size_t resultSize);
+                              const CounterResult *results, const size_t resultSize,
+                              const size_t maxElements);
 
     std::pair<size_t, unsigned int> rescoreHits(Sequence * querySeq, unsigned int *scoreSizes, CounterResult *results,
                                                 int resultSize, UngappedAlignment *align, int lowerBoundScore);
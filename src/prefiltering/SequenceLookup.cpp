@@ -9,8 +9,10 @@
 #include "SequenceLookup.h"
 
 SequenceLookup::SequenceLookup(size_t dbSize, size_t entrySize)
-        : sequenceCount(dbSize), dataSize(entrySize), currentIndex(0), currentOffset(0), externalData(false) {
-    data = new(std::nothrow) char[dataSize + 1];
+        : sequenceCount(dbSize), dataSize(entrySize), currentIndex(0), currentOffset(0), externalData(false),
+          dataPageType(Util::NORMAL_PAGES) {
+    // residues are fetched at random positions for the diagonal scoring
+    data = (char *) Util::allocHugePages(dataSize + 1, &dataPageType);
     Util::checkAllocation(data, "Could not allocate data memory in SequenceLookup");
 
     offsets = new(std::nothrow) size_t[sequenceCount + 1];
@@ -19,12 +21,13 @@ SequenceLookup::SequenceLookup(size_t dbSize, size_t entrySize)
 }
 
 SequenceLookup::SequenceLookup(size_t dbSize)
-        : sequenceCount(dbSize), data(NULL), dataSize(0), offsets(NULL), currentIndex(0), currentOffset(0), externalData(true) {
+        : sequenceCount(dbSize), data(NULL), dataSize(0), offsets(NULL), currentIndex(0), currentOffset(0), externalData(true),
+          dataPageType(Util::NORMAL_PAGES) {
 }
 
 SequenceLookup::~SequenceLookup() {
     if(externalData == false){
-        delete[] data;
+        Util::freeHugePages(data, dataSize + 1, dataPageType);
         delete[] offsets;
     }
 }
@@ -61,6 +64,10 @@ size_t *SequenceLookup::getOffsets() {
     return offsets;
 }
 
+Util::HugePageType SequenceLookup::getDataPageType() {
+    return dataPageType;
+}
+
 size_t SequenceLookup::getSequenceCount() {
     return sequenceCount;
 }
@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include "Sequence.h"
+#include "Util.h"
 
 class SequenceLookup {
 
@@ -33,6 +34,8 @@ public:
 
     size_t *getOffsets();
 
+    Util::HugePageType getDataPageType();
+
     void initLookupByExternalData(char *seqData, size_t dataSize, size_t *seqOffsets);
 
 private:
@@ -50,6 +53,8 @@ private:
 
     // if data are read from mmap
     bool externalData;
+
+    Util::HugePageType dataPageType;
 };
 
 
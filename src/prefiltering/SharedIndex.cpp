@@ -0,0 +1,218 @@
+#include "SharedIndex.h"
+#include "Debug.h"
+#include "Util.h"
+
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// segments of other versions are not attached
+const char SharedIndex::MAGIC[8] = {'M', 'M', 'S', 'H', 'I', 'D', 'X', '1'};
+
+SharedIndex::SharedIndex(const std::string &name, int fd, char *memory, size_t size)
+        : name(name), fd(fd), memory(memory), size(size) {}
+
+// shm_open creates the segments in the tmpfs mounted there
+static const char SEGMENT_DIR[] = "/dev/shm";
+static const char SEGMENT_PREFIX[] = "mmseqs-index-";
+
+static std::string getSegmentPath(const std::string &name) {
+    return SEGMENT_DIR + name;
+}
+
+// the name might already belong to a newer segment if the one of fd was removed meanwhile
+static void unlinkSegment(int fd, const std::string &name) {
+    struct stat fdStat;
+    struct stat nameStat;
+    if (fstat(fd, &fdStat) == 0 && stat(getSegmentPath(name).c_str(), &nameStat) == 0
+        && fdStat.st_dev == nameStat.st_dev && fdStat.st_ino == nameStat.st_ino) {
+        shm_unlink(name.c_str());
+    }
+}
+
+SharedIndex::~SharedIndex() {
+    munmap(memory, size);
+    // no other process holds a shared lock if the exclusive one can be taken
+    if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+        unlinkSegment(fd, name);
+    }
+    close(fd);
+}
+
+void SharedIndex::removeUnusedSegments() {
+    DIR *dir = opendir(SEGMENT_DIR);
+    if (dir == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, SEGMENT_PREFIX, sizeof(SEGMENT_PREFIX) - 1) != 0) {
+            continue;
+        }
+        const std::string name = std::string("/") + entry->d_name;
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            continue;
+        }
+        // left by processes that were killed, every live user of a segment holds a shared lock
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+            Debug(Debug::INFO) << "Removing unused shared index " << name << "\n";
+            unlinkSegment(fd, name);
+        }
+        close(fd);
+    }
+    closedir(dir);
+}
+
+std::string SharedIndex::getName(const std::string &key) {
+    char name[64];
+    snprintf(name, sizeof(name), "/mmseqs-index-%016zx", Util::hash(key.c_str(), key.size()));
+    return std::string(name);
+}
+
+SharedIndex *SharedIndex::attach(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (flock(fd, LOCK_SH) != 0) {
+        close(fd);
+        return NULL;
+    }
+    struct stat sb;
+    char *memory = NULL;
+    if (fstat(fd, &sb) == 0 && (size_t) sb.st_size >= sizeof(Header)) {
+        memory = (char *) mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            memory = NULL;
+        }
+    }
+    const Header *header = (const Header *) memory;
+    if (memory == NULL || memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->size != (uint64_t) sb.st_size) {
+        if (memory != NULL) {
+            munmap(memory, sb.st_size);
+        }
+        // segments are only published complete, this one was written by an incompatible version
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+            Debug(Debug::WARNING) << "Removing invalid shared index " << name << "\n";
+            unlinkSegment(fd, name);
+        }
+        close(fd);
+        return NULL;
+    }
+    return new SharedIndex(name, fd, memory, sb.st_size);
+}
+
+static size_t alignToPage(size_t offset) {
+    const size_t pageSize = Util::getPageSize();
+    return (offset + pageSize - 1) & ~(pageSize - 1);
+}
+
+SharedIndex *SharedIndex::publish(const std::string &name, IndexTable *table, SequenceLookup *lookup) {
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    header.alphabetSize = table->getAlphabetSize();
+    header.kmerSize = table->getKmerSize();
+    header.sequenceCount = table->getSize();
+    header.tableEntriesNum = table->getTableEntriesNum();
+    header.compressed = table->isCompressed() ? 1 : 0;
+    header.entriesOffset = alignToPage(sizeof(Header));
+    header.entriesSize = table->getEntriesDataSize();
+    header.offsetsOffset = alignToPage(header.entriesOffset + header.entriesSize);
+    size_t end = header.offsetsOffset + table->getOffsetsSize();
+    if (lookup != NULL) {
+        header.lookupSequenceCount = lookup->getSequenceCount();
+        header.lookupDataOffset = alignToPage(end);
+        header.lookupDataSize = lookup->getDataSize();
+        header.lookupOffsetsOffset = alignToPage(header.lookupDataOffset + header.lookupDataSize + 1);
+        end = header.lookupOffsetsOffset + (header.lookupSequenceCount + 1) * sizeof(size_t);
+    }
+    header.size = end;
+
+    removeUnusedSegments();
+
+    // the segment is filled under a name of its own and linked to the name attaching processes open
+    // once it is complete, so they never see a partial segment
+    const std::string tmpName = name + "-" + SSTR(getpid());
+    int fd = shm_open(tmpName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        Debug(Debug::WARNING) << "Could not create shared index " << tmpName << ". Error " << errno << "\n";
+        return NULL;
+    }
+    // held until the process detaches, so removeUnusedSegments of other processes keeps the segment
+    flock(fd, LOCK_SH);
+    // reserve the memory, writing to a segment that does not fit into /dev/shm would raise SIGBUS
+    int err = posix_fallocate(fd, 0, header.size);
+    char *memory = NULL;
+    if (err == 0) {
+        memory = (char *) mmap(NULL, header.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            err = errno;
+            memory = NULL;
+        }
+    }
+    if (memory == NULL) {
+        Debug(Debug::WARNING) << "Could not allocate " << header.size << " bytes for shared index " << name << ". Error " << err << "\n";
+        shm_unlink(tmpName.c_str());
+        close(fd);
+        return NULL;
+    }
+
+    memcpy(memory + header.entriesOffset, table->getEntriesData(), header.entriesSize);
+    memcpy(memory + header.offsetsOffset, table->getOffsets(), table->getOffsetsSize());
+    if (lookup != NULL) {
+        memcpy(memory + header.lookupDataOffset, lookup->getData(), header.lookupDataSize + 1);
+        memcpy(memory + header.lookupOffsetsOffset, lookup->getOffsets(), (header.lookupSequenceCount + 1) * sizeof(size_t));
+    }
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    memcpy(memory, &header, sizeof(Header));
+    mprotect(memory, header.size, PROT_READ);
+
+    // link does not replace an existing name, unlike rename
+    err = 0;
+    if (link(getSegmentPath(tmpName).c_str(), getSegmentPath(name).c_str()) != 0) {
+        err = errno;
+    }
+    shm_unlink(tmpName.c_str());
+    if (err != 0) {
+        if (err != EEXIST) {
+            Debug(Debug::WARNING) << "Could not publish shared index " << name << ". Error " << err << "\n";
+        }
+        munmap(memory, header.size);
+        close(fd);
+        return NULL;
+    }
+
+    return new SharedIndex(name, fd, memory, header.size);
+}
+
+IndexTable *SharedIndex::getIndexTable() {
+    const Header *header = (const Header *) memory;
+    IndexTable *table = new IndexTable(header->alphabetSize, header->kmerSize, true);
+    if (header->compressed) {
+        table->initPackedTableByExternalData(header->sequenceCount, header->tableEntriesNum,
+                                             (unsigned char *) (memory + header->entriesOffset), header->entriesSize,
+                                             (size_t *) (memory + header->offsetsOffset));
+    } else {
+        table->initTableByExternalData(header->sequenceCount, header->tableEntriesNum,
+                                       (IndexEntryLocal *) (memory + header->entriesOffset),
+                                       (size_t *) (memory + header->offsetsOffset));
+    }
+    return table;
+}
+
+SequenceLookup *SharedIndex::getSequenceLookup() {
+    const Header *header = (const Header *) memory;
+    if (header->lookupSequenceCount == 0) {
+        return NULL;
+    }
+    SequenceLookup *lookup = new SequenceLookup(header->lookupSequenceCount);
+    lookup->initLookupByExternalData(memory + header->lookupDataOffset, header->lookupDataSize,
+                                     (size_t *) (memory + header->lookupOffsetsOffset));
+    return lookup;
+}
@@ -0,0 +1,67 @@
+#ifndef MMSEQS_SHAREDINDEX_H
+#define MMSEQS_SHAREDINDEX_H
+
+#include "IndexTable.h"
+#include "SequenceLookup.h"
+
+#include <string>
+
+// Index table and sequence lookup in a named POSIX shared memory segment, concurrent processes
+// that search the same target with the same settings hold them only once.
+// Every attached process keeps a shared flock on the segment and the last one to detach removes it.
+// The segments of killed processes stay until the next publish of any process, which removes
+// all segments without a lock.
+class SharedIndex {
+public:
+    // name of the segment for a key that describes the target database and the index settings
+    static std::string getName(const std::string &key);
+
+    // returns NULL if no valid segment was published under the name
+    static SharedIndex *attach(const std::string &name);
+
+    // copies table and lookup into a new segment, lookup can be NULL
+    // returns NULL if another process published it first or the segment could not be created
+    static SharedIndex *publish(const std::string &name, IndexTable *table, SequenceLookup *lookup);
+
+    // the tables of getIndexTable and getSequenceLookup have to be deleted before
+    ~SharedIndex();
+
+    // use the memory of the segment, the caller deletes them
+    IndexTable *getIndexTable();
+    SequenceLookup *getSequenceLookup();
+
+    size_t getSize() {
+        return size;
+    }
+
+private:
+    static void removeUnusedSegments();
+
+    struct Header {
+        char magic[8];
+        uint64_t size;
+        int64_t alphabetSize;
+        int64_t kmerSize;
+        uint64_t sequenceCount;
+        uint64_t tableEntriesNum;
+        uint64_t compressed;
+        uint64_t entriesOffset;
+        uint64_t entriesSize;
+        uint64_t offsetsOffset;
+        // 0 if there is no sequence lookup
+        uint64_t lookupSequenceCount;
+        uint64_t lookupDataOffset;
+        uint64_t lookupDataSize;
+        uint64_t lookupOffsetsOffset;
+    };
+    static const char MAGIC[8];
+
+    SharedIndex(const std::string &name, int fd, char *memory, size_t size);
+
+    const std::string name;
+    int fd;
+    char *memory;
+    size_t size;
+};
+
+#endif
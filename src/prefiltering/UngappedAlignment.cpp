@@ -3,19 +3,42 @@
 
 #include "UngappedAlignment.h"
 
-UngappedAlignment::UngappedAlignment(const unsigned int maxSeqLen,
+#ifndef SIMD_KERNEL_VARIANT
+UngappedAlignment *UngappedAlignment::create(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
+                                             SequenceLookup *sequenceLookup) {
+#ifdef SIMD_DISPATCH_AVX512BW
+    if (SimdDispatch::getLevel() == SimdDispatch::LEVEL_AVX512BW) {
+        return simd_avx512bw::createUngappedAlignment(maxSeqLen, substitutionMatrix, sequenceLookup);
+    }
+#endif
+    return SIMD_KERNEL_DISPATCH(createUngappedAlignment(maxSeqLen, substitutionMatrix, sequenceLookup));
+}
+#endif
+
+namespace SIMD_KERNEL_NAMESPACE {
+
+UngappedAlignment *createUngappedAlignment(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
+                                           SequenceLookup *sequenceLookup) {
+    return new UngappedAlignmentKernel(maxSeqLen, substitutionMatrix, sequenceLookup);
+}
+
+UngappedAlignmentKernel::UngappedAlignmentKernel(const unsigned int maxSeqLen,
                                      BaseMatrix *substitutionMatrix, SequenceLookup *sequenceLookup)
         : subMatrix(substitutionMatrix), sequenceLookup(sequenceLookup) {
-    score_arr = new unsigned int[VECSIZE_INT*4];
+    score_arr = new unsigned int[BINSIZE];
     diagonalCounter = new unsigned char[DIAGONALCOUNT];
-    vectorSequence = (unsigned char *) malloc_simd_int(VECSIZE_INT * 4 * maxSeqLen);
+    vectorSequence = (unsigned char *) mem_align(BINSIZE, BINSIZE * maxSeqLen);
     queryProfile   = (char *) malloc_simd_int(PROFILESIZE * maxSeqLen);
     memset(queryProfile, 0, PROFILESIZE * maxSeqLen);
     aaCorrectionScore = (char *) malloc_simd_int(maxSeqLen);
-    diagonalMatches = new CounterResult*[DIAGONALCOUNT * (VECSIZE_INT * 4)];
+    diagonalMatches = new CounterResult**[DIAGONALCOUNT];
+    memset(diagonalMatches, 0, DIAGONALCOUNT * sizeof(CounterResult**));
 }
 
-UngappedAlignment::~UngappedAlignment() {
+UngappedAlignmentKernel::~UngappedAlignmentKernel() {
+    for (size_t i = 0; i < DIAGONALCOUNT; i++) {
+        delete [] diagonalMatches[i];
+    }
     delete [] diagonalMatches;
     free(aaCorrectionScore);
     free(queryProfile);
@@ -24,7 +47,7 @@ UngappedAlignment::~UngappedAlignment() {
     delete [] score_arr;
 }
 
-void UngappedAlignment::processQuery(Sequence *seq,
+void UngappedAlignmentKernel::processQuery(Sequence *seq,
                                    float *biasCorrection,
                                    CounterResult *results,
                                    size_t resultSize,
@@ -35,7 +58,7 @@ void UngappedAlignment::processQuery(Sequence *seq,
     computeScores(queryProfile, seq->L, results, resultSize, bias, thr);
 }
 
-int UngappedAlignment::scalarDiagonalScoring(const char * profile,
+int UngappedAlignmentKernel::scalarDiagonalScoring(const char * profile,
                                            const int bias,
                                            const unsigned int seqLen,
                                            const unsigned char * dbSeq) {
@@ -52,7 +75,7 @@ int UngappedAlignment::scalarDiagonalScoring(const char * profile,
 }
 
 #ifdef AVX2
-inline __m256i UngappedAlignment::Shuffle(const __m256i & value, const __m256i & shuffle)
+inline __m256i UngappedAlignmentKernel::Shuffle(const __m256i & value, const __m256i & shuffle)
 {
     const __m256i K0 = _mm256_setr_epi8(
             (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70, (char)0x70,
@@ -65,10 +88,32 @@ inline __m256i UngappedAlignment::Shuffle(const __m256i & value, const __m256i &
 }
 #endif
 
-simd_int UngappedAlignment::vectorDiagonalScoring(const char *profile,
+UngappedAlignmentKernel::bin_int UngappedAlignmentKernel::vectorDiagonalScoring(const char *profile,
                                                 const char bias,
                                                 const unsigned int seqLen,
                                                 const unsigned char *dbSeq) {
+#ifdef AVX512BW
+    __m512i vscore        = _mm512_setzero_si512();
+    __m512i vMaxScore     = _mm512_setzero_si512();
+    const __m512i vBias   = _mm512_set1_epi8(bias);
+    const __m512i sixten  = _mm512_set1_epi8(16);
+    for(unsigned int pos = 0; pos < seqLen; pos++){
+        __m512i template01 = _mm512_load_si512((__m512i *)&dbSeq[pos*BINSIZE]);
+        // the byte shuffle looks up 16 scores per 128 bit lane
+        // score 0 - 15 and score 16 - 31 are broadcast to all four lanes
+        // (the zero masked form avoids the undefined source of _mm512_broadcast_i32x4 that GCC warns about)
+        __m512i score_matrix_vec01 = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128((__m128i *)&profile[pos * PROFILESIZE]));
+        __m512i score_matrix_vec16 = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128((__m128i *)&profile[pos * PROFILESIZE + 16]));
+        // t[i] < 16 takes the score from score_matrix_vec01, the others from score_matrix_vec16
+        __mmask64 lookup_mask01 = _mm512_cmplt_epu8_mask(template01, sixten);
+        __m512i score_vec_8bit = _mm512_mask_shuffle_epi8(_mm512_shuffle_epi8(score_matrix_vec16, template01),
+                                                          lookup_mask01, score_matrix_vec01, template01);
+        vscore    = _mm512_adds_epu8(vscore, score_vec_8bit);
+        vscore    = _mm512_subs_epu8(vscore, vBias);
+        vMaxScore = _mm512_max_epu8(vMaxScore, vscore);
+    }
+    return vMaxScore;
+#else
     simd_int vscore        = simdi_setzero();
     simd_int vMaxScore     = simdi_setzero();
     const simd_int vBias   = simdi8_set(bias);
@@ -79,7 +124,7 @@ simd_int UngappedAlignment::vectorDiagonalScoring(const char *profile,
 #endif
 #endif
     for(unsigned int pos = 0; pos < seqLen; pos++){
-        simd_int template01 = simdi_load((simd_int *)&dbSeq[pos*VECSIZE_INT*4]);
+        simd_int template01 = simdi_load((simd_int *)&dbSeq[pos*BINSIZE]);
 #ifdef AVX2
         __m256i score_matrix_vec01 = _mm256_load_si256((simd_int *)&profile[pos * PROFILESIZE]);
         __m256i score_vec_8bit = Shuffle(score_matrix_vec01, template01);
@@ -122,26 +167,28 @@ simd_int UngappedAlignment::vectorDiagonalScoring(const char *profile,
 
     }
     return vMaxScore;
+#endif
 }
 
-std::pair<unsigned char *, unsigned int> UngappedAlignment::mapSequences(std::pair<unsigned char *, unsigned int> * seqs,
+std::pair<unsigned char *, unsigned int> UngappedAlignmentKernel::mapSequences(std::pair<unsigned char *, unsigned int> * seqs,
                                                                        unsigned int seqCount) {
     unsigned int maxLen = 0;
     for(unsigned int seqIdx = 0; seqIdx < seqCount;  seqIdx++) {
         maxLen = std::max(seqs[seqIdx].second, maxLen);
     }
-    memset(vectorSequence, 21, maxLen * VECSIZE_INT * 4 * sizeof(unsigned char));
-    for(unsigned int seqIdx = 0; seqIdx < VECSIZE_INT*4;  seqIdx++){
+    memset(vectorSequence, 21, maxLen * BINSIZE * sizeof(unsigned char));
+    // lanes without a sequence keep the padding
+    for(unsigned int seqIdx = 0; seqIdx < seqCount;  seqIdx++){
         const unsigned char * seq  = seqs[seqIdx].first;
         const unsigned int seqSize = seqs[seqIdx].second;
         for(unsigned int pos = 0; pos < seqSize;  pos++){
-            vectorSequence[pos * VECSIZE_INT * 4 + seqIdx] = seq[pos];
+            vectorSequence[pos * BINSIZE + seqIdx] = seq[pos];
         }
     }
     return std::make_pair(vectorSequence, maxLen);
 }
 
-void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
+void UngappedAlignmentKernel::scoreDiagonalAndUpdateHits(const char * queryProfile,
                                                  const unsigned int queryLen,
                                                  const short diagonal,
                                                  CounterResult ** hits,
@@ -161,8 +208,8 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
         }
         return;
     }
-    if (hitSize > (VECSIZE_INT * 4) / 16) {
-        std::pair<unsigned char *, unsigned int> seqs[VECSIZE_INT * 4];
+    if (hitSize > BINSIZE / 16) {
+        std::pair<unsigned char *, unsigned int> seqs[BINSIZE];
         for (unsigned int seqIdx = 0; seqIdx < hitSize; seqIdx++) {
             std::pair<const unsigned char *, const unsigned int> tmp = sequenceLookup->getSequence(
                     hits[seqIdx]->id);
@@ -176,19 +223,18 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
         }
         std::pair<unsigned char *, unsigned int> seq = mapSequences(seqs, hitSize);
 
-        simd_int vMaxScore = simdi_setzero();
-
+        // the scores are unsigned, no diagonal overlap scores zero
+        unsigned int minSeqLen = 0;
+        const unsigned char * seqStart = seq.first;
+        const char * profileStart = queryProfile;
         if (diagonal >= 0 && minDistToDiagonal < queryLen) {
-            unsigned int minSeqLen = std::min(seq.second, queryLen - minDistToDiagonal);
-            simd_int ret = vectorDiagonalScoring(queryProfile + (minDistToDiagonal * PROFILESIZE), bias, minSeqLen,
-                                                 seq.first);
-            vMaxScore = simdui8_max(ret, vMaxScore);
+            minSeqLen = std::min(seq.second, queryLen - minDistToDiagonal);
+            profileStart = queryProfile + (minDistToDiagonal * PROFILESIZE);
         } else if (diagonal < 0 && minDistToDiagonal < seq.second) {
-            unsigned int minSeqLen = std::min(seq.second - minDistToDiagonal, queryLen);
-            simd_int ret = vectorDiagonalScoring(queryProfile, bias, minSeqLen,
-                                                 seq.first + minDistToDiagonal * VECSIZE_INT * 4);
-            vMaxScore = simdui8_max(ret, vMaxScore);
+            minSeqLen = std::min(seq.second - minDistToDiagonal, queryLen);
+            seqStart = seq.first + minDistToDiagonal * BINSIZE;
         }
+        bin_int vMaxScore = vectorDiagonalScoring(profileStart, bias, minSeqLen, seqStart);
         extractScores(score_arr, vMaxScore);
         // update score
         for(size_t hitIdx = 0; hitIdx < hitSize; hitIdx++){
@@ -217,7 +263,7 @@ void UngappedAlignment::scoreDiagonalAndUpdateHits(const char * queryProfile,
     }
 }
 
-int UngappedAlignment::computeLongScore(const char * queryProfile, int queryLen,
+int UngappedAlignmentKernel::computeLongScore(const char * queryProfile, int queryLen,
                                          std::pair<const unsigned char *, const unsigned int> &dbSeq,
                                          unsigned short diagonal, short bias){
     int totalMax=0;
@@ -236,7 +282,7 @@ int UngappedAlignment::computeLongScore(const char * queryProfile, int queryLen,
     return totalMax;
 }
 
-void UngappedAlignment::computeScores(const char *queryProfile,
+void UngappedAlignmentKernel::computeScores(const char *queryProfile,
                                     const unsigned int queryLen,
                                     CounterResult * results,
                                     const size_t resultSize,
@@ -249,11 +295,14 @@ void UngappedAlignment::computeScores(const char *queryProfile,
 //            continue;
 //        }
         const unsigned short currDiag = results[i].diagonal;
-        diagonalMatches[currDiag * (VECSIZE_INT * 4) + diagonalCounter[currDiag]] = &results[i];
+        if (diagonalMatches[currDiag] == NULL) {
+            diagonalMatches[currDiag] = new CounterResult*[BINSIZE];
+        }
+        diagonalMatches[currDiag][diagonalCounter[currDiag]] = &results[i];
         diagonalCounter[currDiag]++;
-        if(diagonalCounter[currDiag] >= (VECSIZE_INT * 4) ) {
+        if(diagonalCounter[currDiag] >= BINSIZE ) {
             scoreDiagonalAndUpdateHits(queryProfile, queryLen, static_cast<short>(currDiag),
-                                       &diagonalMatches[currDiag * (VECSIZE_INT * 4)], diagonalCounter[currDiag], bias);
+                                       diagonalMatches[currDiag], diagonalCounter[currDiag], bias);
             diagonalCounter[currDiag] = 0;
         }
     }
@@ -261,21 +310,27 @@ void UngappedAlignment::computeScores(const char *queryProfile,
     for(size_t i = 0; i < DIAGONALCOUNT; i++){
         if(diagonalCounter[i] > 0){
             scoreDiagonalAndUpdateHits(queryProfile, queryLen, static_cast<short>(i),
-                                       &diagonalMatches[i * (VECSIZE_INT * 4)], diagonalCounter[i], bias);
+                                       diagonalMatches[i], diagonalCounter[i], bias);
         }
         diagonalCounter[i] = 0;
     }
 }
 
-unsigned short UngappedAlignment::distanceFromDiagonal(const unsigned short diagonal) {
+unsigned short UngappedAlignmentKernel::distanceFromDiagonal(const unsigned short diagonal) {
     const unsigned short zero = 0;
     const unsigned short dist1 =  zero - diagonal;
     const unsigned short dist2 =  diagonal - zero;
     return std::min(dist1 , dist2);
 }
 
-void UngappedAlignment::extractScores(unsigned int *score_arr, simd_int score) {
-#ifdef AVX2
+void UngappedAlignmentKernel::extractScores(unsigned int *score_arr, bin_int score) {
+#ifdef AVX512BW
+    unsigned char scores[BINSIZE] __attribute__((aligned(64)));
+    _mm512_store_si512((__m512i *)scores, score);
+    for (unsigned int i = 0; i < BINSIZE; i++) {
+        score_arr[i] = scores[i];
+    }
+#elif defined(AVX2)
 #define EXTRACT_AVX(i) score_arr[i] = _mm256_extract_epi8(score, i)
     EXTRACT_AVX(0);  EXTRACT_AVX(1);  EXTRACT_AVX(2);  EXTRACT_AVX(3);
     EXTRACT_AVX(4);  EXTRACT_AVX(5);  EXTRACT_AVX(6);  EXTRACT_AVX(7);
@@ -297,7 +352,7 @@ void UngappedAlignment::extractScores(unsigned int *score_arr, simd_int score) {
 }
 
 
-short UngappedAlignment::createProfile(Sequence *seq,
+short UngappedAlignmentKernel::createProfile(Sequence *seq,
                                      float * biasCorrection,
                                      short **subMat, int alphabetSize) {
     short bias = 0;
@@ -359,7 +414,7 @@ short UngappedAlignment::createProfile(Sequence *seq,
     return bias;
 }
 
-unsigned int UngappedAlignment::diagonalLength(const short diagonal, const unsigned int queryLen,
+unsigned int UngappedAlignmentKernel::diagonalLength(const short diagonal, const unsigned int queryLen,
                                              const unsigned int targetLen) {
     unsigned int diagLen = targetLen;
     if(diagonal >= 0) {
@@ -370,7 +425,7 @@ unsigned int UngappedAlignment::diagonalLength(const short diagonal, const unsig
     return diagLen;
 }
 
-int UngappedAlignment::computeSingelSequenceScores(const char *queryProfile, const unsigned int queryLen,
+int UngappedAlignmentKernel::computeSingelSequenceScores(const char *queryProfile, const unsigned int queryLen,
                                                     std::pair<const unsigned char *, const unsigned int> &dbSeq,
                                                    int diagonal, unsigned int minDistToDiagonal, short bias) {
     int max = 0;
@@ -387,13 +442,13 @@ int UngappedAlignment::computeSingelSequenceScores(const char *queryProfile, con
 }
 
 
-int UngappedAlignment::scoreSingelSequenceByCounterResult(CounterResult &result) {
+int UngappedAlignmentKernel::scoreSingelSequenceByCounterResult(CounterResult &result) {
     std::pair<const unsigned char *, const unsigned int> dbSeq =  sequenceLookup->getSequence(result.id);
     unsigned short minDistToDiagonal = distanceFromDiagonal(result.diagonal);
     return scoreSingleSequence(dbSeq, result.diagonal, minDistToDiagonal);
 }
 
-int UngappedAlignment::scoreSingleSequence(std::pair<const unsigned char *, const unsigned int> dbSeq,
+int UngappedAlignmentKernel::scoreSingleSequence(std::pair<const unsigned char *, const unsigned int> dbSeq,
                                             unsigned short diagonal,
                                             unsigned short minDistToDiagonal) {
     if(queryLen >= 32768 || dbSeq.second >= 32768) {
@@ -403,4 +458,4 @@ int UngappedAlignment::scoreSingleSequence(std::pair<const unsigned char *, cons
     }
 }
 
-
+}
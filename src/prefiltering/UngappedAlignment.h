@@ -7,19 +7,53 @@
 
 #include "SubstitutionMatrix.h"
 #include "simd.h"
+#include "SimdDispatch.h"
 #include "CacheFriendlyOperations.h"
 #include "SequenceLookup.h"
+
 class UngappedAlignment {
 
 public:
+    // kernel for the best instruction set of the CPU, see SimdDispatch
+    static UngappedAlignment *create(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
+                                     SequenceLookup *sequenceLookup);
 
-    UngappedAlignment(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
-                    SequenceLookup *sequenceLookup);
-
-    ~UngappedAlignment();
+    virtual ~UngappedAlignment() {}
 
     // This function computes the diagonal score for each CounterResult object
     // it assigns the diagonal score to the CounterResult object
+    virtual void processQuery(Sequence *seq, float *compositionBias, CounterResult *results,
+                              size_t resultSize, unsigned int thr) = 0;
+
+    virtual int scoreSingelSequenceByCounterResult(CounterResult &result) = 0;
+
+    virtual int scoreSingleSequence(std::pair<const unsigned char *, const unsigned int> dbSeq,
+                                    unsigned short diagonal,
+                                    unsigned short minDistToDiagonal) = 0;
+
+    virtual short getQueryBias() = 0;
+};
+
+SIMD_KERNEL_DECLARE(UngappedAlignment *createUngappedAlignment(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
+                                                               SequenceLookup *sequenceLookup))
+#ifdef SIMD_DISPATCH_AVX512BW
+namespace simd_avx512bw {
+UngappedAlignment *createUngappedAlignment(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
+                                           SequenceLookup *sequenceLookup);
+}
+#endif
+
+namespace SIMD_KERNEL_NAMESPACE {
+
+class UngappedAlignmentKernel : public ::UngappedAlignment {
+
+public:
+
+    UngappedAlignmentKernel(const unsigned int maxSeqLen, BaseMatrix *substitutionMatrix,
+                            SequenceLookup *sequenceLookup);
+
+    ~UngappedAlignmentKernel();
+
     void processQuery(Sequence *seq, float *compositionBias, CounterResult *results,
                       size_t resultSize, unsigned int thr);
 
@@ -36,20 +70,29 @@ public:
 private:
     const static unsigned int DIAGONALCOUNT = 0xFFFF + 1;
     const static unsigned int PROFILESIZE = 32;
+#ifdef AVX512BW
+    typedef __m512i bin_int;
+#else
+    typedef simd_int bin_int;
+#endif
+    // one byte lane per db sequence: 16 (sse), 32 (avx2) or 64 (avx512bw) sequences per diagonal bin
+    const static unsigned int BINSIZE = sizeof(bin_int);
 
     unsigned int *score_arr;
     unsigned char *vectorSequence;
     char *queryProfile;
     unsigned int queryLen;
     short bias;
-    CounterResult ** diagonalMatches;
+    // one bin of BINSIZE hits per diagonal, allocated when the diagonal is first used
+    // all bins would take 32 MB per thread with 64 sequences per bin
+    CounterResult *** diagonalMatches;
     unsigned char * diagonalCounter;
     char * aaCorrectionScore;
     BaseMatrix *subMatrix;
     SequenceLookup *sequenceLookup;
 
-    // this function bins the hit_t by diagonals by distributing each hit in an array of 256 * 16(sse)/32(avx2)
-    // the function scoreDiagonalAndUpdateHits is called for each bin that reaches its maximum (16 or 32)
+    // this function bins the hit_t by diagonals by distributing each hit in an array of 256 * BINSIZE
+    // the function scoreDiagonalAndUpdateHits is called for each bin that reaches its maximum (BINSIZE)
     void computeScores(const char *queryProfile,
                        const unsigned int queryLen,
                        CounterResult * results,
@@ -62,8 +105,8 @@ private:
                                     const unsigned int seqLen,
                                     const unsigned char *dbSeq);
 
-    // scores the diagonal of  16/32 db sequences in parallel
-    simd_int vectorDiagonalScoring(const char *profile,
+    // scores the diagonal of BINSIZE db sequences in parallel
+    bin_int vectorDiagonalScoring(const char *profile,
                                          const char bias, const unsigned int seqLen, const unsigned char *dbSeq);
 
     std::pair<unsigned char *, unsigned int> mapSequences(std::pair<unsigned char *, unsigned int> * seqs, unsigned int seqCount);
@@ -80,7 +123,7 @@ private:
 
     unsigned short distanceFromDiagonal(const unsigned short diagonal);
 
-    void extractScores(unsigned int *score_arr, simd_int score);
+    void extractScores(unsigned int *score_arr, bin_int score);
 
     short createProfile(Sequence *seq, float *biasCorrection, short **subMat, int alphabetSize);
 
@@ -97,5 +140,6 @@ private:
 
 };
 
+}
 
 #endif //MMSEQS_DIAGONALMATCHER_H
@@ -66,7 +66,7 @@ int main (int argc, const char * argv[]) {
     Sequence* dbSeq = new Sequence(10000, 0, &subMat, kmer_size, true, false);
     //dbSeq->mapSequence(1,"lala2",ref_seq);
     dbSeq->mapSequence(1,1,tim2.c_str());
-    SmithWaterman aligner(15000, subMat.alphabetSize, true);
+    SmithWaterman *aligner = SmithWaterman::create(15000, subMat.alphabetSize, true);
     int8_t * tinySubMat = new int8_t[subMat.alphabetSize*subMat.alphabetSize];
     for (int i = 0; i < subMat.alphabetSize; i++) {
         for (int j = 0; j < subMat.alphabetSize; j++) {
@@ -81,14 +81,14 @@ int main (int argc, const char * argv[]) {
         sum += subMat.subMatrix[i][i];
     }
     std::cout << "Test: " << sum/ subMat.alphabetSize << std::endl;
-    aligner.ssw_init(s, tinySubMat, &subMat, subMat.alphabetSize, 2);
+    aligner->ssw_init(s, tinySubMat, &subMat, subMat.alphabetSize, 2);
     int32_t maskLen = s->L / 2;
     int gap_open = 11;
     int gap_extend = 1;
     float seqId = 1.0;
     int aaIds = 0;
     EvalueComputation evalueComputation(100000, &subMat, gap_open, gap_extend, true );
-    s_align alignment = aligner.ssw_align(dbSeq->int_sequence, dbSeq->L, gap_open, gap_extend, 2, 10000, &evalueComputation, 0, 0.0, maskLen);
+    s_align alignment = aligner->ssw_align(dbSeq->int_sequence, dbSeq->L, gap_open, gap_extend, 2, 10000, &evalueComputation, 0, 0.0, maskLen);
     if(alignment.cigar){
         std::cout << "Cigar" << std::endl;
 
@@ -163,6 +163,7 @@ int main (int argc, const char * argv[]) {
     delete [] alignment.cigar;
     delete s;
     delete dbSeq;
+    delete aligner;
     return 0;
 }
 
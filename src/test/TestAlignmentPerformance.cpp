@@ -70,7 +70,7 @@ int main (int argc, const char * argv[])
     Sequence* query = new Sequence(10000, 0, &subMat, kmer_size, true, false);
     Sequence* dbSeq = new Sequence(10000, 0, &subMat, kmer_size, true, false);
     //dbSeq->mapSequence(1,"lala2",ref_seq);
-    SmithWaterman aligner(15000, subMat.alphabetSize, false);
+    SmithWaterman *aligner = SmithWaterman::create(15000, subMat.alphabetSize, false);
     int8_t * tinySubMat = new int8_t[subMat.alphabetSize*subMat.alphabetSize];
     for (int i = 0; i < subMat.alphabetSize; i++) {
         for (int j = 0; j < subMat.alphabetSize; j++) {
@@ -88,13 +88,13 @@ int main (int argc, const char * argv[])
     std::vector<std::string> sequences = readData("/Users/mad/Documents/databases/rfam/Rfam.fasta");
     for(size_t seq_i = 0; seq_i < sequences.size(); seq_i++){
         query->mapSequence(1,1,sequences[seq_i].c_str());
-        aligner.ssw_init(query, tinySubMat, &subMat, subMat.alphabetSize, 2);
+        aligner->ssw_init(query, tinySubMat, &subMat, subMat.alphabetSize, 2);
 
         for(size_t seq_j = 0; seq_j < sequences.size(); seq_j++) {
             dbSeq->mapSequence(2, 2, sequences[seq_j].c_str());
             int32_t maskLen = query->L / 2;
             EvalueComputation evalueComputation(100000, &subMat, gap_open, gap_extend, true );
-            s_align alignment = aligner.ssw_align(dbSeq->int_sequence, dbSeq->L, gap_open, gap_extend, 0, 10000, &evalueComputation, 0, 0.0, maskLen);
+            s_align alignment = aligner->ssw_align(dbSeq->int_sequence, dbSeq->L, gap_open, gap_extend, 0, 10000, &evalueComputation, 0, 0.0, maskLen);
             if(mode == 0 ){
                 cells += query->L * dbSeq->L;
                 std::cout << alignment.qEndPos1 << " " << alignment.dbEndPos1 << "\n";
@@ -108,6 +108,7 @@ int main (int argc, const char * argv[])
     delete [] tinySubMat;
     delete query;
     delete dbSeq;
+    delete aligner;
     return 0;
 }
 
@@ -169,7 +169,7 @@ int main (int argc, const char * argv[])
     Sequence* dbSeq = new Sequence(10000, 0, &subMat, kmer_size, true, false);
     //dbSeq->mapSequence(1,"lala2",ref_seq);
     dbSeq->mapSequence(1,1,tim2.c_str());
-    SmithWaterman aligner(15000, subMat.alphabetSize, false);
+    SmithWaterman *aligner = SmithWaterman::create(15000, subMat.alphabetSize, false);
     int8_t * tinySubMat = new int8_t[subMat.alphabetSize*subMat.alphabetSize];
     for (int i = 0; i < subMat.alphabetSize; i++) {
         for (int j = 0; j < subMat.alphabetSize; j++) {
@@ -196,6 +196,7 @@ int main (int argc, const char * argv[])
 
     delete s;
     delete dbSeq;
+    delete aligner;
     return 0;
 }
 
@@ -97,7 +97,7 @@ int main(int argc, char **argv)
 
     float * compositionBias = new float[10000];
     CounterResult hits[32];
-    UngappedAlignment matcher(10000, &subMat, &lookup);
+    UngappedAlignment *matcher = UngappedAlignment::create(10000, &subMat, &lookup);
 
     SubstitutionMatrix::calcLocalAaBiasCorrection(&subMat, s5.int_sequence, s5.L, compositionBias);
     memset(compositionBias, 0.0, sizeof(float)*s5.L);
@@ -115,7 +115,7 @@ int main(int argc, char **argv)
 //        hits[0].id = s6.getId();
 //        hits[0].diagonal = 0;
 //        hits[0].count = 0;
-//        matcher.processQuery(&s5, compositionBias, hits, 1, 0);
+//        matcher->processQuery(&s5, compositionBias, hits, 1, 0);
 //        std::cout << hits[0].diagonal << " " <<  (int)hits[0].count << std::endl;
 //    }
 
@@ -125,76 +125,77 @@ int main(int argc, char **argv)
 
     hits[0].id = s1.getId();
     hits[0].diagonal = 0;
-    matcher.processQuery(&s1, compositionBias, hits, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits, 1, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     for(int i = 0; i < 16; i++){
         hits[i].id = s1.getId();
         hits[i].diagonal = 0;
     }
-    matcher.processQuery(&s1, compositionBias, hits, 16, 0);
+    matcher->processQuery(&s1, compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
 
     hits[0].id = s1.getId();
     hits[0].diagonal = 9;
-    matcher.processQuery(&s2, compositionBias, hits, 1, 0);
+    matcher->processQuery(&s2, compositionBias, hits, 1, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     for(int i = 0; i < 16; i++){
         hits[i].id = s1.getId();
         hits[i].diagonal = 9;
     }
-    matcher.processQuery(&s2, compositionBias, hits, 16, 0);
+    matcher->processQuery(&s2, compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     for(int i = 0; i < 16; i++){
         hits[i].id = s2.getId();
         hits[i].diagonal = -9;
     }
-    matcher.processQuery(&s1, compositionBias, hits, 16, 0);
+    matcher->processQuery(&s1, compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
-    matcher.processQuery(&s1, compositionBias, hits, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits, 1, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     for(int i = 0; i < 16; i++){
         hits[i].id = s2.getId();
         hits[i].diagonal = -9;
     }
-    matcher.processQuery(&s3, compositionBias, hits, 16, 0);
+    matcher->processQuery(&s3, compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
-    matcher.processQuery(&s3, compositionBias, hits, 1, 0);
+    matcher->processQuery(&s3, compositionBias, hits, 1, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
 
     hits[0].id = s4.getId();
     hits[0].diagonal = -256;
-    matcher.processQuery(&s1, compositionBias, hits, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits, 1, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
 
     hits[0].id = s1.getId();
     hits[0].diagonal = 256;
-    matcher.processQuery(&s4,compositionBias, hits, 1, 0);
+    matcher->processQuery(&s4,compositionBias, hits, 1, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     hits[0].id = s7.getId();
     hits[0].diagonal = -512;
-    matcher.processQuery(&s1,compositionBias, hits, 16, 0);
+    matcher->processQuery(&s1,compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     hits[0].id = s1.getId();
     hits[0].diagonal = 512;
-    matcher.processQuery(&s7,compositionBias, hits, 16, 0);
+    matcher->processQuery(&s7,compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
 
     hits[0].id = s7.getId();
     hits[0].diagonal = 0;
-    matcher.processQuery(&s7, compositionBias, hits, 16, 0);
+    matcher->processQuery(&s7, compositionBias, hits, 16, 0);
     std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].count <<  std::endl;
 
     delete [] compositionBias;
+    delete matcher;
 }
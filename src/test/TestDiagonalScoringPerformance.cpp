@@ -21,9 +21,64 @@ KSEQ_INIT(int, read)
 #include "DBWriter.h"
 
 #include "Parameters.h"
+#include "Timer.h"
 
 const char* binary_name = "test_diagonalscoringperformance";
 
+// scores the same random hits with the kernel of every instruction set the CPU supports
+void benchmarkKernels(Sequence &query, float *compositionBias, size_t maxLen,
+                      SubstitutionMatrix &subMat, SequenceLookup &lookup, size_t dbCnt) {
+    const size_t hitCount = 16000;
+    const size_t rounds = 1000;
+    CounterResult *input = new CounterResult[rounds * hitCount];
+    for (size_t i = 0; i < rounds * hitCount; i++) {
+        input[i].id = rand() % dbCnt;
+        input[i].diagonal = rand() % query.L;
+        input[i].count = 0;
+    }
+
+    std::vector<std::pair<const char *, UngappedAlignment *> > kernels;
+    kernels.push_back(std::make_pair(SimdDispatch::getLevelName(SimdDispatch::LEVEL_DEFAULT),
+                                     simd_default::createUngappedAlignment(maxLen, &subMat, &lookup)));
+#ifdef SIMD_DISPATCH_AVX2
+    if (SimdDispatch::getLevel() >= SimdDispatch::LEVEL_AVX2) {
+        kernels.push_back(std::make_pair(SimdDispatch::getLevelName(SimdDispatch::LEVEL_AVX2),
+                                         simd_avx2::createUngappedAlignment(maxLen, &subMat, &lookup)));
+    }
+#endif
+#ifdef SIMD_DISPATCH_AVX512BW
+    if (SimdDispatch::getLevel() >= SimdDispatch::LEVEL_AVX512BW) {
+        kernels.push_back(std::make_pair(SimdDispatch::getLevelName(SimdDispatch::LEVEL_AVX512BW),
+                                         simd_avx512bw::createUngappedAlignment(maxLen, &subMat, &lookup)));
+    }
+#endif
+
+    CounterResult *hits = new CounterResult[hitCount];
+    std::vector<unsigned char> reference;
+    for (size_t k = 0; k < kernels.size(); k++) {
+        size_t mismatches = 0;
+        double seconds = 0.0;
+        for (size_t round = 0; round < rounds; round++) {
+            memcpy(hits, input + round * hitCount, sizeof(CounterResult) * hitCount);
+            Timer timer;
+            kernels[k].second->processQuery(&query, compositionBias, hits, hitCount, 0);
+            seconds += timer.elapsedSeconds();
+            for (size_t i = 0; i < hitCount; i++) {
+                if (k == 0) {
+                    reference.push_back(hits[i].count);
+                } else if (reference[round * hitCount + i] != hits[i].count) {
+                    mismatches++;
+                }
+            }
+        }
+        std::cout << kernels[k].first << "\t" << seconds << "s\t"
+                  << (rounds * hitCount) / seconds << " hits/s\t" << mismatches << " mismatches" << std::endl;
+        delete kernels[k].second;
+    }
+    delete [] hits;
+    delete [] input;
+}
+
 int main(int argc, char **argv)
 {
 
@@ -75,7 +130,7 @@ int main(int argc, char **argv)
     }
     kseq_destroy(seq);
     std::cout << maxLen << std::endl;
-    UngappedAlignment matcher(maxLen, &subMat, &lookup);
+    UngappedAlignment *matcher = UngappedAlignment::create(maxLen, &subMat, &lookup);
     CounterResult hits[16000];
     hits[0].id =142424;
     hits[0].diagonal = 50;
@@ -98,16 +153,16 @@ int main(int argc, char **argv)
 
 
 
-    matcher.processQuery(&s1,compositionBias, hits, 16, 0);
+    matcher->processQuery(&s1,compositionBias, hits, 16, 0);
     std::cout << (int)hits[0].count << " ";
     std::cout << (int)hits[1].count << " ";
     std::cout << (int)hits[2].count << " ";
     std::cout << (int)hits[3].count << std::endl;
 
-    matcher.processQuery(&s1, compositionBias, hits, 1, 0);
-    matcher.processQuery(&s1, compositionBias, hits + 1, 1, 0);
-    matcher.processQuery(&s1, compositionBias, hits + 2, 1, 0);
-    matcher.processQuery(&s1, compositionBias, hits + 3, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits + 1, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits + 2, 1, 0);
+    matcher->processQuery(&s1, compositionBias, hits + 3, 1, 0);
 
     std::cout << (int)hits[0].count<< " ";
     std::cout << (int)hits[1].count<< " ";
@@ -119,12 +174,15 @@ int main(int argc, char **argv)
             hits[j].diagonal =  rand()%s1.L;
         }
         //   std::reverse(hits, hits+1000);
-        matcher.processQuery(&s1, compositionBias, hits, 16000, 0);
+        matcher->processQuery(&s1, compositionBias, hits, 16000, 0);
     }
 //    std::cout << ExtendedSubstitutionMatrix::calcScore(s1.int_sequence, s1.int_sequence,s1.L, subMat.subMatrix) << " " << (int)hits[0].diagonalScore <<  std::endl;
 //    std::cout << (int)hits[0].diagonalScore <<  std::endl;
     for(int i = 0; i < 1000; i++){
         std::cout << hits[i].id << "\t" << (int) hits[i].diagonal  << "\t" << (int)hits[i].count <<  std::endl;
     }
+    delete matcher;
+
+    benchmarkKernels(s1, compositionBias, maxLen, subMat, lookup, dbCnt);
     delete [] compositionBias;
 }
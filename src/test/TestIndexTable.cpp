@@ -4,8 +4,11 @@
 // Test class for k-mer generation and index table testing.
 //
 
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <vector>
 #include "SubstitutionMatrix.h"
 #include "IndexTable.h"
 #include "IndexBuilder.h"
@@ -13,7 +16,80 @@
 
 const char* binary_name = "test_indextable";
 
+static IndexEntryLocal entry(unsigned int seqId, unsigned short position) {
+    IndexEntryLocal e;
+    e.seqId = seqId;
+    e.position_j = position;
+    return e;
+}
+
+// packs lists with empty lists, empty and full buckets, the 16th list of a bucket
+// and the widest seqId deltas and positions, then compares the unpacked lists
+static bool checkPackedLists() {
+    IndexTable t(4, 3, false);
+    std::vector<std::vector<IndexEntryLocal> > lists(t.getTableSize());
+    // bucket 0: k-mer 0 is empty
+    lists[1].push_back(entry(UINT_MAX, USHRT_MAX));
+    lists[2].push_back(entry(0, 0));
+    lists[2].push_back(entry(UINT_MAX, USHRT_MAX));
+    // the 16th list, its size needs a two byte varint
+    for (unsigned int i = 0; i < 300; i++) {
+        lists[15].push_back(entry(i * 3, (i == 299) ? USHRT_MAX : i));
+    }
+    // bucket 1 is empty, every list of bucket 2 has entries
+    for (size_t kmer = 32; kmer < 48; kmer++) {
+        for (unsigned int i = 0; i <= kmer - 32; i++) {
+            lists[kmer].push_back(entry(i * 1000 + kmer, i));
+        }
+    }
+    // the last list of the table
+    for (unsigned int i = 0; i < 5; i++) {
+        lists[63].push_back(entry(UINT_MAX - 4 + i, USHRT_MAX - i));
+    }
+
+    size_t *offsets = t.getOffsets();
+    for (size_t kmer = 0; kmer < lists.size(); kmer++) {
+        offsets[kmer] = lists[kmer].size();
+    }
+    t.initMemory(1000);
+    t.init();
+    for (size_t kmer = 0; kmer < lists.size(); kmer++) {
+        std::copy(lists[kmer].begin(), lists[kmer].end(), t.getEntries() + offsets[kmer]);
+    }
+    t.compress();
+
+    bool ok = true;
+    for (size_t kmer = 0; kmer < lists.size(); kmer++) {
+        size_t listSize;
+        const unsigned char *packed = t.getPackedDBSeqList(kmer, &listSize);
+        if (listSize != lists[kmer].size()) {
+            std::cout << "k-mer " << kmer << ": " << listSize << " entries instead of " << lists[kmer].size() << "\n";
+            ok = false;
+            continue;
+        }
+        if (listSize == 0) {
+            continue;
+        }
+        std::vector<IndexEntryLocal> unpacked(listSize);
+        IndexTable::unpackDBSeqList(packed, listSize, &unpacked[0]);
+        for (size_t i = 0; i < listSize; i++) {
+            if (unpacked[i].seqId != lists[kmer][i].seqId || unpacked[i].position_j != lists[kmer][i].position_j) {
+                std::cout << "k-mer " << kmer << " entry " << i << ": " << unpacked[i].seqId << "/" << unpacked[i].position_j
+                          << " instead of " << lists[kmer][i].seqId << "/" << lists[kmer][i].position_j << "\n";
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
 int main(int argc, const char *argv[]) {
+    if (checkPackedLists() == false) {
+        std::cout << "Packed k-mer lists differ\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Packed k-mer lists are restored\n";
+
     Parameters &par = Parameters::getInstance();
     SubstitutionMatrix subMat(par.scoringMatrixFile.c_str(), 8.0, -0.2f);
     DBReader<unsigned int> dbr(
@@ -789,15 +789,15 @@ int main (int argc, const char * argv[])
     const char* sequence2 = "LFILNIISMNKQTKVKGYLLLLLVISSLFISLVGHGYTANKVSAPNPAKEYPQDNLSVIDMKNLPGTQIKSMVKDELQQFLEEQGFRRLKNKSLVDLRRIWLGFMYEDFFYTMHKKTDLPISVIYAFFIIEATNAGIESKLMAKALNPGGIKYRGTGKKMKAMDDCY";
 
     dbSeq->mapSequence(1,1,sequence2);
-    SmithWaterman aligner(15000, subMat.alphabetSize, false);
+    SmithWaterman *aligner = SmithWaterman::create(15000, subMat.alphabetSize, false);
     int8_t * tinySubMat = new int8_t[subMat.alphabetSize*subMat.alphabetSize];
 
-    aligner.ssw_init(s, s->getAlignmentProfile(), &subMat, subMat.alphabetSize, 2);
+    aligner->ssw_init(s, s->getAlignmentProfile(), &subMat, subMat.alphabetSize, 2);
     int32_t maskLen = s->L / 2;
     int gap_open = 10;
     int gap_extend = 1;
     EvalueComputation evalueComputation(100000, &subMat, gap_open, gap_extend, true );
-    s_align alignment = aligner.ssw_align(dbSeq->int_sequence, dbSeq->L, gap_open, gap_extend, 0, 10000, &evalueComputation, 0, 0.0, maskLen);
+    s_align alignment = aligner->ssw_align(dbSeq->int_sequence, dbSeq->L, gap_open, gap_extend, 0, 10000, &evalueComputation, 0, 0.0, maskLen);
     if(alignment.cigar){
         std::cout << "Cigar" << std::endl;
 
@@ -840,6 +840,7 @@ int main (int argc, const char * argv[])
     delete [] alignment.cigar;
     delete s;
     delete dbSeq;
+    delete aligner;
     return 0;
 }
 
@@ -26,6 +26,10 @@ public:
             Debug(Debug::INFO) << "Use index  " << indexDB << "\n";
             int dataMode = DBReader<unsigned int>::USE_INDEX | DBReader<unsigned int>::USE_DATA;
             index = new DBReader<unsigned int>(indexDB.c_str(), (indexDB + ".index").c_str(), dataMode);
+            // index blocks are referenced for the whole run and cannot be read entry by entry
+            if (index->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD) {
+                index->setLoadMode(DBReader<unsigned int>::LOAD_MODE_MMAP);
+            }
             index->open(DBReader<unsigned int>::NOSORT);
             bool templateDBIsIndex = PrefilteringIndexReader::checkIfIndexFile(index);
             if (templateDBIsIndex == true) {
@@ -63,6 +67,14 @@ public:
         return Util::parseFastaHeader(data);
     }
 
+    void prefetch(const std::vector<Matcher::result_t> &results, std::vector<size_t> &ids) {
+        ids.clear();
+        for (size_t i = 0; i < results.size(); i++) {
+            ids.push_back(reader->getId(results[i].dbKey));
+        }
+        reader->prefetch(ids);
+    }
+
     ~HeaderIdReader() {
         reader->close();
         delete reader;
@@ -143,6 +155,7 @@ int convertalignments(int argc, const char **argv, const Command &command) {
     Debug(Debug::INFO) << "Alignment database: " << par.db3 << "\n";
     DBReader<unsigned int> alnDbr(par.db3.c_str(), par.db3Index.c_str());
     alnDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryAlignment = (alnDbr.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 
     DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads);
     resultWriter.open();
@@ -154,6 +167,7 @@ int convertalignments(int argc, const char **argv, const Command &command) {
     {
         Sequence *querySeq;
         Sequence *targetSeq;
+        std::vector<size_t> prefetchIds;
         if (needSequenceDB) {
             querySeq = new Sequence(par.maxSeqLen, queryReader->getDbtype(), &subMat, 0, false, false, false);
             targetSeq = new Sequence(par.maxSeqLen, targetReader->getDbtype(), &subMat, 0, false, false, false);
@@ -176,7 +190,15 @@ int convertalignments(int argc, const char **argv, const Command &command) {
             std::ostringstream ss;
 
             std::string queryId = qHeaderDbr.getId(queryKey);
-            std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, true);
+            std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, alnDbr.getSeqLens(i), binaryAlignment, true);
+            tHeaderDbr->prefetch(results, prefetchIds);
+            if (needSequenceDB) {
+                prefetchIds.clear();
+                for (size_t j = 0; j < results.size(); j++) {
+                    prefetchIds.push_back(targetReader->getId(results[j].dbKey));
+                }
+                targetReader->prefetch(prefetchIds);
+            }
             unsigned int missMatchCount;
             for (size_t j = 0; j < results.size(); j++) {
                 const Matcher::result_t &res = results[j];
@@ -305,7 +327,7 @@ int convertalignments(int argc, const char **argv, const Command &command) {
     // remove NULL byte
     // \n\0 -> ' '\n
     if(isDb==false) {
-        FileUtil::deleteFile(par.db4Index);
+        DBReader<unsigned int>::removeIndex(par.db4Index);
     }
     if (par.earlyExit) {
         Debug(Debug::INFO) << "Done. Exiting early now.\n";
@@ -0,0 +1,22 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "FileUtil.h"
+#include "Debug.h"
+#include "Util.h"
+
+int createbinaryindex(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, 1);
+
+    // always parse the text index, an existing binary index might be outdated
+    DBReader<unsigned int>::removeBinaryIndex(par.db1Index);
+
+    DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str(), DBReader<unsigned int>::USE_INDEX);
+    const bool linesSortedById = reader.open(DBReader<unsigned int>::NOSORT);
+    DBWriter::writeBinaryIndex(par.db1Index.c_str(), reader.getSize(), reader.getIndex(), reader.getSeqLens(), reader.getLastKey(), linesSortedById);
+    Debug(Debug::INFO) << "Wrote binary index " << DBReader<unsigned int>::getBinaryIndexFileName(par.db1Index) << " with " << reader.getSize() << " entries\n";
+    reader.close();
+
+    return EXIT_SUCCESS;
+}
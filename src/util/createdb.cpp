@@ -217,7 +217,8 @@ int createdb(int argn, const char **argv, const Command& command) {
         std::swap(lengthHeader[n_new], lengthHeader[n]);
     }
     delete [] perm;
-    DBWriter out_writer_shuffeled(data_filename.c_str(), index_filename.c_str());
+    const size_t writerMode = par.compressed ? DBWriter::COMPRESSED_MODE : DBWriter::ASCII_MODE;
+    DBWriter out_writer_shuffeled(data_filename.c_str(), index_filename.c_str(), 1, writerMode);
     out_writer_shuffeled.open();
     for (unsigned int n = 0; n < readerSequence.getSize(); n++) {
         unsigned int id = par.identifierOffset + n;
@@ -227,7 +228,7 @@ int createdb(int argn, const char **argv, const Command& command) {
     readerSequence.close();
     out_writer_shuffeled.close(dbType);
 
-    DBWriter out_hdr_writer_shuffeled(data_filename_hdr.c_str(), index_filename_hdr.c_str());
+    DBWriter out_hdr_writer_shuffeled(data_filename_hdr.c_str(), index_filename_hdr.c_str(), 1, writerMode);
     out_hdr_writer_shuffeled.open();
     readerHeader.readMmapedDataInMemory();
     char lookupBuffer[32768];
@@ -3,6 +3,8 @@
 #include "DBWriter.h"
 #include "Debug.h"
 #include "Util.h"
+#include "QueryMatcher.h"
+#include "Matcher.h"
 
 #ifdef OPENMP
 #include <omp.h>
@@ -44,6 +46,8 @@ int createtsv(int argc, const char **argv, const Command &command) {
         reader = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str());
     }
     reader->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryPrefilter = (reader->getDbtype() == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY);
+    const bool binaryAlignment = (reader->getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 
     DBWriter *writer;
     if (hasTargetDB) {
@@ -68,6 +72,7 @@ int createtsv(int argc, const char **argv, const Command &command) {
 
         std::string outputBuffer;
         outputBuffer.reserve(10 * 1024);
+        std::string textEntry;
 
 #pragma omp for schedule(dynamic, 1000)
         for (size_t i = 0; i < reader->getSize(); ++i) {
@@ -90,6 +95,15 @@ int createtsv(int argc, const char **argv, const Command &command) {
             size_t entryIndex = 0;
 
             char *data = reader->getData(i);
+            if (binaryPrefilter) {
+                textEntry.clear();
+                QueryMatcher::binaryPrefilterHitsToText(data, reader->getSeqLens(i), textEntry);
+                data = (char *) textEntry.c_str();
+            } else if (binaryAlignment) {
+                textEntry.clear();
+                Matcher::binaryAlignmentResultsToText(data, reader->getSeqLens(i), textEntry);
+                data = (char *) textEntry.c_str();
+            }
             while (*data != '\0') {
                 size_t foundElements = Util::getWordsOfLine(data, columnPointer, 255);
                 if (foundElements < targetColumn) {
@@ -151,9 +165,9 @@ int createtsv(int argc, const char **argv, const Command &command) {
 
     if (par.dbOut == false) {
         if (hasTargetDB) {
-            std::remove(par.db4Index.c_str());
+            DBReader<unsigned int>::removeIndex(par.db4Index);
         } else {
-            std::remove(par.db3Index.c_str());
+            DBReader<unsigned int>::removeIndex(par.db3Index);
         }
     }
 
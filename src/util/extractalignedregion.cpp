@@ -33,6 +33,7 @@ int doExtractAlignedRegion(Parameters &par) {
     Debug(Debug::INFO) << "Alignment database: " << par.db3 << "\n";
     DBReader<unsigned int> alndbr(par.db3.c_str(), par.db3Index.c_str());
     alndbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryAlignment = (alndbr.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 
     DBWriter dbw(par.db4.c_str(), par.db4Index.c_str(), static_cast<unsigned int>(par.threads));
     dbw.open();
@@ -51,7 +52,7 @@ int doExtractAlignedRegion(Parameters &par) {
         }
 
         char *data = alndbr.getData(i);
-        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data);
+        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, alndbr.getSeqLens(i), binaryAlignment);
         for (size_t j = 0; j < results.size(); j++) {
             Matcher::result_t res = results[j];
             size_t length = 0;
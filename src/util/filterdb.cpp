@@ -4,6 +4,8 @@
 #include "Util.h"
 #include "Debug.h"
 #include "filterdb.h"
+#include "Matcher.h"
+#include "QueryMatcher.h"
 
 #include <fstream>
 #include <iostream>
@@ -166,6 +168,10 @@ int ffindexFilter::runFilter(){
 		char **columnPointer = new char*[column + 1];
 		std::string buffer = "";
 		buffer.reserve(LINE_BUFFER_SIZE);
+		// binary results are filtered through their text representation
+		const bool binaryPrefilter = (dataDb->getDbtype() == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY);
+		const bool binaryAlignment = (dataDb->getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
+		std::string textEntry;
 #pragma omp for schedule(static)
 		for (size_t id = 0; id < dataDb->getSize(); id++) {
 
@@ -177,6 +183,17 @@ int ffindexFilter::runFilter(){
 			char *data = dataDb->getData(id);
             unsigned int queryKey = dataDb->getDbKey(id);
 			size_t dataLength = dataDb->getSeqLens(id);
+			if (binaryPrefilter) {
+				textEntry.clear();
+				QueryMatcher::binaryPrefilterHitsToText(data, dataLength, textEntry);
+				data = (char *) textEntry.c_str();
+				dataLength = textEntry.size() + 1;
+			} else if (binaryAlignment) {
+				textEntry.clear();
+				Matcher::binaryAlignmentResultsToText(data, dataLength, textEntry);
+				data = (char *) textEntry.c_str();
+				dataLength = textEntry.size() + 1;
+			}
 			int counter = 0;
             
             std::vector<std::pair<double, std::string>> toSort;
@@ -42,8 +42,8 @@ int indexdb(int argc, const char **argv, const Command &command) {
     } else {
         memoryLimit = static_cast<size_t>(Util::getTotalSystemMemory() * 0.9);
     }
-    Prefiltering::setupSplit(dbr, subMat->alphabetSize, dbr.getDbtype(), par.threads, false, par.maxResListLen, memoryLimit,
-                             &kmerSize, &split, &splitMode);
+    Prefiltering::setupSplit(dbr, subMat->alphabetSize, dbr.getDbtype(), par.threads, false, par.compressIndex, false,
+                             par.maxResListLen, memoryLimit, &kmerSize, &split, &splitMode);
 
     bool kScoreSet = false;
     for (size_t i = 0; i < par.indexdb.size(); i++) {
@@ -72,7 +72,7 @@ int indexdb(int argc, const char **argv, const Command &command) {
 
     PrefilteringIndexReader::createIndexFile(par.db2, &dbr, hdbr, subMat, par.maxSeqLen,
                                              par.spacedKmer, par.compBiasCorrection, subMat->alphabetSize,
-                                             kmerSize, par.maskMode, kmerThr);
+                                             kmerSize, par.maskMode, kmerThr, par.compressIndex);
 
     if (hdbr != NULL) {
         hdbr->close();
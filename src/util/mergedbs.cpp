@@ -20,13 +20,33 @@ int mergedbs(int argc, const char **argv, const Command& command) {
 
     std::vector<std::string> prefixes = Util::split(par.mergePrefixes, ",");
 
+    // binary results are concatenated record by record, the result keeps their dbtype
+    int dbtype = -1;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        int currentDbtype = DBReader<unsigned int>::parseDbType(filenames[i].first.c_str());
+        const bool binary = (currentDbtype == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY
+                             || currentDbtype == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
+        if (binary == false) {
+            currentDbtype = -1;
+        } else if (prefixes.empty() == false) {
+            Debug(Debug::ERROR) << "--prefixes cannot be used with binary results in " << filenames[i].first << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+        if (i == 0) {
+            dbtype = currentDbtype;
+        } else if (currentDbtype != dbtype) {
+            Debug(Debug::ERROR) << "Cannot merge binary results with results of another type: " << filenames[i].first << "\n";
+            EXIT(EXIT_FAILURE);
+        }
+    }
+
     DBReader<unsigned int> qdbr(par.db1.c_str(), par.db1Index.c_str(), DBReader<unsigned int>::USE_INDEX);
     qdbr.open(DBReader<unsigned int>::NOSORT);
 
     DBWriter writer(par.db2.c_str(), par.db2Index.c_str());
     writer.open();
     writer.mergeFiles(qdbr, filenames, prefixes);
-    writer.close();
+    writer.close(dbtype);
 
     qdbr.close();
 
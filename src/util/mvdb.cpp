@@ -0,0 +1,28 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Util.h"
+
+int mvdb(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, 2);
+
+    if (par.db2 == DBWriter::STREAM_STDOUT) {
+        // workflows end by moving their result to the output name, a stream has to be written instead
+        DBReader<unsigned int> reader(par.db1.c_str(), par.db1Index.c_str());
+        reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+        DBWriter writer(par.db2.c_str(), par.db2Index.c_str());
+        writer.open();
+        for (size_t i = 0; i < reader.getSize(); i++) {
+            writer.writeData(reader.getData(i), reader.getSeqLens(i) - 1, reader.getDbKey(i));
+        }
+        writer.close(reader.getDbtype());
+        reader.close();
+        DBReader<unsigned int>::removeDb(par.db1, par.db1Index);
+        return EXIT_SUCCESS;
+    }
+
+    DBReader<unsigned int>::moveDb(par.db1, par.db1Index, par.db2, par.db2Index);
+
+    return EXIT_SUCCESS;
+}
@@ -44,6 +44,7 @@ int offsetalignment(int argc, const char **argv, const Command &command) {
     Debug(Debug::INFO) << "Alignment database: " << par.db3 << "\n";
     DBReader<unsigned int> alnDbr(par.db3.c_str(), par.db3Index.c_str());
     alnDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryAlignment = (alnDbr.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 
     DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads);
     resultWriter.open();
@@ -76,7 +77,7 @@ int offsetalignment(int argc, const char **argv, const Command &command) {
         std::string ss;
         ss.reserve(1024);
 
-        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, true);
+        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, alnDbr.getSeqLens(i), binaryAlignment, true);
         for (size_t j = 0; j < results.size(); j++) {
             Matcher::result_t &res = results[j];
             size_t targetId = tHeaderDbr.getId(res.dbKey);
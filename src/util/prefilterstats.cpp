@@ -0,0 +1,129 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "Debug.h"
+#include "FileUtil.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// sums of the --query-stats records of a query over all splits
+struct QueryStats {
+    unsigned int key;
+    unsigned int length;
+    size_t splits;
+    size_t kmerListLen;
+    size_t matches;
+    size_t diagonalBins;
+    size_t ungapped;
+    size_t hits;
+    size_t overflows;
+    double kmerMs;
+    double countMs;
+    double ungappedMs;
+    double resultMs;
+    double totalMs;
+
+    static bool compareByTotalTime(const QueryStats &first, const QueryStats &second) {
+        if (first.totalMs > second.totalMs)
+            return true;
+        if (second.totalMs > first.totalMs)
+            return false;
+        return first.key < second.key;
+    }
+};
+
+static const size_t STATS_COLUMNS = 13;
+
+int prefilterstats(int argc, const char **argv, const Command &command) {
+    Parameters &par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, 3);
+
+    DBReader<unsigned int> headers(par.hdr1.c_str(), par.hdr1Index.c_str());
+    headers.open(DBReader<unsigned int>::NOSORT);
+
+    DBReader<unsigned int> reader(par.db2.c_str(), par.db2Index.c_str());
+    reader.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+
+    std::vector<QueryStats> queries;
+    queries.reserve(reader.getSize());
+    char *words[STATS_COLUMNS];
+    for (size_t id = 0; id < reader.getSize(); id++) {
+        QueryStats query = {};
+        query.key = reader.getDbKey(id);
+        char *data = reader.getData(id);
+        while (*data != '\0') {
+            if (Util::getWordsOfLine(data, words, STATS_COLUMNS) < STATS_COLUMNS) {
+                Debug(Debug::ERROR) << "Invalid record of query " << query.key << " in " << par.db2 << "\n";
+                EXIT(EXIT_FAILURE);
+            }
+            query.splits++;
+            query.length = Util::fast_atoi<unsigned int>(words[1]);
+            query.kmerListLen += Util::fast_atoi<size_t>(words[2]);
+            query.matches += Util::fast_atoi<size_t>(words[3]);
+            query.diagonalBins += Util::fast_atoi<size_t>(words[4]);
+            query.ungapped += Util::fast_atoi<size_t>(words[5]);
+            query.hits += Util::fast_atoi<size_t>(words[6]);
+            query.overflows += Util::fast_atoi<size_t>(words[7]);
+            query.kmerMs += strtod(words[8], NULL);
+            query.countMs += strtod(words[9], NULL);
+            query.ungappedMs += strtod(words[10], NULL);
+            query.resultMs += strtod(words[11], NULL);
+            query.totalMs += strtod(words[12], NULL);
+            data = Util::skipLine(data);
+        }
+        if (query.splits > 0) {
+            queries.push_back(query);
+        }
+    }
+    reader.close();
+    std::sort(queries.begin(), queries.end(), QueryStats::compareByTotalTime);
+
+    QueryStats sum = {};
+    for (size_t i = 0; i < queries.size(); i++) {
+        sum.kmerMs += queries[i].kmerMs;
+        sum.countMs += queries[i].countMs;
+        sum.ungappedMs += queries[i].ungappedMs;
+        sum.resultMs += queries[i].resultMs;
+        sum.totalMs += queries[i].totalMs;
+    }
+
+    // slowest query first, the last column is its share of the total time
+    FILE *out = FileUtil::openFileOrDie(par.db3.c_str(), "w", false);
+    for (size_t i = 0; i < queries.size(); i++) {
+        const QueryStats &q = queries[i];
+        const size_t headerId = headers.getId(q.key);
+        const std::string name = (headerId != UINT_MAX) ? Util::parseFastaHeader(headers.getData(headerId)) : SSTR(q.key);
+        fprintf(out, "%s\t%u\t%zu\t%zu\t%zu\t%zu\t%zu\t%zu\t%zu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.4f\n",
+                name.c_str(), q.length, q.splits, q.kmerListLen, q.matches, q.diagonalBins, q.ungapped, q.hits,
+                q.overflows, q.kmerMs, q.countMs, q.ungappedMs, q.resultMs, q.totalMs,
+                (sum.totalMs > 0.0) ? q.totalMs / sum.totalMs : 0.0);
+    }
+    fclose(out);
+    headers.close();
+
+    if (queries.empty()) {
+        Debug(Debug::WARNING) << "No query records in " << par.db2 << "\n";
+        return EXIT_SUCCESS;
+    }
+    const double totalMs = std::max(sum.totalMs, 0.001);
+    Debug(Debug::INFO) << "Queries:                 " << queries.size() << "\n";
+    Debug(Debug::INFO) << "Total time:              " << sum.totalMs / 1000.0 << "s\n";
+    Debug(Debug::INFO) << "k-mer generation:        " << 100.0 * sum.kmerMs / totalMs << "%\n";
+    Debug(Debug::INFO) << "Counting:                " << 100.0 * sum.countMs / totalMs << "%\n";
+    Debug(Debug::INFO) << "Ungapped alignment:      " << 100.0 * sum.ungappedMs / totalMs << "%\n";
+    Debug(Debug::INFO) << "Result extraction:       " << 100.0 * sum.resultMs / totalMs << "%\n";
+    // how much of the runtime the slowest queries account for
+    const size_t tops[] = {1, 10, std::max((size_t) 1, queries.size() / 100)};
+    const char *topNames[] = {"Slowest query:           ", "Slowest 10 queries:      ", "Slowest 1% of queries:   "};
+    for (size_t t = 0; t < sizeof(tops) / sizeof(tops[0]); t++) {
+        double topMs = 0.0;
+        for (size_t i = 0; i < std::min(tops[t], queries.size()); i++) {
+            topMs += queries[i].totalMs;
+        }
+        Debug(Debug::INFO) << topNames[t] << 100.0 * topMs / totalMs << "% of the time\n";
+    }
+    return EXIT_SUCCESS;
+}
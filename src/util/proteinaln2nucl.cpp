@@ -40,6 +40,9 @@ int proteinaln2nucl(int argc, const char **argv, const Command &command) {
     bool sameDB = false;
     if (par.db1.compare(par.db2) == 0) {
         sameDB = true;
+    }
+    // query and target entries are used at the same time, buffered entries need two readers
+    if (sameDB == true && qdbr->hasTransientEntries() == false) {
         tdbr = qdbr;
     } else {
         tdbr = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str());
@@ -51,6 +54,7 @@ int proteinaln2nucl(int argc, const char **argv, const Command &command) {
     Debug(Debug::INFO) << "Alignment database: " << par.db3 << "\n";
     DBReader<unsigned int> alnDbr(par.db3.c_str(), par.db3Index.c_str());
     alnDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryAlignment = (alnDbr.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 
     DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads);
     resultWriter.open();
@@ -73,7 +77,7 @@ int proteinaln2nucl(int argc, const char **argv, const Command &command) {
         unsigned int queryId = qdbr->getId(alnKey);
         char *querySeq = qdbr->getData(queryId);
 
-        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, true);
+        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(data, alnDbr.getSeqLens(i), binaryAlignment, true);
         for (size_t j = 0; j < results.size(); j++) {
             Matcher::result_t &res = results[j];
             bool hasBacktrace = (res.backtrace.size() > 0);
@@ -147,7 +151,7 @@ int proteinaln2nucl(int argc, const char **argv, const Command &command) {
     }
     alnDbr.close();
     resultWriter.close();
-    if (sameDB == false) {
+    if (tdbr != qdbr) {
         tdbr->close();
         delete tdbr;
     }
@@ -84,6 +84,9 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
     bool sameDB = false;
     if (par.db1.compare(par.db2) == 0) {
         sameDB = true;
+    }
+    // query and target entries are used at the same time, buffered entries need two readers
+    if (sameDB == true && qdbr->hasTransientEntries() == false) {
         tdbr = qdbr;
     } else {
         tdbr = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str());
@@ -111,6 +114,7 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
     Debug(Debug::INFO) << "Prefilter database: " << par.db3 << "\n";
     DBReader<unsigned int> dbr_res(par.db3.c_str(), par.db3Index.c_str());
     dbr_res.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryPrefilter = (dbr_res.getDbtype() == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY);
     Debug(Debug::INFO) << "Result database: " << par.db4 << "\n";
     DBWriter resultWriter(par.db4.c_str(), par.db4Index.c_str(), par.threads);
     resultWriter.open();
@@ -147,7 +151,12 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
 //                }else{
                 // -2 because of \n\0 in sequenceDB
 //                }
-                std::vector<hit_t> results = QueryMatcher::parsePrefilterHits(data);
+                std::vector<hit_t> results;
+                if (binaryPrefilter) {
+                    results = QueryMatcher::parseBinaryPrefilterHits(data, dbr_res.getSeqLens(id));
+                } else {
+                    results = QueryMatcher::parsePrefilterHits(data);
+                }
                 for (size_t entryIdx = 0; entryIdx < results.size(); entryIdx++) {
                     unsigned int targetId = tdbr->getId(results[entryIdx].seqId);
                     const bool isIdentity = (queryId == targetId && (par.includeIdentity || sameDB))? true : false;
@@ -289,15 +298,15 @@ int rescorediagonal(int argc, const char **argv, const Command &command) {
     Debug(Debug::INFO) << "Done." << "\n";
     dbr_res.close();
     resultWriter.close();
+    if (tdbr != qdbr) {
+        tdbr->close();
+        delete tdbr;
+    }
     qdbr->close();
     delete qdbr;
     delete subMat;
     delete [] fastMatrix.matrix;
     delete [] fastMatrix.matrixData;
-    if (sameDB == false) {
-        tdbr->close();
-        delete tdbr;
-    }
     return EXIT_SUCCESS;
 }
 
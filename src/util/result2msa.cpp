@@ -43,7 +43,8 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
     unsigned int maxSequenceLength = 0;
     const bool sameDatabase = (par.db1.compare(par.db2) == 0) ? true : false;
     if (!sameDatabase) {
-        tDbr = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str());
+        tDbr = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str(),
+                                          DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_KEY_LOOKUP);
         tDbr->open(DBReader<unsigned int>::NOSORT);
 
         unsigned int *lengths = qDbr.getSeqLens();
@@ -75,8 +76,18 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
     DBWriter resultWriter(resultData.c_str(), resultIndex.c_str(), par.threads, mode);
     resultWriter.open();
 
+    const bool binaryAlignment = (resultReader.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
     // + 1 for query
-    size_t maxSetSize = resultReader.maxCount('\n') + 1;
+    size_t maxSetSize = 0;
+    if (binaryAlignment) {
+        // every binary record takes at least BINARY_RESULT_FIXED_SIZE bytes
+        for (size_t i = 0; i < resultReader.getSize(); i++) {
+            maxSetSize = std::max(maxSetSize, resultReader.getSeqLens(i) / Matcher::BINARY_RESULT_FIXED_SIZE);
+        }
+        maxSetSize += 1;
+    } else {
+        maxSetSize = resultReader.maxCount('\n') + 1;
+    }
 
     // adjust score of each match state by -0.2 to trim alignment
     SubstitutionMatrix subMat(par.scoringMatrixFile.c_str(), 2.0f, -0.2f);
@@ -135,26 +146,22 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
                     centerSequence.L--;
                 }
             }
-            char *centerSequenceHeader = queryHeaderReader.getDataByDBKey(queryKey);
+            // copy, the header reader can be the template header reader and compressed or
+            // fread data lives in a per thread buffer that the next getData call overwrites
+            const std::string centerSequenceHeader = queryHeaderReader.getDataByDBKey(queryKey);
 
             char *results = resultReader.getData(id);
             std::vector<Matcher::result_t> alnResults;
             std::vector<Sequence *> seqSet;
-            while (*results != '\0') {
-                char dbKey[255 + 1];
-                Util::parseKey(results, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+            for (Matcher::ResultIterator it(results, resultReader.getSeqLens(id), binaryAlignment); it.hasNext(); it.next()) {
+                const unsigned int key = it.getDbKey();
                 // in the same database case, we have the query repeated
                 if ((key == queryKey && sameDatabase == true)) {
-                    results = Util::skipLine(results);
                     continue;
                 }
 
-                char *entry[255];
-                const size_t columns = Util::getWordsOfLine(results, entry, 255);
-                if (columns > Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
-                    Matcher::result_t res = Matcher::parseAlignmentRecord(results);
-                    alnResults.push_back(res);
+                if (it.hasBacktrace()) {
+                    alnResults.push_back(it.getResult());
                 }
 
                 const size_t edgeId = tDbr->getId(key);
@@ -174,7 +181,6 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
                 edgeSequence->mapSequence(0, key, dbSeqData);
                 seqSet.push_back(edgeSequence);
 
-                results = Util::skipLine(results);
             }
 
             // Recompute if not all the backtraces are present
@@ -200,7 +206,7 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
                     std::vector<std::string> headers;
                     for (size_t i = 0; i < res.setSize; i++) {
                         if (i == 0) {
-                            headers.push_back(std::string(centerSequenceHeader));
+                            headers.push_back(centerSequenceHeader);
                         } else if (kept[i] == true) {
                             headers.push_back(tempateHeaderReader->getData(seqSet[i - 1]->getId()));
                         }
@@ -221,10 +227,10 @@ int result2msa(Parameters &par, const std::string &resultData, const std::string
                     }
 
                     unsigned int key;
-                    char *header;
+                    const char *header;
                     if (i == 0) {
                         key = queryKey;
-                        header = centerSequenceHeader;
+                        header = centerSequenceHeader.c_str();
                     } else {
                         key = seqSet[i - 1]->getDbKey();
                         header = tempateHeaderReader->getDataByDBKey(key);
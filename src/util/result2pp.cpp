@@ -50,6 +50,7 @@ int computeProfileProfile(Parameters &par,const std::string &outpath,
 
     DBReader<unsigned int> *resultReader = new DBReader<unsigned int>(par.db3.c_str(), par.db3Index.c_str());
     resultReader->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const bool binaryAlignment = (resultReader->getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
     DBWriter resultWriter(outpath.c_str(), (outpath + ".index").c_str(), par.threads, DBWriter::BINARY_MODE);
     resultWriter.open();
     SubstitutionMatrix subMat(par.scoringMatrixFile.c_str(), 2.0f, 0.0f);
@@ -73,7 +74,6 @@ int computeProfileProfile(Parameters &par,const std::string &outpath,
             thread_idx = (unsigned int) omp_get_thread_num();
 #endif
             char *results = resultReader->getData(id);
-            char dbKey[255 + 1];
             // Get the sequence from the queryDB
             unsigned int queryKey = resultReader->getDbKey(id);
             char *queryData = qDbr->getDataByDBKey(queryKey);
@@ -102,23 +102,16 @@ int computeProfileProfile(Parameters &par,const std::string &outpath,
             
             
             memset(outProfile, 0, queryProfile.L * Sequence::PROFILE_AA_SIZE * sizeof(float));
-            while (*results != '\0') {
-                Util::parseKey(results, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
-                double evalue = 0.0;
-                char *entry[255];
-                const size_t columns = Util::getWordsOfLine(results, entry, 255);
-                // its an aln result
-                if (columns > Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
-                    evalue = strtod(entry[3], NULL);
-                }else{
+            for (Matcher::ResultIterator it(results, resultReader->getSeqLens(id), binaryAlignment); it.hasNext(); it.next()) {
+                if (it.hasBacktrace() == false) {
                     Debug(Debug::ERROR) << "Alignment must contain the alignment information. Compute the alignment with option -a.\n";
                     EXIT(EXIT_FAILURE);
                 }
-                
+                const unsigned int key = it.getDbKey();
+
                 // just add sequences if eval < thr. and if key is not the same as the query in case of sameDatabase
-                if (evalue <= par.evalProfile && (key != queryKey || sameDatabase == false)) {
-                    Matcher::result_t res = Matcher::parseAlignmentRecord(results);
+                if (it.getEvalue() <= par.evalProfile && (key != queryKey || sameDatabase == false)) {
+                    const Matcher::result_t res = it.getResult();
                     const size_t edgeId = tDbr->getId(key);
                     char *dbSeqData = tDbr->getData(edgeId);
                     targetProfile.mapSequence(0, key, dbSeqData);
@@ -204,7 +197,6 @@ int computeProfileProfile(Parameters &par,const std::string &outpath,
                     }
                    
                 }
-                results = Util::skipLine(results);
             }
             /*
             float maxNewNeff = 0.0;
@@ -44,6 +44,10 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
         Debug(Debug::INFO) << "Use index  " << indexDB << "\n";
 
         tidxdbr = new DBReader<unsigned int>(indexDB.c_str(), (indexDB + ".index").c_str());
+        // index blocks are referenced for the whole run and cannot be read entry by entry
+        if (tidxdbr->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD) {
+            tidxdbr->setLoadMode(DBReader<unsigned int>::LOAD_MODE_MMAP);
+        }
         tidxdbr->open(DBReader<unsigned int>::NOSORT);
 
         templateDBIsIndex = PrefilteringIndexReader::checkIfIndexFile(tidxdbr);
@@ -68,7 +72,8 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
     }
 
     if (templateDBIsIndex == false) {
-        tDbr = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str());
+        tDbr = new DBReader<unsigned int>(par.db2.c_str(), par.db2Index.c_str(),
+                                          DBReader<unsigned int>::USE_DATA|DBReader<unsigned int>::USE_INDEX|DBReader<unsigned int>::USE_KEY_LOOKUP);
         tDbr->open(DBReader<unsigned int>::NOSORT);
         targetSeqType = tDbr->getDbtype();
         if (par.noPreload == false) {
@@ -108,18 +113,29 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
         }
     }
 
-    DBWriter resultWriter(outpath.c_str(), std::string(outpath + ".index").c_str(), localThreads, DBWriter::BINARY_MODE);
+    const size_t asyncMode = par.asyncWrite ? DBWriter::ASYNC_MODE : 0;
+    DBWriter resultWriter(outpath.c_str(), std::string(outpath + ".index").c_str(), localThreads, DBWriter::BINARY_MODE | asyncMode);
     resultWriter.open();
 
     DBWriter *consensusWriter = NULL;
     if (!par.omitConsensus) {
         consensusWriter = new DBWriter(std::string(outpath + "_consensus").c_str(),
-                     std::string(outpath + "_consensus.index").c_str(), localThreads);
+                     std::string(outpath + "_consensus.index").c_str(), localThreads, asyncMode);
         consensusWriter->open();
     }
 
+    const bool binaryAlignment = (resultReader.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
     // + 1 for query
-    size_t maxSetSize = resultReader.maxCount('\n') + 1;
+    size_t maxSetSize = 0;
+    if (binaryAlignment) {
+        // every binary record takes at least BINARY_RESULT_FIXED_SIZE bytes
+        for (size_t i = 0; i < resultReader.getSize(); i++) {
+            maxSetSize = std::max(maxSetSize, resultReader.getSeqLens(i) / Matcher::BINARY_RESULT_FIXED_SIZE);
+        }
+        maxSetSize += 1;
+    } else {
+        maxSetSize = resultReader.maxCount('\n') + 1;
+    }
 
     // adjust score of each match state by -0.2 to trim alignment
     SubstitutionMatrix subMat(scoringMatrixFile.c_str(), 2.0f, -0.2f);
@@ -153,6 +169,7 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
         std::string result;
         result.reserve(par.maxSeqLen * Sequence::PROFILE_READIN_SIZE * sizeof(char));
         char *charSequence = new char[maxSequenceLength];
+        std::vector<size_t> prefetchIds;
 
         unsigned int thread_idx = 0;
 #ifdef OPENMP
@@ -185,23 +202,24 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
             }
 
             char *results = resultReader.getData(id);
+            if (tSeqLookup == NULL) {
+                prefetchIds.clear();
+                for (Matcher::ResultIterator it(results, resultReader.getSeqLens(id), binaryAlignment); it.hasNext(); it.next()) {
+                    prefetchIds.push_back(tDbr->getId(it.getDbKey()));
+                }
+                tDbr->prefetch(prefetchIds);
+            }
             std::vector<Matcher::result_t> alnResults;
             std::vector<Sequence *> seqSet;
-            while (*results != '\0') {
-                char dbKey[255 + 1];
-                Util::parseKey(results, dbKey);
-                const unsigned int key = (unsigned int) strtoul(dbKey, NULL, 10);
+            for (Matcher::ResultIterator it(results, resultReader.getSeqLens(id), binaryAlignment); it.hasNext(); it.next()) {
+                const unsigned int key = it.getDbKey();
                 // in the same database case, we have the query repeated
                 if ((key == queryKey && sameDatabase == true)) {
-                    results = Util::skipLine(results);
                     continue;
                 }
 
-                char *entry[255];
-                const size_t columns = Util::getWordsOfLine(results, entry, 255);
-                if (columns > Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
-                    Matcher::result_t res = Matcher::parseAlignmentRecord(results);
-                    alnResults.push_back(res);
+                if (it.hasBacktrace()) {
+                    alnResults.push_back(it.getResult());
                 }
 
                 const size_t edgeId = tDbr->getId(key);
@@ -226,7 +244,6 @@ int result2profile(DBReader<unsigned int> &resultReader, Parameters &par, const
                 }
 
                 seqSet.push_back(edgeSequence);
-                results = Util::skipLine(results);
             }
 
             // Recompute if not all the backtraces are present
@@ -56,6 +56,12 @@ StatsComputer::StatsComputer(const Parameters &par)
           targetDb(par.db2), targetDbIndex(par.db2Index) {
     resultReader = new DBReader<unsigned int>(par.db3.c_str(), par.db3Index.c_str());
     resultReader->open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    if (resultReader->getDbtype() == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY
+        || resultReader->getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY) {
+        Debug(Debug::ERROR) << "result2stats does not support binary results in " << par.db3 << ". "
+                            << "Write them without --binary-output.\n";
+        EXIT(EXIT_FAILURE);
+    }
 
     statWriter = new DBWriter(par.db4.c_str(), par.db4Index.c_str(), (unsigned int) par.threads, DBWriter::BINARY_MODE);
     statWriter->open();
@@ -0,0 +1,12 @@
+#include "Parameters.h"
+#include "DBReader.h"
+#include "Util.h"
+
+int rmdb(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, 1);
+
+    DBReader<unsigned int>::removeDb(par.db1, par.db1Index);
+
+    return EXIT_SUCCESS;
+}
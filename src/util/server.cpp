@@ -0,0 +1,341 @@
+#include "Prefiltering.h"
+#include "Alignment.h"
+#include "Matcher.h"
+#include "Parameters.h"
+#include "DBReader.h"
+#include "DBWriter.h"
+#include "Debug.h"
+#include "FileUtil.h"
+#include "Util.h"
+#include "Timer.h"
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+// A request is a FASTA formatted query batch, the client closes its write side after sending it.
+// The answer has one line per alignment (query, target, seq. identity, alignment length, query start and end,
+// target start and end, e-value, bit score), the server closes the connection after the last line.
+// A query that cannot be searched is answered with a line "ERROR <tab> query <tab> reason" instead.
+// A client that does not finish sending its request or reading the answer in time is disconnected.
+
+// SIGTERM and SIGINT shut the listening socket down, so that accept returns and the socket file is removed
+static volatile sig_atomic_t stopServer = 0;
+static int serverFd = -1;
+
+static void handleStopSignal(int) {
+    stopServer = 1;
+    if (serverFd >= 0) {
+        shutdown(serverFd, SHUT_RDWR);
+    }
+}
+
+static void setStopHandler(int signal) {
+    struct sigaction handler;
+    handler.sa_handler = handleStopSignal;
+    sigemptyset(&handler.sa_mask);
+    handler.sa_flags = 0;
+    sigaction(signal, &handler, NULL);
+}
+
+// the answer is sent in chunks of this size while the results are read
+static const size_t ANSWER_CHUNK = 64 * 1024;
+
+// requests are answered one by one, a client must not keep the others waiting
+static const int CLIENT_TIMEOUT_SECONDS = 60;
+
+static bool readRequest(int fd, std::string &request) {
+    char buffer[64 * 1024];
+    const time_t deadline = time(NULL) + CLIENT_TIMEOUT_SECONDS;
+    while (true) {
+        const time_t now = time(NULL);
+        struct pollfd input;
+        input.fd = fd;
+        input.events = POLLIN;
+        int ready = (now < deadline) ? poll(&input, 1, (int) (deadline - now) * 1000) : 0;
+        if (ready == 0) {
+            errno = ETIMEDOUT;
+            return false;
+        }
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count == 0) {
+            return true;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        request.append(buffer, count);
+    }
+}
+
+static bool writeAnswer(int fd, const std::string &answer) {
+    size_t written = 0;
+    while (written < answer.size()) {
+        ssize_t count = send(fd, answer.c_str() + written, answer.size() - written, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += count;
+    }
+    return true;
+}
+
+// a socket file is left over if an earlier server was killed, it is removed if no server accepts on it
+// returns false if the path is taken by something else
+static bool removeStaleSocket(const std::string &socketPath, const struct sockaddr_un &address) {
+    struct stat sb;
+    if (lstat(socketPath.c_str(), &sb) != 0) {
+        return errno == ENOENT;
+    }
+    if (S_ISSOCK(sb.st_mode) == false) {
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    bool stale = connect(fd, (const struct sockaddr *) &address, sizeof(address)) != 0 && errno == ECONNREFUSED;
+    close(fd);
+    return stale && unlink(socketPath.c_str()) == 0;
+}
+
+// sequences that would stop the server while they are mapped are not searched
+static bool checkQuery(const std::string &sequence, size_t maxSeqLen, std::string &reason) {
+    if (sequence.size() >= maxSeqLen) {
+        reason = "sequence is longer than --max-seq-len " + SSTR(maxSeqLen - 1);
+        return false;
+    }
+    for (size_t i = 0; i < sequence.size(); i++) {
+        const unsigned char residue = static_cast<unsigned char>(sequence[i]);
+        if ((residue < 'A' || residue > 'Z') && (residue < 'a' || residue > 'z')) {
+            reason = "invalid residue at position " + SSTR(i + 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+// splits the request in the identifiers and the sequences of its entries
+static void parseRequest(const std::string &request, std::vector<std::string> &names, std::vector<std::string> &sequences) {
+    names.clear();
+    sequences.clear();
+    size_t pos = 0;
+    while (pos < request.size()) {
+        size_t end = request.find('\n', pos);
+        if (end == std::string::npos) {
+            end = request.size();
+        }
+        std::string line = request.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.size() > 0 && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if (line.size() > 0 && line[0] == '>') {
+            names.push_back(Util::parseFastaHeader(line.substr(1)));
+            sequences.push_back("");
+        } else if (names.size() > 0) {
+            sequences.back().append(line);
+        }
+    }
+}
+
+// writes the searchable sequences with their index in names as key, the others get an error line in answer
+// returns the count of written sequences
+static size_t writeQueryDb(const std::string &db, int dbtype, size_t maxSeqLen, const std::vector<std::string> &names,
+                           std::vector<std::string> &sequences, std::string &answer) {
+    DBWriter writer(db.c_str(), (db + ".index").c_str(), 1, DBWriter::ASCII_MODE);
+    writer.open();
+    size_t written = 0;
+    std::string reason;
+    for (size_t i = 0; i < names.size(); i++) {
+        if (checkQuery(sequences[i], maxSeqLen, reason) == false) {
+            answer.append("ERROR\t" + names[i] + "\t" + reason + "\n");
+            continue;
+        }
+        sequences[i].push_back('\n');
+        writer.writeData(sequences[i].c_str(), sequences[i].size(), i);
+        written++;
+    }
+    writer.close(dbtype);
+    return written;
+}
+
+// streams the result lines, answer holds the lines that were not sent yet
+static bool sendResults(int fd, DBReader<unsigned int> &resultReader, DBReader<unsigned int> &targetHeaders,
+                        const std::vector<std::string> &names, std::string &answer) {
+    const bool binaryAlignment = (resultReader.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
+    char buffer[1024];
+    for (size_t i = 0; i < resultReader.getSize(); i++) {
+        unsigned int queryKey = resultReader.getDbKey(i);
+        std::vector<Matcher::result_t> results = Matcher::readAlignmentResults(resultReader.getData(i), resultReader.getSeqLens(i),
+                                                                                binaryAlignment, true);
+        for (size_t j = 0; j < results.size(); j++) {
+            const Matcher::result_t &res = results[j];
+            std::string targetId = Util::parseFastaHeader(targetHeaders.getDataByDBKey(res.dbKey));
+            int count = snprintf(buffer, sizeof(buffer), "%s\t%s\t%1.3f\t%d\t%d\t%d\t%d\t%d\t%.2E\t%d\n",
+                                 names[queryKey].c_str(), targetId.c_str(), res.seqId, res.alnLength,
+                                 res.qStartPos + 1, res.qEndPos + 1, res.dbStartPos + 1, res.dbEndPos + 1,
+                                 res.eval, res.score);
+            if (count < 0 || static_cast<size_t>(count) >= sizeof(buffer)) {
+                Debug(Debug::WARNING) << "Truncated line of query " << names[queryKey] << "!\n";
+                continue;
+            }
+            answer.append(buffer, count);
+        }
+        if (answer.size() >= ANSWER_CHUNK) {
+            if (writeAnswer(fd, answer) == false) {
+                return false;
+            }
+            answer.clear();
+        }
+    }
+    return true;
+}
+
+int server(int argc, const char **argv, const Command& command) {
+    Parameters& par = Parameters::getInstance();
+    par.parseParameters(argc, argv, command, 3, true, 0, MMseqsParameter::COMMAND_PREFILTER|MMseqsParameter::COMMAND_ALIGN);
+    // every request is answered from a single unsplit result database
+    par.checkpointChunks = 0;
+    par.shardedOutput = false;
+    par.earlyExit = false;
+
+#ifdef OPENMP
+    omp_set_num_threads(par.threads);
+#endif
+
+    const std::string targetDb = par.db1;
+    const std::string socketPath = par.db2;
+    const std::string tmpDir = par.db3;
+    if (FileUtil::directoryExists(tmpDir.c_str()) == false && FileUtil::makeDir(tmpDir.c_str()) == false) {
+        Debug(Debug::ERROR) << "Could not create tmp folder " << tmpDir << "\n";
+        return EXIT_FAILURE;
+    }
+
+    int targetDbType = DBReader<unsigned int>::parseDbType(targetDb.c_str());
+    if (targetDbType != Sequence::AMINO_ACIDS && targetDbType != Sequence::NUCLEOTIDES) {
+        Debug(Debug::ERROR) << "The server only searches sequence databases.\n";
+        return EXIT_FAILURE;
+    }
+
+    Timer timer;
+    Debug(Debug::INFO) << "Initialising data structures...\n";
+    Prefiltering pref(targetDb, par.db1Index, targetDbType, targetDbType, par);
+    // the target database is passed as query until the first request
+    Alignment aln(targetDb, par.db1Index, targetDb, par.db1Index, "", "", "", "", par);
+    if (pref.setAligner(&aln, par.maxAccept, par.maxRejected) == false) {
+        Debug(Debug::ERROR) << "The index table of " << targetDb << " does not fit into memory as a whole. "
+                            << "The server cannot search a split target database.\n";
+        return EXIT_FAILURE;
+    }
+    DBReader<unsigned int> targetHeaders(par.hdr1.c_str(), par.hdr1Index.c_str());
+    targetHeaders.open(DBReader<unsigned int>::NOSORT);
+    Debug(Debug::INFO) << "Time for init: " << timer.lap() << "\n";
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        Debug(Debug::ERROR) << "Socket path " << socketPath << " is too long\n";
+        return EXIT_FAILURE;
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (removeStaleSocket(socketPath, address) == false) {
+        Debug(Debug::ERROR) << socketPath << " is not a socket or another server is listening on it\n";
+        return EXIT_FAILURE;
+    }
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(listenFd, 16) != 0) {
+        Debug(Debug::ERROR) << "Could not listen on " << socketPath << ". Error " << errno << "\n";
+        return EXIT_FAILURE;
+    }
+    serverFd = listenFd;
+    setStopHandler(SIGTERM);
+    setStopHandler(SIGINT);
+    Debug(Debug::INFO) << "Listening on " << socketPath << "\n";
+
+    const std::string queryDb = tmpDir + "/query";
+    const std::string resultDb = tmpDir + "/result";
+    std::vector<std::string> names;
+    std::vector<std::string> sequences;
+    int status = EXIT_SUCCESS;
+    while (stopServer == 0) {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (stopServer != 0) {
+                break;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            Debug(Debug::ERROR) << "Could not accept connection. Error " << errno << "\n";
+            status = EXIT_FAILURE;
+            break;
+        }
+        timer.reset();
+        struct timeval timeout;
+        timeout.tv_sec = CLIENT_TIMEOUT_SECONDS;
+        timeout.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        if (readRequest(fd, request) == false) {
+            Debug(Debug::WARNING) << "Could not read request. Error " << errno << "\n";
+            close(fd);
+            continue;
+        }
+
+        parseRequest(request, names, sequences);
+        std::string answer;
+        bool sent = true;
+        if (writeQueryDb(queryDb, targetDbType, par.maxSeqLen, names, sequences, answer) > 0) {
+            aln.setQueryDatabase(queryDb, queryDb + ".index");
+            pref.runAllSplits(queryDb, queryDb + ".index", resultDb, resultDb + ".index");
+
+            DBReader<unsigned int> resultReader(resultDb.c_str(), (resultDb + ".index").c_str());
+            resultReader.open(DBReader<unsigned int>::NOSORT);
+            sent = sendResults(fd, resultReader, targetHeaders, names, answer);
+            resultReader.close();
+            DBReader<unsigned int>::removeDb(resultDb, resultDb + ".index");
+        }
+        if (sent == false || writeAnswer(fd, answer) == false) {
+            Debug(Debug::WARNING) << "Could not send answer. Error " << errno << "\n";
+        }
+        close(fd);
+        Debug(Debug::INFO) << "Answered " << names.size() << " queries in " << timer.lap() << "\n";
+    }
+
+    serverFd = -1;
+    close(listenFd);
+    unlink(socketPath.c_str());
+    targetHeaders.close();
+    if (stopServer != 0) {
+        Debug(Debug::INFO) << "Stopped on signal\n";
+    }
+    return status;
+}
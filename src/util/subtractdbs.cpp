@@ -6,6 +6,7 @@
 #include <list>
 #include <vector>
 #include <Matcher.h>
+#include "QueryMatcher.h"
 #include "DBReader.h"
 #include "Debug.h"
 #include "DBWriter.h"
@@ -24,11 +25,17 @@ void dosubstractresult(std::string leftDb, std::string rightDb, std::string outD
     leftDbr.open(DBReader<unsigned int>::NOSORT);
     DBReader<unsigned int> rightDbr(rightDb.c_str(), (rightDb + std::string(".index")).c_str());
     rightDbr.open(DBReader<unsigned int>::NOSORT);
+    // the output keeps the format of the left side, binary prefilter entries are packed hit_t records
+    const int leftDbtype = leftDbr.getDbtype();
+    const bool leftBinaryPrefilter = (leftDbtype == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY);
+    const bool leftBinaryAlignment = (leftDbtype == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
+    const bool rightBinaryPrefilter = (rightDbr.getDbtype() == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY);
+    const bool rightBinaryAlignment = (rightDbr.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 
     Debug(Debug::INFO) << "Output databse: " << outDb << "\n";
-    DBWriter writer(outDb.c_str(), (outDb + std::string(".index")).c_str(), threads);
+    DBWriter writer(outDb.c_str(), (outDb + std::string(".index")).c_str(), threads,
+                    (leftBinaryPrefilter || leftBinaryAlignment) ? DBWriter::BINARY_MODE : DBWriter::ASCII_MODE);
     writer.open();
-    const size_t LINE_BUFFER_SIZE = 1000000;
 #pragma omp parallel
     {
         int thread_idx = 0;
@@ -36,85 +43,75 @@ void dosubstractresult(std::string leftDb, std::string rightDb, std::string outD
         thread_idx = omp_get_thread_num();
 #endif
 
-        char * lineBuffer = new char[LINE_BUFFER_SIZE];
-        char * key = new char[255];
         std::string minusResultsOutString;
         minusResultsOutString.reserve(maxLineLength);
 #pragma omp for schedule(static)
         for (size_t id = 0; id < leftDbr.getSize(); id++) {
             std::map<unsigned int, bool> elementLookup;
-            const char *leftData = leftDbr.getData(id);
+            char *leftData = leftDbr.getData(id);
+            const size_t leftLength = leftDbr.getSeqLens(id);
             unsigned int leftDbKey = leftDbr.getDbKey(id);
 
             // fill element id look up with left side elementLookup
-            {
-                char *data = (char *) leftData;
-                char *entry[255];
-                while (*data != '\0') {
-                    Util::parseKey(data, key);
-                    unsigned int dbKey = std::strtoul(key, NULL, 10);
-                    double evalue = 0.0;
-                    const size_t columns = Util::getWordsOfLine(data, entry, 255);
-                    // its an aln result (parse e-value)
-                    if (columns >= Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
-                        evalue = strtod(entry[3], NULL);
-                    }
-                    if(evalue <= evalThreshold){
-                        elementLookup[dbKey] = true;
+            // prefilter hits have no e-value and always pass
+            if (leftBinaryPrefilter) {
+                std::vector<hit_t> hits = QueryMatcher::parseBinaryPrefilterHits(leftData, leftLength);
+                for (size_t i = 0; i < hits.size(); i++) {
+                    elementLookup[hits[i].seqId] = true;
+                }
+            } else {
+                Matcher::ResultIterator it(leftData, leftLength, leftBinaryAlignment);
+                for (; it.hasNext(); it.next()) {
+                    if (it.getEvalue() <= evalThreshold) {
+                        elementLookup[it.getDbKey()] = true;
                     }
-                    data = Util::skipLine(data);
                 }
             }
             // get all data for the leftDbkey from rightDbr
             // check if right ids are in elementsId
-            char *data = rightDbr.getDataByDBKey(leftDbKey);
-            char *entry[255];
-
-            if (data != NULL) {
-                while (*data != '\0') {
-                    Util::parseKey(data, key);
-                    unsigned int element = std::strtoul(key, NULL, 10);
-                    double evalue = 0.0;
-                    const size_t columns = Util::getWordsOfLine(data, entry, 255);
-                    if (columns >= Matcher::ALN_RES_WITH_OUT_BT_COL_CNT) {
-                        evalue = strtod(entry[3], NULL);
+            const size_t rightId = rightDbr.getId(leftDbKey);
+            if (rightId != UINT_MAX) {
+                char *data = rightDbr.getData(rightId);
+                const size_t rightLength = rightDbr.getSeqLens(rightId);
+                if (rightBinaryPrefilter) {
+                    std::vector<hit_t> hits = QueryMatcher::parseBinaryPrefilterHits(data, rightLength);
+                    for (size_t i = 0; i < hits.size(); i++) {
+                        elementLookup[hits[i].seqId] = false;
                     }
-                    if(evalue <= evalThreshold) {
-                        elementLookup[element] = false;
+                } else {
+                    Matcher::ResultIterator it(data, rightLength, rightBinaryAlignment);
+                    for (; it.hasNext(); it.next()) {
+                        if (it.getEvalue() <= evalThreshold) {
+                            elementLookup[it.getDbKey()] = false;
+                        }
                     }
-                    data = Util::skipLine(data);
                 }
             }
             // write only elementLookup that are not found in rightDbr (id != UINT_MAX)
-            {
-                char *data = (char *) leftData;
-                size_t dataLength = leftDbr.getSeqLens(id);
-
-                while (*data != '\0') {
-                    Util::parseKey(data, key);
-                    if (!Util::getLine(data, dataLength, lineBuffer, LINE_BUFFER_SIZE)) {
-                        Debug(Debug::WARNING) << "Warning: Identifier was too long and was cut off!\n";
-                        data = Util::skipLine(data);
-                        continue;
+            if (leftBinaryPrefilter) {
+                const size_t hitCount = (leftLength == 0) ? 0 : (leftLength - 1) / sizeof(hit_t);
+                for (size_t i = 0; i < hitCount; i++) {
+                    hit_t hit;
+                    memcpy(&hit, leftData + i * sizeof(hit_t), sizeof(hit_t));
+                    if (elementLookup[hit.seqId]) {
+                        minusResultsOutString.append(leftData + i * sizeof(hit_t), sizeof(hit_t));
                     }
-                    unsigned int elementIdx = std::strtoul(key, NULL, 10);
-                    if (elementLookup[elementIdx]) {
-                        minusResultsOutString.append(lineBuffer);
-                        minusResultsOutString.append("\n");
+                }
+            } else {
+                Matcher::ResultIterator it(leftData, leftLength, leftBinaryAlignment);
+                for (; it.hasNext(); it.next()) {
+                    if (elementLookup[it.getDbKey()]) {
+                        minusResultsOutString.append(it.getRecord(), it.getRecordLength());
                     }
-                    data = Util::skipLine(data);
                 }
             }
-            
+
             // write result
-            char *mergeResultsOutData = (char *) minusResultsOutString.c_str();
-            writer.writeData(mergeResultsOutData, minusResultsOutString.length(), leftDbKey, thread_idx);
+            writer.writeData(minusResultsOutString.c_str(), minusResultsOutString.length(), leftDbKey, thread_idx);
             minusResultsOutString.clear();
         }
-        delete [] lineBuffer;
-        delete [] key;
     }
-    writer.close();
+    writer.close(leftDbtype);
 
     leftDbr.close();
     rightDbr.close();
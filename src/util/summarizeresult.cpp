@@ -66,6 +66,7 @@ int doSummarize(Parameters &par, DBReader<unsigned int> &blastTabReader,
     DBWriter writer(resultdb.first.c_str(), resultdb.second.c_str(), static_cast<unsigned int>(par.threads));
     writer.open();
     Debug(Debug::INFO) << "Start writing to file " << resultdb.first << "\n";
+    const bool binaryAlignment = (blastTabReader.getDbtype() == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY);
 #pragma omp parallel for schedule(dynamic, 100)
     for (size_t i = dbFrom; i < dbFrom + dbSize; ++i) {
         unsigned int thread_idx = 0;
@@ -76,7 +77,7 @@ int doSummarize(Parameters &par, DBReader<unsigned int> &blastTabReader,
 
         unsigned int id = blastTabReader.getDbKey(i);
         char *tabData = blastTabReader.getData(i);
-        const std::vector<Matcher::result_t> entries = Matcher::readAlignmentResults(tabData);
+        const std::vector<Matcher::result_t> entries = Matcher::readAlignmentResults(tabData, blastTabReader.getSeqLens(i), binaryAlignment);
         if (entries.size() == 0) {
             Debug(Debug::WARNING) << "Could not map any entries for entry " << id << "!\n";
             continue;
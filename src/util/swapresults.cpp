@@ -34,6 +34,10 @@ public:
             std::string indexIndex = indexData;
             indexIndex.append(".index");
             indexReader = new DBReader<unsigned int>(indexData.c_str(), indexIndex.c_str());
+            // index blocks are referenced for the whole run and cannot be read entry by entry
+            if (indexReader->getLoadMode() == DBReader<unsigned int>::LOAD_MODE_PREAD) {
+                indexReader->setLoadMode(DBReader<unsigned int>::LOAD_MODE_MMAP);
+            }
             indexReader->open(DBReader<unsigned int>::NOSORT);
             if ((isIndex = PrefilteringIndexReader::checkIfIndexFile(indexReader)) == true) {
                 reader = PrefilteringIndexReader::openNewReader(indexReader, false);
@@ -64,6 +68,21 @@ private:
     DBReader<unsigned int> *indexReader = NULL;
 };
 
+// binary prefilter and alignment entries are swapped through their text representation
+static char *getTextEntry(DBReader<unsigned int> &reader, size_t id, int dbType, std::string &textEntry) {
+    char *data = reader.getData(id);
+    if (dbType == DBReader<unsigned int>::DBTYPE_PREFILTER_BINARY) {
+        textEntry.clear();
+        QueryMatcher::binaryPrefilterHitsToText(data, reader.getSeqLens(id), textEntry);
+        data = (char *) textEntry.c_str();
+    } else if (dbType == DBReader<unsigned int>::DBTYPE_ALIGNMENT_BINARY) {
+        textEntry.clear();
+        Matcher::binaryAlignmentResultsToText(data, reader.getSeqLens(id), textEntry);
+        data = (char *) textEntry.c_str();
+    }
+    return data;
+}
+
 int doswap(Parameters& par, bool isGeneralMode) {
     const char * parResultDb;
     const char * parResultDbIndex;
@@ -135,6 +154,7 @@ int doswap(Parameters& par, bool isGeneralMode) {
     Debug(Debug::INFO) << "Result database: " << parResultDbStr << "\n";
     DBReader<unsigned int> resultDbr(parResultDb, parResultDbIndex);
     resultDbr.open(DBReader<unsigned int>::LINEAR_ACCCESS);
+    const int resultDbType = resultDbr.getDbtype();
 
     const size_t resultSize = resultDbr.getSize();
     Debug(Debug::INFO) << "Computing offsets.\n";
@@ -148,7 +168,8 @@ int doswap(Parameters& par, bool isGeneralMode) {
         char *tmpBuff = Itoa::u32toa_sse2((uint32_t) resultId, queryKeyStr);
         *(tmpBuff) = '\0';
         size_t queryKeyLen = strlen(queryKeyStr);
-        char *data = resultDbr.getData(i);
+        std::string textEntry;
+        char *data = getTextEntry(resultDbr, i, resultDbType, textEntry);
         char dbKeyBuffer[255 + 1];
         while (*data != '\0') {
             Util::parseKey(data, dbKeyBuffer);
@@ -196,7 +217,8 @@ int doswap(Parameters& par, bool isGeneralMode) {
 #pragma omp parallel for schedule(dynamic, 10)
         for (size_t i = 0; i < resultSize; ++i) {
             Debug::printProgress(i);
-            char *data = resultDbr.getData(i);
+            std::string textEntry;
+            char *data = getTextEntry(resultDbr, i, resultDbType, textEntry);
             unsigned int queryKey = resultDbr.getDbKey(i);
             char queryKeyStr[1024];
             char *tmpBuff = Itoa::u32toa_sse2((uint32_t) queryKey, queryKeyStr);
@@ -235,7 +257,8 @@ int doswap(Parameters& par, bool isGeneralMode) {
             if (resultDbr.getSeqLens(i) <= 1){
                 continue;
             }
-            const size_t columns = Util::getWordsOfLine(resultDbr.getData(i), entry, 255);
+            std::string textEntry;
+            const size_t columns = Util::getWordsOfLine(getTextEntry(resultDbr, i, resultDbType, textEntry), entry, 255);
             isAlignmentResult = columns >= Matcher::ALN_RES_WITH_OUT_BT_COL_CNT;
             hasBacktrace = columns >= Matcher::ALN_RES_WITH_BT_COL_CNT;
             break;
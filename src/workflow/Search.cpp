@@ -196,6 +196,15 @@ int search(int argc, const char **argv, const Command& command) {
         }
         cmd.addVariable("PREFILTER_PAR", par.createParameterString(prefilterWithoutS).c_str());
         cmd.addVariable("ALIGNMENT_PAR", par.createParameterString(par.align).c_str());
+        if (par.fusedSearch) {
+            std::vector<MMseqsParameter> prefilterAlignWithoutS;
+            for (size_t i = 0; i < par.prefilteralign.size(); i++){
+                if (par.prefilteralign[i].uniqid != par.PARAM_S.uniqid ){
+                    prefilterAlignWithoutS.push_back(par.prefilteralign[i]);
+                }
+            }
+            cmd.addVariable("FUSED_PAR", par.createParameterString(prefilterAlignWithoutS).c_str());
+        }
         FileUtil::writeFile(tmpDir + "/blastp.sh", blastp_sh, blastp_sh_len);
         program = std::string(tmpDir + "/blastp.sh");
     }